@@ -0,0 +1,110 @@
+/*
+ * Copyright (c) 2024 Johannes Lorenz
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice (including the next
+ * paragraph) shall be included in all copies or substantial portions of the
+ * Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT.  IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+/**
+ * @file arena.h
+ * Bump allocator for memory that is freed all at once
+ *
+ * All allocations are served from a chain of large blocks. Single
+ * allocations can not be freed; instead, the whole arena is reset, e.g.
+ * after each scanned message. A reset arena keeps (and merges) its memory,
+ * so after a few resets, the arena does not call malloc anymore.
+ *
+ * @test pretty-format.cpp
+ */
+
+#ifndef RTOSC_ARENA_H
+#define RTOSC_ARENA_H
+
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+struct rtosc_arena_block;
+
+typedef struct
+{
+    struct rtosc_arena_block* first; //!< first block, or NULL
+    struct rtosc_arena_block* cur; //!< block to allocate from
+    size_t used; //!< bytes used in the current block
+    size_t block_size; //!< minimum size for new blocks
+    void* last_alloc; //!< recent allocation, can be grown in place
+} rtosc_arena_t;
+
+/**
+ * Initialize an arena
+ * @param arena The arena to initialize
+ * @param block_size The minimum size for allocating new blocks from the heap
+ */
+void rtosc_arena_init(rtosc_arena_t* arena, size_t block_size);
+
+/**
+ * Free all memory of an arena
+ *
+ * The arena may be used again after calling rtosc_arena_init() on it.
+ */
+void rtosc_arena_destroy(rtosc_arena_t* arena);
+
+/**
+ * Allocate memory from an arena
+ *
+ * The memory is suitably aligned for any rtosc type, and it stays valid until
+ * the arena is being reset or destroyed.
+ *
+ * @return The allocated memory, or NULL if malloc failed
+ */
+void* rtosc_arena_alloc(rtosc_arena_t* arena, size_t size);
+
+/**
+ * Grow an allocation from an arena
+ *
+ * If @p ptr is the recent allocation, and the current block has enough
+ * space, no copy takes place.
+ *
+ * @param ptr Memory that has been returned by rtosc_arena_alloc() or
+ *   rtosc_arena_grow() (or NULL, if @p old_size is 0)
+ * @param old_size Size that had been requested for @p ptr
+ * @param new_size New size, which must not be less than @p old_size
+ * @return Pointer to memory that holds the old contents, or NULL if malloc
+ *   failed
+ */
+void* rtosc_arena_grow(rtosc_arena_t* arena, void* ptr,
+                       size_t old_size, size_t new_size);
+
+/**
+ * Invalidate all allocations, but keep the memory for future allocations
+ */
+void rtosc_arena_reset(rtosc_arena_t* arena);
+
+/**
+ * Return the number of bytes that the arena has allocated from the heap
+ */
+size_t rtosc_arena_capacity(const rtosc_arena_t* arena);
+
+#ifdef __cplusplus
+}
+#endif
+#endif // RTOSC_ARENA_H
@@ -62,6 +62,34 @@ int rtosc_arg_val_to_int(const rtosc_arg_val_t *av, int* res);
 rtosc_arg_val_t *rtosc_arg_val_range_arg(const rtosc_arg_val_t* range_arg,
                                          int ith, rtosc_arg_val_t *result);
 
+/**
+ * Calculate @p num arguments of a range at once, starting at the @p from'th
+ *
+ * The results are the same as from calling rtosc_arg_val_range_arg() for each
+ * of them, but much faster for long ranges.
+ *
+ * @param range_arg The range arg val ('-'), followed by its delta (if any) and
+ *   its start value
+ * @param out C array of int32_t (for types 'i' and 'c'), int64_t ('h'),
+ *   float ('f') or double ('d'), depending on the range's type
+ * @return @p num, or 0 if the range's type is not supported
+ */
+size_t rtosc_arg_val_range_expand(const rtosc_arg_val_t* range_arg,
+                                  int32_t from, size_t num, void* out);
+
+/**
+ * Count the arg vals at the start of @p av which form a run
+ *
+ * This is the inverse of rtosc_arg_val_range_expand(): In a run, each arg val
+ * is its predecessor plus @p delta, or, if @p delta is NULL, equal to the
+ * first one. Arrays and ranges end a run.
+ *
+ * @param size Number of arg vals in @p av
+ * @return The length of the run (at least 1 if @p size is not zero)
+ */
+size_t rtosc_arg_val_run_length(const rtosc_arg_val_t* av, size_t size,
+                                const rtosc_arg_val_t* delta);
+
 #ifdef __cplusplus
 };
 #endif
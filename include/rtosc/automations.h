@@ -16,6 +16,7 @@ struct AutomationMapping
 
     //0 - simple linear (only first four control points are used)
     //1 - piecewise linear
+    //2 - smoothed curve through all control points
     int   control_type;
 
     float *control_points;
@@ -24,6 +25,12 @@ struct AutomationMapping
 
     float gain;
     float offset;
+
+    //0 - no smoothing
+    //1 - exponential, smooth_time is the time constant
+    //2 - slew limited, smooth_time is the time for the full range
+    int   smooth_type;
+    float smooth_time; //in blocks, see AutomationMgr::processBlock()
 };
 
 struct Automation
@@ -48,6 +55,18 @@ struct Automation
     AutomationMapping map;
 };
 
+/**
+ * Port and runtime object of an automated parameter, which can be called
+ * directly, see AutomationMgr::resolveRoute()
+ */
+struct AutomationRoute
+{
+    const Port *port;      //!< NULL if the port can not be called directly
+    void       *obj;       //!< runtime object of the port
+    uint32_t    leaf;      //!< offset of the port's part of the path
+    char        path[128]; //!< the parameter's path
+};
+
 #define RTOSC_AUTOMATION_SLOT_NAME_LEN
 struct AutomationSlot
 {
@@ -117,6 +136,21 @@ class AutomationMgr
         const char * getName(int slot_id);
 
         bool handleMidi(int channel, int cc, int val);
+
+        /**
+         * Set the slots bound to a controller to a high resolution value [RT]
+         *
+         * Unlike with handleMidi(), no coarse and fine parts are needed.
+         *
+         * @param par CC number, or the 14 bit parameter number of an NRPN
+         *   (which ignores @p channel)
+         * @param val 14 bit value (handleMidi14()) or 32 bit normalized value
+         *   (handleMidi32(), like in MIDI 2.0)
+         * @return if a slot is bound to the controller
+         */
+        bool handleMidi14(int channel, int par, int val, bool nrpn=false);
+        bool handleMidi32(int channel, int par, uint32_t val,
+                          bool nrpn=false);
         
         void setparameternumber(unsigned int type, int value); //used for RPN and NRPN's
         int getnrpn(int *parhi, int *parlo, int *valhi, int *vallo);
@@ -125,8 +159,117 @@ class AutomationMgr
 
         void set_instance(void *v);
 
+        /**
+         * Call the ports of automations directly [RT]
+         *
+         * If set, the values of automations with a route are passed to the
+         * port's callback directly, with @p d, instead of being sent to the
+         * backend. Automations without a route still use the backend.
+         * Routes are found on the non-realtime side, by resolveRoutes() or
+         * resolveRoute().
+         *
+         * @param d RtData for the port callbacks. Its loc must point to a
+         *   buffer. NULL sends all values to the backend.
+         */
+        void set_rtdata(RtData *d);
+
+        /**
+         * Find the port and runtime object of the parameter @p path
+         *
+         * This dispatches a query for the parameter's value to the ports,
+         * so it must not be called from the realtime thread. The result can
+         * be passed to the realtime thread, which hands it to
+         * setSlotSubRoute().
+         *
+         * @return whether the port can be called directly
+         */
+        bool resolveRoute(const char *path, AutomationRoute &route) const;
+
+        /**
+         * Let an automation call its port directly [RT]
+         *
+         * @param route A route from resolveRoute(). It is ignored if the
+         *   automation's path has changed since.
+         */
+        void setSlotSubRoute(int slot_id, int sub,
+                             const AutomationRoute &route);
+
+        /**
+         * Find the routes of all automations which have none
+         *
+         * Call this on the non-realtime side after binding slots, while the
+         * realtime thread does not change automations (or use
+         * resolveRoute() and setSlotSubRoute() instead). set_ports() and
+         * set_instance() do this, too. Automations get no route if their
+         * path changes.
+         */
+        void resolveRoutes(void);
+
+        /**
+         * Forget the routes of all automations
+         *
+         * This must be called if the port tree or the runtime objects change
+         * while set_rtdata() is used, followed by resolveRoutes().
+         */
+        void invalidateRoutes(void);
+
         void simpleSlope(int slot, int au, float slope, float offset);
 
+        /**
+         * Map an automation through a curve
+         *
+         * The curve is sampled into a lookup table, so evaluating it is a
+         * table lookup, no matter how many points it has.
+         *
+         * @param control_type 1 for piecewise linear, 2 for a smoothed curve
+         *   which is monotonic between each two points
+         * @param points @p n pairs of x (0..1, increasing) and y (like the
+         *   results of simpleSlope(), clamped to the parameter's range)
+         */
+        void setCurve(int slot_id, int sub, int control_type,
+                      const float *points, int n);
+
+        /**
+         * Recompile the batched evaluation of an automation
+         *
+         * This is done by all functions of this class which change
+         * automations. It must be called after changing an automation's
+         * fields directly, e.g. its control points.
+         */
+        void updateKernel(int slot_id, int sub);
+
+        /**
+         * Smooth the values of an automation
+         *
+         * Smoothed automations are only evaluated in processBlock(), even if
+         * set by setSlot(). Each block, their value moves towards the slot's
+         * value, and it is only sent if it changed by at least the
+         * parameter's resolution (param_step). Toggles are not smoothed.
+         *
+         * @param type see AutomationMapping::smooth_type
+         * @param blocks see AutomationMapping::smooth_time
+         */
+        void setSlotSubSmoothing(int slot_id, int sub, int type,
+                                 float blocks);
+
+        /**
+         * Set a slot value for the next processBlock() call [RT]
+         *
+         * Like setSlot(), but the slot is only evaluated in processBlock().
+         */
+        void setSlotDeferred(int slot_id, float value);
+
+        /**
+         * Evaluate all slots changed by setSlotDeferred() [RT]
+         *
+         * All automations of the changed slots are evaluated in one pass,
+         * from precompiled mappings, without allocating. All resulting
+         * messages are sent to the backend as one bundle.
+         *
+         * If automations are smoothed, this must be called once per block.
+         */
+        void processBlock(void);
+
         int free_slot(void) const;
 
         AutomationSlot *slots;
@@ -137,12 +280,24 @@ class AutomationMgr
         struct AutomationMgrImpl *impl;
         const rtosc::Ports *p;
         void *instance;
+        RtData *rtdata;
 
         std::function<void(const char *)> backend;
 
+        //If set, MIDI values only set the slots for processBlock(). Several
+        //values per block, like the coarse and fine part of an NRPN, then
+        //cause one update.
+        bool coalesce;
+
         int damaged;
     private:
-    
+        //call the port of kernel k directly, if it has a route
+        bool callPort(int k, const char *msg);
+        //set the slots bound to a controller, returns if there are any
+        bool setBound(int par_id, bool is_nrpn, float value);
+        //bind a controller to the next learning slot
+        void learnMidi(int par_id, bool is_nrpn, float value);
+
         /** RPN and NPRPN */
         struct { //nrpn
             int parhi, parlo;
@@ -0,0 +1,120 @@
+#ifndef RTOSC_BROADCAST_COALESCER_H
+#define RTOSC_BROADCAST_COALESCER_H
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace rtosc
+{
+class ThreadLink;
+
+/**
+ * Collects the broadcasts of one block and forwards only the latest value
+ * of each path
+ *
+ * Parameter setters broadcast each new value. If a value changes many times
+ * per block, e.g. by automation or by a controller, only the last one is of
+ * interest for the listeners. The coalescer sits between the broadcast
+ * sink of the realtime thread (e.g. RtData::broadcast(const char*)) and the
+ * outgoing ThreadLink. Messages are keyed by their path and their argument
+ * types. At the end of each block, flush() writes the latest message for
+ * each key as one bundle, in the order of the first broadcast.
+ *
+ * With changes_only, messages which are equal to the last one forwarded
+ * for their key are not forwarded again. Messages which do not fit into the
+ * link are dropped, but not remembered as forwarded.
+ *
+ * All functions except the constructor are realtime safe. If more paths or
+ * more bytes arrive in a block than the coalescer has been configured for,
+ * the messages collected so far are forwarded early.
+ */
+class BroadcastCoalescer
+{
+    public:
+        /**
+         * @param link Link where the messages are written to
+         * @param max_paths Maximum number of distinct keys per block
+         * @param buffer_size Bytes for the messages of one block
+         * @param bundle_size Maximum size of each bundle, which must not be
+         *        greater than the maximum message length of @p link
+         * @param max_tracked Maximum number of keys whose last forwarded
+         *        message is remembered for changes_only
+         */
+        BroadcastCoalescer(ThreadLink &link, size_t max_paths = 256,
+                           size_t buffer_size = 16384,
+                           size_t bundle_size = 4096,
+                           size_t max_tracked = 4096);
+
+        //! Keep @p msg as the latest message for its path and types
+        void broadcast(const char *msg);
+        //! Forward the latest messages of the block, call after each block
+        void flush(void);
+
+        //! Number of broadcasts received
+        size_t received(void) const { return m_received; }
+        //! Number of messages forwarded
+        size_t forwarded(void) const { return m_forwarded; }
+        //! Number of messages which did not fit into the link
+        size_t dropped(void) const { return m_dropped; }
+        //! Number of broadcasts which were coalesced or unchanged
+        size_t saved(void) const
+        {
+            return m_received - m_forwarded - m_dropped;
+        }
+        //! Number of bundles written to the link
+        size_t bundles(void) const { return m_bundles; }
+        //! Number of blocks which had to be flushed early
+        size_t overflows(void) const { return m_overflows; }
+        //! Set all metrics to zero
+        void reset_stats(void);
+
+        //! Whether unchanged messages shall not be forwarded again
+        bool changes_only;
+
+    private:
+        //! Latest message for one key in this block
+        struct entry_t
+        {
+            uint32_t offset, length;
+            uint32_t slot; //!< index into table
+        };
+        //! Hash table slot, entry is the index into entries plus 1
+        struct slot_t
+        {
+            uint32_t hash;
+            uint32_t entry;
+        };
+        //! Hashes of the last forwarded message of a key
+        struct tracked_t
+        {
+            uint64_t key;
+            uint64_t content; //!< 0 if nothing has been forwarded
+        };
+        //! Message which is about to be forwarded
+        struct pending_t
+        {
+            uint32_t slot;    //!< index into tracked, or its size if none
+            uint64_t content; //!< content hash to remember when forwarded
+        };
+
+        bool insert(const char *msg, size_t length, uint32_t hash);
+        bool unchanged(const char *msg, size_t length, pending_t &p);
+        bool forward(const char *msg, const pending_t &p);
+        void write_bundle(size_t used);
+
+        ThreadLink &link;
+        std::vector<entry_t> entries;
+        std::vector<slot_t> table;
+        std::vector<char> data;
+        size_t data_used;
+        std::vector<char> bundle;
+        std::vector<tracked_t> tracked;
+        size_t tracked_used;
+        //! Elements of the bundle which is being built
+        std::vector<pending_t> pending;
+
+        size_t m_received, m_forwarded, m_dropped, m_bundles, m_overflows;
+};
+
+}
+#endif
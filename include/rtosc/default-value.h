@@ -34,6 +34,7 @@
 
 #include <cstdint>
 #include <rtosc/rtosc.h>
+#include <rtosc/arena.h>
 
 namespace rtosc {
 
@@ -79,6 +80,20 @@ int get_default_value(const char* port_name, const char *port_args,
                       std::size_t n, rtosc_arg_val_t* res,
                       char *strbuf, size_t strbufsize);
 
+/**
+ * Return a port's default value, arg-val version, storing strings and blobs
+ * in an arena
+ *
+ * Like the overload above, but strings and blobs are allocated from
+ * @p arena, so no string buffer can overflow. They stay valid until the arena
+ * is being reset.
+ */
+int get_default_value(const char* port_name, const char *port_args,
+                      const struct Ports& ports,
+                      void* runtime, const struct Port* port_hint,
+                      std::size_t n, rtosc_arg_val_t* res,
+                      rtosc_arena_t* arena);
+
 }
 
 #endif // RTOSC_DEFAULT_VALUE
@@ -0,0 +1,146 @@
+#ifndef RTOSC_MESSAGE_POOL_H
+#define RTOSC_MESSAGE_POOL_H
+#include <atomic>
+#include <cstdarg>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace rtosc
+{
+
+/**
+ * Realtime safe pool of message buffers in a few size classes
+ *
+ * Replies built from arguments (e.g. RtData::reply(path, args, ...)) are
+ * built in a stack buffer, which can not hold large messages like blobs or
+ * long strings, and heap allocation is not realtime safe. Such messages are
+ * built in a buffer of a pool instead, see RtData::message_pool(). The pool
+ * preallocates a fixed number of buffers for each size class and hands out
+ * the smallest free buffer that fits. If all buffers of a class are in use,
+ * a larger class is tried.
+ *
+ * All functions except the constructors and the destructor are lock-free
+ * and can be called from any thread, e.g. a buffer can be acquired in the
+ * realtime thread and released in another thread.
+ */
+class MessagePool
+{
+    public:
+        //! Size and number of the buffers of one class
+        struct size_class
+        {
+            size_t size;
+            size_t count;
+        };
+
+        //! Buffer from the pool, which is released when it is destroyed
+        class buffer
+        {
+            public:
+                buffer(void) : pool(nullptr), m_data(nullptr), m_size(0) {}
+                buffer(buffer &&other)
+                    : pool(other.pool), m_data(other.m_data),
+                      m_size(other.m_size)
+                {
+                    other.m_data = nullptr;
+                }
+                buffer &operator=(buffer &&other);
+                ~buffer(void) { release(); }
+
+                buffer(const buffer &) = delete;
+                buffer &operator=(const buffer &) = delete;
+
+                char *data(void) const { return m_data; }
+                //! Capacity, which can be larger than requested
+                size_t size(void) const { return m_size; }
+                //! Whether the pool could provide a buffer
+                explicit operator bool(void) const { return m_data; }
+                //! Give the buffer back to the pool early
+                void release(void);
+
+            private:
+                friend class MessagePool;
+                buffer(MessagePool *pool, char *data, size_t size)
+                    : pool(pool), m_data(data), m_size(size) {}
+
+                MessagePool *pool;
+                char *m_data;
+                size_t m_size;
+        };
+
+        //! Pool with 64 x 256, 32 x 1024, 16 x 8192 and 4 x 65536 bytes
+        MessagePool(void);
+        explicit MessagePool(const std::vector<size_class> &classes);
+        ~MessagePool(void);
+
+        MessagePool(const MessagePool &) = delete;
+        MessagePool &operator=(const MessagePool &) = delete;
+
+        /**
+         * Get a buffer of at least @p size bytes
+         * @return an empty buffer if no buffer is large enough or if all
+         *         fitting buffers are in use
+         */
+        buffer acquire(size_t size);
+        /**
+         * Build an OSC message in a buffer of the pool, like rtosc_vmessage()
+         * @return an empty buffer if the message does not fit any free buffer
+         */
+        buffer vmessage(const char *path, const char *args, va_list va);
+        //! Like vmessage(), with the arguments passed directly
+        buffer message(const char *path, const char *args, ...);
+
+        //! Size of the largest buffers
+        size_t max_size(void) const;
+
+        //! Number of buffers handed out
+        size_t acquired(void) const { return m_acquired; }
+        //! Number of buffers handed out from a larger class than needed,
+        //! because the fitting classes were exhausted
+        size_t spilled(void) const { return m_spilled; }
+        //! Number of requests which could not be served
+        size_t failed(void) const { return m_failed; }
+        //! Number of buffers currently in use
+        size_t in_use(void) const { return m_in_use; }
+        //! Maximum of in_use() since the last reset_stats()
+        size_t high_water(void) const { return m_high_water; }
+        //! Set all metrics to zero, except in_use()
+        void reset_stats(void);
+
+        /**
+         * Pool used by RtData::message_pool() unless it is overridden
+         *
+         * The pool is constructed during static initialization, so using
+         * it from the realtime thread does not allocate. It must not be
+         * used by constructors of other static objects.
+         */
+        static MessagePool &default_pool(void);
+
+    private:
+        struct class_t
+        {
+            size_t size, count;
+            char *memory;
+            //! Per buffer, the index plus 1 of the next free buffer
+            std::unique_ptr<std::atomic<uint32_t>[]> next;
+            //! Change counter (upper half) and index plus 1 of the first
+            //! free buffer (lower half), the counter avoids ABA problems
+            std::atomic<uint64_t> head;
+        };
+
+        char *pop(class_t &c);
+        void push(class_t &c, uint32_t index);
+        void release(char *data);
+
+        std::unique_ptr<class_t[]> classes;
+        size_t num_classes;
+        std::vector<char> memory;
+
+        std::atomic<size_t> m_acquired, m_spilled, m_failed;
+        std::atomic<size_t> m_in_use, m_high_water;
+};
+
+}
+#endif
@@ -77,10 +77,38 @@ class MidiMapperStorage
         TinyVector<callback_t> callbacks;
         //RT RW
         TinyVector<int> values;
-
-        bool handleCC(int ID, int val, write_cb write);
-
-        //TODO try to change O(n^2) algorithm to O(n)
+        //RT Read Only, see buildLookup()
+        //mapping index per channel and CC, -1 if unmapped
+        TinyVector<int> cc_lookup;
+        //open addressing hash of {ID, mapping index} for all other IDs
+        TinyVector<std::pair<int,int>> id_lookup;
+        //RT RW, see buildLookup()
+        //value indices whose callbacks are deferred to flush()
+        TinyVector<int> changed;
+        TinyVector<char> queued;
+        int nchanged = 0;
+
+        //Set the coarse or fine part of a value [RT]
+        //If defer is set, the callback is only called by flush()
+        bool handleCC(int ID, int val, write_cb write, bool defer=false);
+
+        //Set a complete 14 bit value, e.g. from a high resolution
+        //controller [RT]. If defer is set, the callback is only called by
+        //flush()
+        bool handleValue(int ID, int val, write_cb write, bool defer=false);
+
+        //Call the callbacks of all deferred values once [RT]
+        void flush(write_cb write);
+
+        //Build the lookup tables for handleCC() after changing the mapping
+        //[nRT]. Without them, handleCC() searches the mapping and can not
+        //defer values
+        void buildLookup(void);
+
+        //Index of the mapping for ID, or -1
+        int findMapping(int ID) const;
+
+        //Take over the values of all IDs which are also mapped in storage
         void cloneValues(const MidiMapperStorage &storage);
 
         MidiMapperStorage *clone(void);
@@ -159,6 +187,15 @@ class MidiMapperRT
         void setBackendCb(std::function<void(const char*)> cb);
         void setFrontendCb(std::function<void(const char*)> cb);
         void handleCC(int par, int val, char chan=1, bool nrpn=false);
+        //Set a complete 14 bit value of a controller, instead of its
+        //coarse and fine parts
+        void handleCC14(int par, int val, char chan=1, bool nrpn=false);
+        //Set a 32 bit normalized value of a controller, like in MIDI 2.0.
+        //Mapped values have 14 bit.
+        void handleValue(int par, uint32_t val, char chan=1, bool nrpn=false);
+        //Call each callback once with the last value since the previous
+        //block, if coalesce is set
+        void processBlock(void);
         void addWatch(void);
         void remWatch(void);
 
@@ -168,6 +205,9 @@ class MidiMapperRT
         Port bindPort(void);
 
         static const Ports ports;
+    private:
+        void watch(int ID);
+    public:
 
         //Fixed upper bounded size set of integer IDs
         class PendingQueue
@@ -216,6 +256,9 @@ class MidiMapperRT
         PendingQueue pending;
         MidiMapperStorage *storage;
         unsigned watchSize;
+        //Defer callbacks to processBlock(), so e.g. the coarse and fine
+        //part of a value cause only one update
+        bool coalesce;
         std::function<void(const char*)> backend;
         std::function<void(const char*)> frontend;
 };
@@ -231,6 +274,12 @@ struct MidiAddr
     char *path;
     //The conversion function for 'f' types
     const char *conversion;
+    //The precompiled conversion, see MidiTable::translate()
+    //'l' - linear, value = a*x+b
+    //'e' - logarithmic, value = exp(a*x+b)
+    //0   - unknown, value = 0
+    char  scale;
+    float a, b;
 };
 
 
@@ -279,6 +328,12 @@ class MidiTable
         //TODO generalize to an addScalingFunction() system
         static float translate(uint8_t val, const char *meta);
 
+        /**
+         * Like translate(), but with the conversion precompiled by
+         * mash_port()
+         */
+        static float convert(uint8_t val, const MidiAddr &addr);
+
     private:
         class MidiTable_Impl *impl;
 };
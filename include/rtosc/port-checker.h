@@ -32,6 +32,7 @@
 #include <stdexcept>
 #include <string>
 #include <vector>
+#include <deque>
 #include <set>
 #include <map>
 #include <rtosc/rtosc.h>
@@ -154,6 +155,14 @@ public:
 
         virtual void vinit(const char *target_url) = 0;
 
+        //! Whether received messages shall be passed to keep() (set by
+        //! receive())
+        bool keeping = false;
+        //! Messages received in receive(), for each expected path
+        std::map<std::string, std::deque<std::vector<char>>> m_received;
+        //! Keep a message received in receive() if its path is expected
+        void keep(std::vector<char>&& msg);
+
     public:
         server(int t) : timeout_msecs(t) {}
         virtual ~server() {}
@@ -161,6 +170,8 @@ public:
         //! Return which of the expected paths from wait_for_reply() has
         //! has been received
         int replied_path() const { return _replied_path; }
+        //! Return the timeout for replies in milliseconds
+        int timeout() const { return timeout_msecs; }
 
         void init(const char *target_url);
 
@@ -185,15 +196,42 @@ public:
             exp_paths_n_args[0].clear();
             return _wait_for_reply(buffer, args, 0, 0, exp_paths...);
         }
+
+        /*
+            Pipelined mode: instead of waiting for one reply, all messages
+            with expected paths are kept until they are taken
+        */
+        //! Receive messages for at most @p timeout_msecs and keep those
+        //! with expected paths. Returns false if this is not supported
+        virtual bool receive(int timeout_msecs) {
+            (void)timeout_msecs; return false; }
+        //! Keep messages with @p path from now on
+        void expect(const char* path);
+        //! Stop keeping messages with @p path and drop those kept
+        void unexpect(const char* path);
+        //! Take the oldest message kept with @p path, if any
+        bool take_reply(const char* path, std::vector<char>* buffer,
+                        std::vector<rtosc_arg_val_t>* args);
     };
 
 private:
     server* const sender; //!< send and check replies
     server* const other; //!< check broadcasts
 
+    //! additional connections for the pipelined mode: sender and other
+    std::vector<std::pair<server*, server*>> m_connections;
+    //! max. parameter checks in flight per connection, 0 for serial checks
+    int m_window = 0;
+    //! parameters to check after the walk: path to send to, port name
+    std::vector<std::pair<std::string, std::string>> m_param_checks;
+
     //! send a message via the sender
     bool send_msg(const char *address,
                   size_t nargs, const rtosc_arg_val_t *args);
+    //! Check that a parameter replies and broadcasts, waiting for each reply
+    void check_parameter(const char *full_path, const std::string& port);
+    //! Run all parameter checks of m_param_checks, pipelined if possible
+    void run_param_checks();
     /**
      * Execute all checks recursively under a given OSC path
      * @param loc the OSC root path for the recursive checks
@@ -214,6 +252,24 @@ public:
     port_checker(server* sender, server* other) :
         sender(sender), other(other) {}
 
+    /**
+     * Check parameters pipelined instead of one after another
+     *
+     * Up to @p window parameter checks are kept in flight per connection and
+     * replies are matched by path. The checks are split across the
+     * connection of this port checker and @p connections, in the order of
+     * their ports, so subtrees mostly stay on one connection. The issues
+     * found are the same as for serial checks: In both modes, parameters are
+     * checked after all ports have been walked, so "enabled by" ports are
+     * queried before any parameter is changed by a check.
+     *
+     * If any server does not support server::receive(), checks are serial.
+     * @param connections additional (sender, other) pairs, not yet
+     *        initialized
+     */
+    void set_pipelined(int window,
+        std::vector<std::pair<server*, server*>> connections = {});
+
     //! Let the port checker connect to url and find issues for all ports
     //! @param url URL in format osc.udp://xxx.xxx.xxx.xxx:ppppp/, or just
     //!     ppppp (which means osc.udp://127.0.0.1:ppppp/)
@@ -252,6 +308,68 @@ public:
     void print_statistics() const;
 };
 
+struct Ports;
+class inprocess_server;
+
+/**
+ * App to check in-process, without any network
+ *
+ * Messages from inprocess_server objects are dispatched straight into a Ports
+ * tree. Replies go to the sending server, broadcasts to all connected
+ * servers. Like a remote app, it answers "/path-search" using path_search().
+ */
+class inprocess_app
+{
+    const Ports& ports;
+    void* object;
+    std::size_t max_ports;
+    std::vector<inprocess_server*> servers;
+    std::vector<char> path_search_buffer;
+
+    friend class inprocess_server;
+    void connect(inprocess_server* server);
+    void disconnect(inprocess_server* server);
+    void dispatch(const char* msg, inprocess_server* from);
+
+public:
+    //! @param object runtime object of the root ports
+    //! @param max_ports max. number of child ports of any port
+    inprocess_app(const Ports& ports, void* object = nullptr,
+                  std::size_t max_ports = 256);
+};
+
+/**
+ * port_checker::server implementation for an inprocess_app
+ *
+ * All replies are delivered during send_msg(), so waiting for a reply never
+ * blocks: if it is not there yet, it is missing.
+ */
+class inprocess_server : public port_checker::server
+{
+    inprocess_app& app;
+    std::deque<std::vector<char>> inbox;
+
+    void on_recv(std::vector<char>&& msg);
+
+protected:
+    bool _wait_for_reply(std::vector<char>* buffer,
+                         std::vector<rtosc_arg_val_t> * args,
+                         int n0, int n1) override;
+    void vinit(const char* target_url) override;
+
+public:
+    inprocess_server(inprocess_app& app, int timeout_msecs = 50)
+        : server(timeout_msecs), app(app) {}
+    ~inprocess_server();
+
+    bool send_msg(const char* address,
+                  size_t nargs, const rtosc_arg_val_t* args) override;
+    bool receive(int timeout_msecs) override;
+
+    //! Receive a message from the app
+    void deliver(const char* msg);
+};
+
 }
 
 #endif // RTOSC_PORT_CHECKER
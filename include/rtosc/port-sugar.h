@@ -392,6 +392,40 @@ template<class T> constexpr T spice(T*t) {return *t;}
 #define rShort(name) ":shortname\0=" name "\0"
 
 
+//Storage probing
+namespace rtosc {
+//! Marker for RtData::message: if set, queries to parameters with storage
+//! probing reply the address, size and kind of their storage instead of
+//! their value (see rtosc::StateSnapshot)
+inline const char *storage_probe(void)
+{
+    static const char probe = 0;
+    return &probe;
+}
+
+//! Kind of storage: 'f' (floating point), 'i' (signed) or 'u' (unsigned)
+template<class T> constexpr int storage_kind(const T&)
+{
+    return std::is_floating_point<T>::value ? 'f' :
+           std::is_signed<T>::value ? 'i' : 'u';
+}
+}
+
+//Storage probing is opt-in, as it costs a compare in every callback
+//To enable it for a range of ports (e.g. for rtosc::StateSnapshot), use
+//  #undef  rSTORAGE
+//  #define rSTORAGE rStorageProbe
+//The variables of these ports can not be bitfields
+#define rSTORAGE(var, kind)
+
+#define rStorageProbe(var, kind) \
+    if(data.message == rtosc::storage_probe() && !*args) { \
+        void *ptr = (void*)&(var); \
+        data.reply(loc, "bii", (int)sizeof(void*), &ptr, \
+                   (int)sizeof(var), (int)(kind)); \
+        return; \
+    }
+
 //Callback Implementations
 #define rBOIL_BEGIN [](const char *msg, rtosc::RtData &data) { \
         (void) msg; (void) data; \
@@ -414,6 +448,7 @@ template<class T> constexpr T spice(T*t) {return *t;}
 #define rAPPLY(n,t) rCAPPLY(obj->n, t, obj->n = var)
 
 #define rParamCb(name) rBOIL_BEGIN \
+        rSTORAGE(obj->name, rtosc::storage_kind(obj->name)) \
         if(!strcmp("", args)) {\
             data.reply(loc, "c", obj->name); \
         } else { \
@@ -425,6 +460,7 @@ template<class T> constexpr T spice(T*t) {return *t;}
         } rBOIL_END
 
 #define rParamFCb(name) rBOIL_BEGIN \
+        rSTORAGE(obj->name, rtosc::storage_kind(obj->name)) \
         if(!strcmp("", args)) {\
             data.reply(loc, "f", obj->name); \
         } else { \
@@ -436,6 +472,7 @@ template<class T> constexpr T spice(T*t) {return *t;}
         } rBOIL_END
 
 #define rParamICb(name) rBOIL_BEGIN \
+        rSTORAGE(obj->name, rtosc::storage_kind(obj->name)) \
         if(!strcmp("", args)) {\
             data.reply(loc, "i", obj->name); \
         } else { \
@@ -473,6 +510,7 @@ template<class T> constexpr T spice(T*t) {return *t;}
 #define rOptionCb_(name) rCOptionCb_(obj->name, obj->name = static_cast<std::remove_reference<decltype(obj->name)>::type>(var))
 
 #define rOptionCb(name) rBOIL_BEGIN \
+    rSTORAGE(obj->name, 'd') \
     rOptionCb_(name) \
     rBOIL_END
 
@@ -482,6 +520,7 @@ template<class T> constexpr T spice(T*t) {return *t;}
 
 
 #define rToggleCb(name) rBOIL_BEGIN \
+        rSTORAGE(obj->name, 'd') \
         if(!strcmp("", args)) {\
             data.reply(loc, obj->name ? "T" : "F"); \
         } else { \
@@ -541,6 +580,7 @@ template<class T> constexpr T spice(T*t) {return *t;}
 
 
 #define rArrayFCb(name) rBOILS_BEGIN \
+        rSTORAGE(obj->name[idx], rtosc::storage_kind(obj->name[idx])) \
         if(!strcmp("", args)) {\
             data.reply(loc, "f", obj->name[idx]); \
         } else { \
@@ -551,6 +591,7 @@ template<class T> constexpr T spice(T*t) {return *t;}
         } rBOILS_END
 
 #define rArrayTCb(name) rBOILS_BEGIN \
+        rSTORAGE(obj->name[idx], 'd') \
         if(!strcmp("", args)) {\
             data.reply(loc, obj->name[idx] ? "T" : "F"); \
         } else { \
@@ -562,6 +603,7 @@ template<class T> constexpr T spice(T*t) {return *t;}
         } rBOILS_END
 
 #define rArrayTCbMember(name, member) rBOILS_BEGIN \
+        rSTORAGE(obj->name[idx].member, 'd') \
         if(!strcmp("", args)) {\
             data.reply(loc, obj->name[idx].member ? "T" : "F"); \
         } else { \
@@ -574,6 +616,7 @@ template<class T> constexpr T spice(T*t) {return *t;}
 
 
 #define rArrayICb(name) rBOILS_BEGIN \
+        rSTORAGE(obj->name[idx], rtosc::storage_kind(obj->name[idx])) \
         if(!strcmp("", args)) {\
             data.reply(loc, "i", obj->name[idx]); \
         } else { \
@@ -586,6 +629,7 @@ template<class T> constexpr T spice(T*t) {return *t;}
 
 
 #define rArrayOptionCb(name) rBOILS_BEGIN \
+    rSTORAGE(obj->name[idx], 'd') \
     rOptionCb_(name[idx]) \
     rBOILS_END
 
@@ -30,8 +30,9 @@
 #define PORTS_RUNTIME
 
 #include <cstddef>
-#include <rtosc/rtosc.h>
 #include <vector>
+#include <rtosc/rtosc.h>
+#include <rtosc/arena.h>
 
 namespace rtosc {
 namespace helpers {
@@ -65,13 +66,59 @@ const char* get_value_from_runtime(void* runtime, const struct Ports& ports,
  * @param buffersize Size of @p buffer_with_port
  * @param max_args Maximum capacity of @p arg_vals
  * @param arg_vals Argument buffer for returned argument values
+ * @param arena Arena to copy returned blobs to, such that they stay valid
+ *   after the capture. Can be NULL if the port returns no blobs.
  * @return The number of argument values stored in @p arg_vals
  */
+size_t get_value_from_runtime(void* runtime, const struct Port& port,
+                              size_t loc_size, char* loc,
+                              const char* portname_from_base, std::size_t buffersize,
+                              std::size_t max_args, rtosc_arg_val_t* arg_vals, rtosc_arena_t* arena);
+
+/**
+ * @brief Returns a port's current value(s)
+ *
+ * Like the overload above, but each returned blob is copied into a new
+ * element of @p scratch_bufs. Prefer the arena version, which does not
+ * allocate one vector per blob.
+ * @param scratch_bufs Buffers for the returned blobs. Can be NULL if the
+ *   port returns no blobs.
+ */
 size_t get_value_from_runtime(void* runtime, const struct Port& port,
                               size_t loc_size, char* loc,
                               const char* portname_from_base, std::size_t buffersize,
                               std::size_t max_args, rtosc_arg_val_t* arg_vals, std::vector<std::vector<char> > *scratch_bufs);
 
+//! Overload for a literal nullptr, which would be ambiguous otherwise
+size_t get_value_from_runtime(void* runtime, const struct Port& port,
+                              size_t loc_size, char* loc,
+                              const char* portname_from_base, std::size_t buffersize,
+                              std::size_t max_args, rtosc_arg_val_t* arg_vals, std::nullptr_t);
+
+/**
+ * @brief Finds the leaf port which handles a path, to call it directly
+ *
+ * A query of the path is dispatched, and the first port which replies is
+ * captured, together with the runtime object it is called with. Afterwards,
+ * the port's callback can be called with the captured runtime object and the
+ * part of the query starting at @p leaf, instead of dispatching the query.
+ * @param runtime The runtime object of @p ports
+ * @param ports The ports where @p query is relative to
+ * @param loc_size Size of loc, or 0 if @p loc already holds the full path
+ * @param loc A buffer where dispatch can write down the currently dispatched
+ *   path
+ * @param query The path as a message without arguments. If it begins with a
+ *   slash, it is dispatched from the root, like with base_dispatch.
+ * @param obj Set to the runtime object of the returned port
+ * @param leaf Set to the offset of the part of @p query which the returned
+ *   port receives
+ * @return The leaf port, or NULL if no leaf port replied to the query
+ */
+const struct Port* find_leaf_port(void* runtime, const struct Ports& ports,
+                                  size_t loc_size, char* loc,
+                                  const char* query,
+                                  void** obj, std::size_t* leaf);
+
 // TODO: loc should probably not be passed,
 //       since it can be allocated in constant time?
 // TODO: clean up those funcs:
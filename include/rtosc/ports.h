@@ -46,6 +46,7 @@ typedef const char *msg_t;
 
 struct Port;
 struct Ports;
+class MessagePool;
 
 //! data object for the dispatch routine
 struct RtData
@@ -89,6 +90,15 @@ struct RtData
             rtosc_arg_t *vals);
 
     virtual void forward(const char *rational=NULL);
+
+    /**
+     * Pool for messages built from arguments, e.g. by reply(path, args, ...),
+     * which do not fit the 8 KiB stack buffer
+     *
+     * Defaults to MessagePool::default_pool(). Override it to use a pool
+     * of the application, or return NULL to drop such messages.
+     */
+    virtual MessagePool *message_pool(void);
 };
 
 
@@ -33,6 +33,7 @@
 #define RTOSC_PRETTY_FORMAT
 
 #include <rtosc/rtosc.h>
+#include <rtosc/arena.h>
 
 #ifdef __cplusplus
 extern "C" {
@@ -179,6 +180,21 @@ size_t rtosc_scan_arg_vals(const char* src,
                            rtosc_arg_val_t *args, size_t n,
                            char* buffer_for_strings, size_t bufsize);
 
+/**
+ * Scan a fixed number of argument values from a string, storing strings and
+ * blobs in an arena
+ *
+ * Like rtosc_scan_arg_vals(), but the buffer for strings and blobs is
+ * allocated from @p arena, so it can not overflow. The size of this buffer
+ * is the length of @p src, so @p src should not be much longer than the
+ * argument values.
+ *
+ * @return The number of bytes scanned, or 0 if malloc failed
+ */
+size_t rtosc_scan_arg_vals_arena(const char* src,
+                                 rtosc_arg_val_t *args, size_t n,
+                                 rtosc_arena_t* arena);
+
 /**
  * Scan an OSC message from a string
  *
@@ -202,6 +218,30 @@ size_t rtosc_scan_message(const char* src,
                           rtosc_arg_val_t *args, size_t n,
                           char* buffer_for_strings, size_t bufsize);
 
+/**
+ * Scan an OSC message from a string in a single pass
+ *
+ * Unlike rtosc_scan_message(), this function does not require calling
+ * rtosc_count_printed_arg_vals_of_msg() before: The syntax is checked while
+ * scanning, and all output is allocated from an arena. Preceding and trailing
+ * whitespace and comments will be consumed.
+ *
+ * @param src The string
+ * @param address Will point to the scanned port address
+ * @param args Will point to the array of scanned argument values
+ * @param nargs Will be set to the number of scanned argument values
+ * @param arena The arena for the address, the argument values and all
+ *   strings and blobs. They stay valid until the arena is being reset.
+ * @return The number of bytes scanned (>0), or, like
+ *   rtosc_count_printed_arg_vals_of_msg(): -1 if the address could not be
+ *   scanned, INT_MIN if the whole string is whitespace, or if the nth arg
+ *   (range 1...) can not be scanned, -n.
+ */
+int rtosc_scan_message_arena(const char* src,
+                             const char** address,
+                             rtosc_arg_val_t** args, size_t* nargs,
+                             rtosc_arena_t* arena);
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,81 @@
+/**
+ * @file shared-thread-link.h
+ * ThreadLink between processes, via POSIX shared memory
+ *
+ * @note Only POSIX systems are supported. Waiting uses futexes on Linux and
+ *       polling elsewhere.
+ */
+
+#ifndef RTOSC_SHARED_THREAD_LINK
+#define RTOSC_SHARED_THREAD_LINK
+
+#include <cstddef>
+#include <string>
+#include <rtosc/thread-link.h>
+
+namespace rtosc {
+
+/**
+ * A ThreadLink whose ringbuffer lives in a named POSIX shared memory
+ * object, so the writing and the reading side can be different processes.
+ *
+ * Like ThreadLink, each object transports messages in one direction,
+ * from one writer to one reader. write(), read() and hasNext() work
+ * exactly like for ThreadLink and do not call into the OS, so a realtime
+ * thread can poll for messages or send them.
+ *
+ * A non-realtime reader can block in wait() until a writer calls notify().
+ * notify() only does a system call if a reader is waiting. Realtime writers
+ * which must not do any system call should not call notify() at all; the
+ * reader then relies on the timeout of wait().
+ */
+class SharedThreadLink : public ThreadLink
+{
+    struct mapping_t
+    {
+        struct shared_header_t *header;
+        size_t map_size;
+        size_t max_message_length, max_messages;
+        bool created;
+    };
+
+    public:
+        /**
+         * Create a new shared memory object @p name (e.g. "/synth-ui"),
+         * replacing any stale object of that name
+         * @throws std::runtime_error if creation fails
+         */
+        SharedThreadLink(const char *name, size_t max_message_length,
+                         size_t max_messages);
+        /**
+         * Open the shared memory object @p name, which has been created
+         * by another SharedThreadLink before
+         * @throws std::runtime_error if there is no such object
+         */
+        explicit SharedThreadLink(const char *name);
+        //! Unmap the memory, the creator also removes the name
+        ~SharedThreadLink(void);
+
+        SharedThreadLink(const SharedThreadLink&) = delete;
+        SharedThreadLink& operator=(const SharedThreadLink&) = delete;
+
+        //! Wake up a reader that waits in wait(), call after writing
+        void notify(void);
+        /**
+         * Wait until a message can be read, or until @p timeout_msecs have
+         * passed (negative values wait forever)
+         * @return whether a message can be read
+         */
+        bool wait(int timeout_msecs = -1);
+
+    private:
+        SharedThreadLink(const mapping_t &m, const char *name);
+        static mapping_t map(const char *name, bool create,
+                             size_t max_message_length, size_t max_messages);
+
+        const mapping_t m;
+        const std::string name;
+};
+
+}
+#endif
@@ -0,0 +1,67 @@
+#ifndef RTOSC_STATE_SNAPSHOT_H
+#define RTOSC_STATE_SNAPSHOT_H
+#include <cstddef>
+
+namespace rtosc
+{
+struct Ports;
+struct StateSnapshotImpl;
+
+/**
+ * Binary images of the parameters of a subtree
+ *
+ * On construction, the storage of all parameters of an object which were
+ * created by rParam*, rToggle, rOption and rArray* with storage probing
+ * enabled (see rStorageProbe in port-sugar.h) is located once (not
+ * realtime safe). Other parameters are skipped. Afterwards, images of these
+ * values can be captured, applied, swapped and morphed by copying raw
+ * memory, without dispatching any message (realtime safe). All operations
+ * can be limited to a range of parameters to spread them over several audio
+ * blocks.
+ *
+ * Numeric parameters are interpolated when morphing, toggles and options
+ * switch at the middle.
+ *
+ * @note Changes are not broadcast and do not call rChangeCb. Also, the
+ *       runtime objects of the subtree must not move while the snapshot is
+ *       in use.
+ */
+class StateSnapshot
+{
+    public:
+        //! Locate the parameters of @p object, described by @p ports
+        StateSnapshot(const Ports &ports, void *object);
+        ~StateSnapshot(void);
+        StateSnapshot(const StateSnapshot&) = delete;
+        StateSnapshot& operator=(const StateSnapshot&) = delete;
+
+        //! Number of parameters
+        size_t size(void) const;
+        //! Number of bytes of an image
+        size_t image_size(void) const;
+        //! Path of parameter @p i
+        const char *path(size_t i) const;
+
+        //! Copy the current values into @p image
+        void capture(char *image, size_t first = 0,
+                     size_t count = (size_t)-1) const;
+        //! Set the values from @p image
+        void apply(const char *image, size_t first = 0,
+                   size_t count = (size_t)-1);
+        //! Exchange the current values with @p image
+        void swap(char *image, size_t first = 0, size_t count = (size_t)-1);
+        //! Set the values between @p a (@p t = 0) and @p b (@p t = 1)
+        void morph(const char *a, const char *b, float t, size_t first = 0,
+                   size_t count = (size_t)-1);
+
+        //! Start a crossfade from image @p a to image @p b over @p blocks
+        //! calls of process_block(). Both images must stay valid until then
+        void crossfade(const char *a, const char *b, int blocks);
+        //! Advance a crossfade by one block, returns whether it continues
+        bool process_block(void);
+
+    private:
+        StateSnapshotImpl *impl;
+};
+}
+#endif
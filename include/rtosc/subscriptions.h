@@ -0,0 +1,145 @@
+#ifndef RTOSC_SUBSCRIPTIONS_H
+#define RTOSC_SUBSCRIPTIONS_H
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace rtosc
+{
+
+/**
+ * Registry of the OSC patterns that clients subscribed to
+ *
+ * Instead of sending each broadcast to every listener, a sender can ask the
+ * registry which clients want the message. Patterns have the semantics of
+ * rtosc_match(), e.g.:
+ *   - "/part0/" matches everything below /part0/
+ *   - "/part0/volume" matches exactly this path
+ *   - "/part#16/volume", "/part{0,1}/", "/\*\/volume" and "/foo:f" use the
+ *     usual enumeration, option, wildcard and argument rules
+ *
+ * All patterns are compiled into one trie of their literal prefixes (the
+ * part before the first special character), so a message path is walked
+ * only once. Leading option lists are expanded into one literal pattern per
+ * option. Literal patterns are decided by the trie alone, all others are
+ * checked with rtosc_match() when the walk reaches the end of their
+ * literal prefix.
+ *
+ * Matching does not allocate memory. Changing the subscriptions does, and
+ * must not happen while a message is being matched, e.g. by doing both in
+ * the same thread.
+ */
+class SubscriptionRegistry
+{
+    public:
+        SubscriptionRegistry(void);
+
+        /**
+         * Subscribe @p client to all messages matching @p pattern
+         * @return false if the pattern does not start with a '/'
+         */
+        bool subscribe(int client, const char *pattern);
+        //! Remove one subscription, return whether it existed
+        bool unsubscribe(int client, const char *pattern);
+        //! Remove all subscriptions of @p client
+        void unsubscribe_all(int client);
+
+        //! Number of subscriptions
+        size_t size(void) const { return patterns.size(); }
+
+        /**
+         * Call @p f(client) once for each client that subscribed to
+         * @p msg, an OSC message
+         */
+        template<class F>
+        void match(const char *msg, F f)
+        {
+            if(!++generation) //wrapped around
+                reset_seen();
+            const char *pos = msg;
+            for(uint32_t n = 0; ; ++pos)
+            {
+                collect(nodes[n], msg, !*pos, f);
+                if(!*pos || !(n = child(nodes[n], *pos)))
+                    break;
+            }
+        }
+
+        //! Fill @p clients with the clients that subscribed to @p msg
+        //! @return the number of clients
+        size_t match(const char *msg, std::vector<int> &clients);
+
+    private:
+        //! How a pattern is decided when its node is reached
+        enum kind_t : uint8_t
+        {
+            prefix, //!< literal, ending with '/': matches here
+            exact,  //!< literal: matches if the path ends here
+            verify  //!< has special characters: rtosc_match() decides
+        };
+
+        struct pattern_t
+        {
+            std::string pattern;
+            int client;
+        };
+
+        //! Compiled reference to a pattern, stored per node
+        struct ref_t
+        {
+            kind_t   kind;
+            uint32_t client; //!< index into client_ids
+            const char *pattern;
+        };
+
+        struct node_t
+        {
+            //! Children and the characters leading to them
+            std::vector<std::pair<char, uint32_t>> children;
+            //! Range of the node's refs
+            uint32_t first, last;
+        };
+
+        uint32_t child(const node_t &node, char c) const
+        {
+            for(const auto &ch : node.children)
+                if(ch.first == c)
+                    return ch.second;
+            return 0;
+        }
+
+        //! Report the matching clients of the node's patterns
+        template<class F>
+        void collect(const node_t &node, const char *msg, bool path_end,
+                     F &f)
+        {
+            for(uint32_t i = node.first; i != node.last; ++i)
+            {
+                const ref_t &r = refs[i];
+                if(seen[r.client] == generation ||
+                   (r.kind == exact && !path_end) ||
+                   (r.kind == verify && !verify_match(r.pattern, msg)))
+                    continue;
+                seen[r.client] = generation;
+                f(client_ids[r.client]);
+            }
+        }
+
+        static bool verify_match(const char *pattern, const char *msg);
+        void reset_seen(void);
+        void compile(void);
+
+        std::vector<pattern_t> patterns;
+        //! Patterns with their leading option lists expanded
+        std::vector<std::string> expanded;
+        std::vector<node_t> nodes;
+        std::vector<ref_t> refs;
+        std::vector<int> client_ids;
+        //! Per client, the generation of the last match() it matched in
+        std::vector<uint32_t> seen;
+        uint32_t generation;
+};
+
+}
+#endif
@@ -1,6 +1,7 @@
 #ifndef RTOSC_SUBTREE_H
 #define RTOSC_SUBTREE_H
 #include <cstddef>
+#include <chrono>
 
 namespace rtosc{struct Ports; struct RtData;}
 
@@ -9,4 +10,88 @@ size_t subtree_serialize(char *buffer, size_t buffer_size,
 
 void subtree_deserialize(char *buffer, size_t buffer_size,
         void *object, rtosc::Ports *ports, rtosc::RtData &d);
+
+namespace rtosc
+{
+struct SubtreeSerializerImpl;
+
+/**
+ * Realtime safe, resumable version of subtree_serialize()
+ *
+ * The leaf ports of the subtree are collected once on construction, which
+ * is not realtime safe. Snapshots are then taken with begin() and resume(),
+ * which do not allocate, so a snapshot can be taken from the realtime
+ * thread, spread over several audio blocks if needed. The port and runtime
+ * object of each leaf port are resolved once per object, see compile(), and
+ * the ports are then called directly instead of walking the port tree.
+ *
+ * Each value is captured directly into the destination bundle, so values
+ * are not limited in size. If a value does not fit, the snapshot stops with
+ * status truncated instead of dropping the value.
+ *
+ * The resulting bundle can be replayed with subtree_deserialize() or, faster,
+ * with restore(). Note that values captured in different calls of resume()
+ * are from different points in time.
+ */
+class SubtreeSerializer
+{
+    public:
+        enum status_t
+        {
+            idle,      //!< no snapshot has been started
+            pending,   //!< some ports have not been captured yet
+            done,      //!< all ports have been captured
+            truncated  //!< a value did not fit, the snapshot is incomplete
+        };
+
+        //! Collect the leaf ports of @p ports (not realtime safe)
+        SubtreeSerializer(const Ports &ports);
+        ~SubtreeSerializer(void);
+        SubtreeSerializer(const SubtreeSerializer&) = delete;
+        SubtreeSerializer& operator=(const SubtreeSerializer&) = delete;
+
+        //! Start a snapshot of @p object into @p buffer (realtime safe)
+        void begin(char *buffer, size_t buffer_size, void *object);
+        //! Capture the values of at most @p max_ports ports (realtime safe)
+        status_t resume(size_t max_ports = (size_t)-1);
+        //! Capture values until @p budget has been spent (realtime safe)
+        //! @note The budget is checked after each port, so at least one port
+        //!       is captured per call
+        status_t resume_for(std::chrono::nanoseconds budget);
+
+        status_t status(void) const;
+        //! Length of the bundle captured so far, which is always valid
+        size_t length(void) const;
+        //! Number of leaf ports in the subtree
+        size_t size(void) const;
+        //! Number of ports already handled in the current snapshot
+        size_t position(void) const;
+        //! Path of the port which did not fit, or NULL if not truncated
+        const char *truncated_path(void) const;
+
+        /**
+         * Apply a snapshot to @p object in one pass (realtime safe)
+         *
+         * The elements of snapshots taken by this serializer are looked up
+         * by their path's hash and passed directly to their ports, the
+         * route to each port is resolved on first use. Other elements are
+         * dispatched through the port tree.
+         * @p d must be set up like for Ports::dispatch().
+         */
+        void restore(const char *buffer, size_t buffer_size, void *object,
+                     RtData &d);
+        /**
+         * Resolve the routes of all leaf ports for @p object (realtime safe)
+         *
+         * This walks the port tree once per leaf port, which begin(),
+         * resume() and restore() otherwise do on first use of each port.
+         */
+        void compile(void *object);
+        //! Forget the resolved routes, e.g. after runtime objects moved
+        void invalidate_routes(void);
+
+    private:
+        SubtreeSerializerImpl *impl;
+};
+}
 #endif
@@ -59,8 +59,13 @@ class ThreadLink
 
         /**
          * Directly write message to ringbuffer
+         *
+         * Bundles must end with a zero length, as created by rtosc_bundle()
+         * into a zeroed buffer, and are read back including it.
+         * @return false if the message was dropped, because it is longer
+         *         than max_message_length() or the ringbuffer is full
          */
-        void raw_write(const char *msg);
+        bool raw_write(const char *msg);
 
         /**
          * @returns true iff there is another message to be read in the buffer
@@ -106,6 +111,22 @@ class ThreadLink
          * Access to write buffer length
          */
         size_t buffer_size(void) const;
+        /**
+         * Maximum length of a message, as passed to the constructor
+         */
+        size_t max_message_length(void) const;
+    protected:
+        /**
+         * Use the ringbuffer in @p memory, which must have memory_size()
+         * bytes and stays owned by the caller
+         * @param initialize true to create an empty ringbuffer, false to
+         *        use the one which is already in @p memory
+         */
+        ThreadLink(size_t max_message_length, size_t max_messages,
+                   void *memory, bool initialize);
+        //! Bytes needed for the ringbuffer
+        static size_t memory_size(size_t max_message_length,
+                                  size_t max_messages);
     private:
         const size_t MaxMsg;
         const size_t BufferSize;
@@ -113,6 +134,8 @@ class ThreadLink
         char *read_buffer;
 
         struct internal_ringbuffer_t *ring;
+        //! Whether ring has been allocated by this object
+        bool owns_ring;
 };
 };
 #endif
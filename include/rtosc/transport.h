@@ -0,0 +1,248 @@
+/**
+ * @file transport.h
+ * Sockets for sending OSC packets between processes, without liblo
+ *
+ * Streams (TCP and UNIX domain sockets) delimit the packets either by a
+ * length prefix (OSC 1.0) or by SLIP (OSC 1.1), while each UDP datagram
+ * carries exactly one packet. Received packets are validated and parsed in
+ * place, out of the receive buffers, and can be passed directly into a
+ * ThreadLink.
+ *
+ * @note Nothing in here is realtime safe. Only POSIX systems are supported.
+ */
+
+#ifndef RTOSC_TRANSPORT_H
+#define RTOSC_TRANSPORT_H
+
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace rtosc
+{
+class ThreadLink;
+
+//! How packets are delimited on a stream
+enum class framing
+{
+    length_prefix, //!< big endian int32 size in front of each packet
+    slip           //!< SLIP with END bytes on both sides of each packet
+};
+
+//! Callback for received packets, the packet is only valid during the call
+typedef std::function<void(const char *packet, size_t length)> packet_cb;
+
+//! Return whether @p packet is an OSC message or bundle of @p length bytes
+bool valid_packet(const char *packet, size_t length);
+
+//! Return how many bytes a packet of @p length bytes may take when framed
+size_t framed_size(size_t length, framing f);
+
+/**
+ * Frame a packet for being sent over a stream
+ * @return the number of bytes written to @p dst, or 0 if @p size is too
+ *         small
+ */
+size_t frame_packet(char *dst, size_t size, const char *packet,
+                    size_t length, framing f);
+
+/**
+ * Incremental decoder for framed streams
+ *
+ * Data is received directly into space() and then decoded in place by
+ * commit(). Incomplete packets are kept until the next commit(). Packets
+ * which are not valid or which are longer than the maximum are dropped.
+ */
+class stream_decoder
+{
+    public:
+        stream_decoder(framing f, size_t max_packet);
+
+        //! Free memory where the next received data shall be written
+        char *space(void) { return buffer.data() + fill; }
+        //! Size of space()
+        size_t space_size(void) const { return buffer.size() - fill; }
+
+        /**
+         * Decode @p n bytes that have been written to space()
+         * @param cb Called for each complete, valid packet
+         * @return the number of packets passed to @p cb
+         */
+        size_t commit(size_t n, const packet_cb &cb);
+        //! Copy @p n bytes to space() and commit() them, in chunks
+        size_t feed(const char *data, size_t n, const packet_cb &cb);
+
+        //! Forget any incomplete packet
+        void reset(void);
+        //! Number of packets that were dropped so far
+        size_t dropped(void) const { return m_dropped; }
+
+    private:
+        size_t commit_length_prefix(const packet_cb &cb);
+        size_t commit_slip(const char *raw, size_t n, const packet_cb &cb);
+
+        const framing f;
+        const size_t max_packet;
+        std::vector<char> buffer;
+        //! Used bytes of buffer (for SLIP: decoded bytes)
+        size_t fill = 0;
+        //! Length prefix: bytes of an oversized packet yet to be skipped
+        size_t skip = 0;
+        //! SLIP: the last byte was an ESC
+        bool escape = false;
+        //! SLIP: the current packet is oversized and skipped until END
+        bool discard = false;
+        size_t m_dropped = 0;
+};
+
+/**
+ * A connected socket for exchanging OSC packets
+ *
+ * Connections are created by the static functions or by listener::accept().
+ * Sending blocks until the OS has taken all data, but at most for the send
+ * timeout per wait, receiving only waits as long as requested. When the peer
+ * closes a stream, or an error occurs, the connection becomes invalid.
+ */
+class connection
+{
+    public:
+        //! Create an invalid connection
+        connection(void) = default;
+        connection(connection &&other);
+        connection& operator=(connection &&other);
+        ~connection(void);
+
+        //! Connect to a TCP server, throws std::runtime_error on failure
+        static connection tcp(const char *host, int port,
+                              framing f = framing::slip,
+                              size_t max_packet = 8192);
+        //! Connect to a UNIX domain stream socket, throws on failure
+        static connection unix_socket(const char *path,
+                                      framing f = framing::slip,
+                                      size_t max_packet = 8192);
+        /**
+         * Bind a UDP socket to @p local_port and connect it to a peer,
+         * throws std::runtime_error on failure
+         * @param local_port Port to bind, 0 for any free port
+         * @param remote_port Port of the peer, 0 to connect later via
+         *        connect_udp()
+         */
+        static connection udp(int local_port, const char *host = "127.0.0.1",
+                              int remote_port = 0, size_t max_packet = 8192);
+        //! Set the peer of a UDP socket
+        void connect_udp(const char *host, int port);
+
+        //! Whether the connection can be used
+        bool valid(void) const { return fd >= 0; }
+        //! File descriptor, e.g. for poll()
+        int descriptor(void) const { return fd; }
+        //! Local port of TCP or UDP sockets
+        int local_port(void) const;
+        //! Close the connection, it becomes invalid
+        void close(void);
+
+        //! Send one packet, return whether it succeeded
+        bool send(const char *packet, size_t length);
+        //! Send one OSC message
+        bool send(const char *msg);
+        /**
+         * Send @p n packets with as few system calls as possible
+         *
+         * If the send timeout passes, the remaining packets are not sent.
+         * A stream connection is closed if a packet was sent only partially.
+         * @return the number of packets sent
+         */
+        size_t send(const char *const *packets, const size_t *lengths,
+                    size_t n);
+        /**
+         * Set how long sending waits for the OS to take more data
+         * @param timeout_msecs Time to wait, negative values wait forever
+         */
+        void set_send_timeout(int timeout_msecs);
+
+        /**
+         * Receive all packets that are available
+         * @param cb Called for each valid packet
+         * @param timeout_msecs Time to wait for the first data, negative
+         *        values wait forever
+         * @return the number of packets passed to @p cb
+         */
+        size_t receive(const packet_cb &cb, int timeout_msecs = 0);
+        /**
+         * Receive all packets that are available and write their messages
+         * into @p link. Bundles are unpacked, their time tags are dropped.
+         * Messages which are longer than the link's maximum message length
+         * or which do not fit into the link are dropped
+         * @return the number of messages written
+         */
+        size_t receive(ThreadLink &link, int timeout_msecs = 0);
+
+        //! Number of received packets or messages that were dropped so far
+        size_t dropped(void) const;
+
+    private:
+        friend class listener;
+        connection(int fd, bool stream, framing f, size_t max_packet);
+        size_t receive_datagrams(const packet_cb &cb);
+        size_t write_all(const char *data, size_t length);
+
+        int fd = -1;
+        bool stream = true;
+        framing f = framing::slip;
+        size_t max_packet = 0;
+        //! Decoder for the received stream data
+        std::unique_ptr<stream_decoder> decoder;
+        //! Receive slots for datagrams
+        std::vector<char> slots;
+        //! Send buffer for framing
+        std::vector<char> out;
+        //! End of each framed packet in out
+        std::vector<size_t> out_ends;
+        int send_timeout = 1000; //!< in milliseconds
+        size_t m_dropped = 0;
+};
+
+/**
+ * A listening socket which accepts stream connections
+ */
+class listener
+{
+    public:
+        listener(void) = default;
+        listener(listener &&other);
+        listener& operator=(listener &&other);
+        ~listener(void);
+
+        //! Listen on a TCP port (0 for any free port), throws on failure
+        static listener tcp(int port = 0, const char *host = "127.0.0.1");
+        //! Listen on a UNIX domain socket, which is removed again on
+        //! destruction. A stale socket at @p path is replaced, other files
+        //! are not. Throws on failure
+        static listener unix_socket(const char *path);
+
+        //! Whether the listener can be used
+        bool valid(void) const { return fd >= 0; }
+        //! Port of a TCP listener
+        int port(void) const;
+
+        /**
+         * Accept a connection
+         * @param timeout_msecs Time to wait, negative values wait forever
+         * @return the connection, which is invalid after a timeout
+         */
+        connection accept(framing f = framing::slip, int timeout_msecs = -1,
+                          size_t max_packet = 8192);
+
+    private:
+        void close(void);
+
+        int fd = -1;
+        //! Path of a UNIX domain socket
+        std::string path;
+};
+
+}
+
+#endif
@@ -1,37 +1,110 @@
 #ifndef RTOSC_UNDO_H
 #define RTOSC_UNDO_H
+#include <cstddef>
 #include <functional>
 
 namespace rtosc
 {
+struct Ports;
+
 /**
  * Known event types:
  * /undo_change /path/location old-data new-data
+ *
+ * The events are kept in a preallocated buffer of a fixed memory budget.
+ * If it is full, the oldest undo steps are dropped.
+ *
+ * Each event is one undo step, unless it is recorded inside a transaction.
+ * Optionally, checkpoints of all ports can be taken, so seeking far costs
+ * restoring a checkpoint plus the events since then, instead of all events.
  */
 class UndoHistory
 {
     //TODO think about the consequences of largish loads
     public:
         UndoHistory(void);
+        //Creates a history which keeps at most memory_budget bytes of events
+        explicit UndoHistory(std::size_t memory_budget);
         ~UndoHistory(void);
 
         //Records any undoable event
         void recordEvent(const char *msg);
 
+        //Groups all events until the matching endTransaction() into one undo
+        //step, e.g. for loading presets. Transactions can be nested
+        void beginTransaction(void);
+        void endTransaction(void);
+
         //Prints out a history
         void showHistory(void) const;
 
         //Seek to another point in history relative to the current one
         //Negative values mean undo, positive values mean redo
+        //The distance is counted in undo steps
         void seekHistory(int distance);
 
+        //Position and size are counted in events
         unsigned getPos(void) const;
+        //The returned message is valid until the next call
         const char *getHistory(int i) const;
         size_t size(void) const;
 
         void setCallback(std::function<void(const char*)> cb);
+
+        //Changes the memory budget, keeping as many recent events as possible
+        void setMemoryBudget(std::size_t bytes);
+        std::size_t getMemoryBudget(void) const;
+
+        //Sets the object which checkpoints are serialized from (using
+        //subtree_serialize()). Checkpoints larger than snapshot_size fail.
+        //Events passed to recordEvent() must not be applied to the object
+        //yet, like in rCAPPLY
+        void setCheckpointSource(void *object, Ports *ports,
+                                 std::size_t snapshot_size);
+        //Takes a checkpoint every interval events (0 disables this), keeping
+        //the newest max_checkpoints ones
+        void setCheckpointInterval(std::size_t interval,
+                                   std::size_t max_checkpoints = 8);
+        //Takes a checkpoint at the current position right now
+        bool checkpoint(void);
+        std::size_t numCheckpoints(void) const;
     private:
+        friend class UndoRecorder;
         class UndoHistoryImpl *impl;
 };
+
+/**
+ * RT-safe front end for recording undo events
+ *
+ * record() can be called from the realtime thread, e.g. from the reply of
+ * rCAPPLY: It only copies the event into a preallocated single producer
+ * single consumer ring, together with a monotonic timestamp. Another thread
+ * calls drain() to move the events into the history in batches. Merging
+ * happens there, based on the timestamps from recording.
+ *
+ * Drained events have already been applied, so automatic checkpoints of the
+ * history are taken after each drained batch. They are only correct if the
+ * realtime thread does not apply new events while drain() runs.
+ */
+class UndoRecorder
+{
+    public:
+        //Preallocates buffer_size bytes for events which are not drained yet
+        UndoRecorder(UndoHistory &history, std::size_t buffer_size);
+        ~UndoRecorder(void);
+
+        //Records an undoable event, RT-safe. Returns false if the event was
+        //lost because the buffer is full
+        bool record(const char *msg);
+
+        //Moves all recorded events into the history, not RT-safe
+        //Returns the number of events that were moved
+        std::size_t drain(void);
+
+        //Number of events which were lost because the buffer was full
+        std::size_t lost(void) const;
+    private:
+        class UndoRecorderImpl *impl;
+};
 };
 #endif
@@ -0,0 +1,166 @@
+/*
+ * Copyright (c) 2024 Johannes Lorenz
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a
+ * copy of this software and associated documentation files (the "Software"),
+ * to deal in the Software without restriction, including without limitation
+ * the rights to use, copy, modify, merge, publish, distribute, sublicense,
+ * and/or sell copies of the Software, and to permit persons to whom the
+ * Software is furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice (including the next
+ * paragraph) shall be included in all copies or substantial portions of the
+ * Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+ * EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+ * MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND
+ * NONINFRINGEMENT.  IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT
+ * HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY,
+ * WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+ * DEALINGS IN THE SOFTWARE.
+ */
+
+#include <assert.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <rtosc/arena.h>
+
+// alignment of all allocations, enough for all rtosc types
+#define ARENA_ALIGN 16
+
+struct rtosc_arena_block
+{
+    struct rtosc_arena_block* next;
+    size_t size; //!< usable size, excluding this header
+};
+
+// size of the block header, rounded up to the alignment
+static const size_t header_size =
+    (sizeof(struct rtosc_arena_block) + ARENA_ALIGN - 1) & ~(size_t)(ARENA_ALIGN - 1);
+
+static size_t align_up(size_t size)
+{
+    return (size + ARENA_ALIGN - 1) & ~(size_t)(ARENA_ALIGN - 1);
+}
+
+static char* block_data(struct rtosc_arena_block* block)
+{
+    return (char*)block + header_size;
+}
+
+static struct rtosc_arena_block* new_block(size_t size)
+{
+    struct rtosc_arena_block* block = malloc(header_size + size);
+    if(block)
+    {
+        block->next = NULL;
+        block->size = size;
+    }
+    return block;
+}
+
+void rtosc_arena_init(rtosc_arena_t* arena, size_t block_size)
+{
+    arena->first = arena->cur = NULL;
+    arena->used = 0;
+    arena->block_size = align_up(block_size ? block_size : 1);
+    arena->last_alloc = NULL;
+}
+
+void rtosc_arena_destroy(rtosc_arena_t* arena)
+{
+    struct rtosc_arena_block* next;
+    for(struct rtosc_arena_block* block = arena->first; block; block = next)
+    {
+        next = block->next;
+        free(block);
+    }
+    arena->first = arena->cur = NULL;
+    arena->used = 0;
+    arena->last_alloc = NULL;
+}
+
+void* rtosc_arena_alloc(rtosc_arena_t* arena, size_t size)
+{
+    size = align_up(size);
+
+    // find a block with enough space - after a reset, the blocks
+    // behind the current block are free
+    while(!arena->cur || arena->cur->size - arena->used < size)
+    {
+        struct rtosc_arena_block* next = arena->cur ? arena->cur->next
+                                                    : arena->first;
+        if(!next)
+        {
+            next = new_block(size > arena->block_size ? size
+                                                      : arena->block_size);
+            if(!next)
+                return NULL;
+            if(arena->cur)
+            {
+                next->next = arena->cur->next;
+                arena->cur->next = next;
+            }
+            else
+                arena->first = next;
+        }
+        arena->cur = next;
+        arena->used = 0;
+    }
+
+    void* res = block_data(arena->cur) + arena->used;
+    arena->used += size;
+    arena->last_alloc = res;
+    return res;
+}
+
+void* rtosc_arena_grow(rtosc_arena_t* arena, void* ptr,
+                       size_t old_size, size_t new_size)
+{
+    assert(new_size >= old_size);
+    if(ptr && ptr == arena->last_alloc)
+    {
+        // can we grow in place?
+        size_t offset = (char*)ptr - block_data(arena->cur);
+        if(arena->cur->size - offset >= align_up(new_size))
+        {
+            arena->used = offset + align_up(new_size);
+            return ptr;
+        }
+    }
+    void* res = rtosc_arena_alloc(arena, new_size);
+    if(res && old_size)
+        memcpy(res, ptr, old_size);
+    return res;
+}
+
+void rtosc_arena_reset(rtosc_arena_t* arena)
+{
+    if(arena->first && arena->first->next)
+    {
+        // merge all blocks into one, so the next round does not need to
+        // search through blocks (or allocate new ones)
+        size_t total = rtosc_arena_capacity(arena);
+        struct rtosc_arena_block* merged = new_block(total);
+        if(merged)
+        {
+            rtosc_arena_destroy(arena);
+            arena->first = merged;
+        }
+    }
+    arena->cur = arena->first;
+    arena->used = 0;
+    arena->last_alloc = NULL;
+}
+
+size_t rtosc_arena_capacity(const rtosc_arena_t* arena)
+{
+    size_t total = 0;
+    for(const struct rtosc_arena_block* block = arena->first; block;
+        block = block->next)
+        total += block->size;
+    return total;
+}
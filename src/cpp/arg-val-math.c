@@ -23,6 +23,8 @@
  */
 
 #include <assert.h>
+#include <rtosc/arg-ext.h>
+#include <rtosc/arg-val-cmp.h>
 #include <rtosc/arg-val-math.h>
 #include <rtosc/rtosc.h>
 
@@ -255,3 +257,140 @@ rtosc_arg_val_t* rtosc_arg_val_range_arg(const rtosc_arg_val_t *range_arg,
     if(ok) ok = rtosc_arg_val_add(range_arg+2, &mult, result);
     return ok ? result : NULL;
 }
+
+/*
+    bulk operations
+*/
+
+// note: the loops below are written such that compilers can vectorize them
+
+static void expand_int32(int32_t* out, int32_t from, size_t num,
+                         int32_t start, int32_t delta)
+{
+    // unsigned arithmetic wraps around like the signed ints of
+    // rtosc_arg_val_range_arg() usually do
+    uint32_t ustart = (uint32_t)start, udelta = (uint32_t)delta;
+    for(size_t k = 0; k < num; ++k)
+        out[k] = (int32_t)(ustart + (uint32_t)(from + (int32_t)k) * udelta);
+}
+
+static void expand_int64(int64_t* out, int32_t from, size_t num,
+                         int64_t start, int64_t delta)
+{
+    uint64_t ustart = (uint64_t)start, udelta = (uint64_t)delta;
+    for(size_t k = 0; k < num; ++k)
+        out[k] = (int64_t)(ustart +
+                           (uint64_t)(int64_t)(from + (int32_t)k) * udelta);
+}
+
+static void expand_float(float* out, int32_t from, size_t num,
+                         float start, float delta)
+{
+    // same operations as rtosc_arg_val_range_arg() (first convert the
+    // index, then multiply, then add), for bitwise identical results
+    for(size_t k = 0; k < num; ++k)
+        out[k] = start + (float)(from + (int32_t)k) * delta;
+}
+
+static void expand_double(double* out, int32_t from, size_t num,
+                          double start, double delta)
+{
+    for(size_t k = 0; k < num; ++k)
+        out[k] = start + (double)(from + (int32_t)k) * delta;
+}
+
+size_t rtosc_arg_val_range_expand(const rtosc_arg_val_t* range_arg,
+                                  int32_t from, size_t num, void* out)
+{
+    assert(range_arg->type == '-');
+    int has_delta = rtosc_av_rep_has_delta(range_arg);
+    const rtosc_arg_val_t* start = range_arg + 1 + !!has_delta;
+    const rtosc_arg_val_t* delta = has_delta ? (range_arg + 1) : NULL;
+    if(delta && delta->type != start->type)
+        return 0;
+
+    switch(start->type)
+    {
+        case 'c':
+        case 'i':
+            expand_int32((int32_t*)out, from, num,
+                         start->val.i, delta ? delta->val.i : 0);
+            return num;
+        case 'h':
+            expand_int64((int64_t*)out, from, num,
+                         start->val.h, delta ? delta->val.h : 0);
+            return num;
+        case 'f':
+            expand_float((float*)out, from, num,
+                         start->val.f, delta ? delta->val.f : 0.0f);
+            return num;
+        case 'd':
+            expand_double((double*)out, from, num,
+                          start->val.d, delta ? delta->val.d : 0.0);
+            return num;
+        default:
+            return 0;
+    }
+}
+
+size_t rtosc_arg_val_run_length(const rtosc_arg_val_t* av, size_t size,
+                                const rtosc_arg_val_t* delta)
+{
+    if(!size)
+        return 0;
+    const char type = av->type;
+    assert(type != 'a' && type != '-');
+    size_t k = 1;
+
+    // typed fast paths
+    if(!delta || delta->type == type)
+    switch(type)
+    {
+        case 'c':
+        case 'i':
+        {
+            uint32_t d = delta ? (uint32_t)delta->val.i : 0;
+            for(; k < size && av[k].type == type &&
+                  (uint32_t)av[k].val.i == (uint32_t)av[k-1].val.i + d; ++k) ;
+            return k;
+        }
+        case 'h':
+        {
+            uint64_t d = delta ? (uint64_t)delta->val.h : 0;
+            for(; k < size && av[k].type == type &&
+                  (uint64_t)av[k].val.h == (uint64_t)av[k-1].val.h + d; ++k) ;
+            return k;
+        }
+        case 'f':
+        {
+            if(delta)
+                break;
+            for(; k < size && av[k].type == type &&
+                  av[k].val.f == av[0].val.f; ++k) ;
+            return k;
+        }
+        case 'd':
+        {
+            if(delta)
+                break;
+            for(; k < size && av[k].type == type &&
+                  av[k].val.d == av[0].val.d; ++k) ;
+            return k;
+        }
+    }
+
+    // generic path
+    for(; k < size && av[k].type != 'a' && av[k].type != '-'; ++k)
+    {
+        if(delta)
+        {
+            rtosc_arg_val_t added;
+            if(!rtosc_arg_val_add(av + k - 1, delta, &added) ||
+               !rtosc_arg_vals_eq_single(&added, av + k, NULL))
+                break;
+        }
+        else if(!rtosc_arg_vals_eq_single(av, av + k, NULL))
+            break;
+    }
+    return k;
+}
@@ -1,12 +1,283 @@
 #include "util.h"
 #include <rtosc/automations.h>
+#include <rtosc/ports-runtime.h>
 #include <cstring>
 #include <cmath>
+#include <vector>
 
 using namespace rtosc;
 
+//Longest message of an automation: path, type tag and one argument
+#define AUTOMATION_MSG_SIZE (128 + 4 + 4)
+//Number of segments of the lookup tables of curves
+#define AUTOMATION_LUT_SIZE 128
+//Resolution of float parameters for smoothing, like 14 bit MIDI values
+#define AUTOMATION_FLOAT_STEPS 16384
+
+/*
+ * Precompiled automations ("kernels") for the batched evaluation. The mapping
+ * of each sub automation is stored as arrays, indexed by
+ * slot_id*per_slot+sub, so one slot's automations can be evaluated in one
+ * vectorizable loop. Each kernel also has its complete OSC message, so
+ * evaluating it only needs to patch the argument.
+ */
+struct rtosc::AutomationMgrImpl
+{
+    //message of one sub automation with the argument to be patched
+    struct message_t
+    {
+        char     data[AUTOMATION_MSG_SIZE];
+        uint32_t len;
+        uint32_t patch;  //!< offset of the argument, or of the 'T'/'F' type
+    };
+
+    //port and runtime object of an automation, for calling it directly
+    struct route_t
+    {
+        enum { unresolved, resolved, unresolvable };
+        const Port *port;
+        void       *obj;
+        uint32_t    leaf;  //!< offset of the port's part of the address
+        int         state;
+    };
+
+    AutomationMgrImpl(int nslots, int per_slot)
+        :offset(nslots*per_slot), slope(nslots*per_slot),
+         min(nslots*per_slot), max(nslots*per_slot), type(nslots*per_slot),
+         curve(nslots*per_slot),
+         lut(nslots*per_slot*(AUTOMATION_LUT_SIZE+1)),
+         result(per_slot), msgs(nslots*per_slot), routes(nslots*per_slot),
+         smooth(nslots*per_slot), smooth_coef(nslots*per_slot),
+         step(nslots*per_slot), current(nslots*per_slot, NAN),
+         sent(nslots*per_slot, NAN),
+         input(nslots*per_slot), dirty(nslots),
+         bundle(16 + nslots*per_slot*(4+AUTOMATION_MSG_SIZE) + 4)
+    {
+        rtosc_bundle(bundle.data(), 16, 1, 0);
+    }
+
+    //v = value*slope + offset, clamped to [min, max]
+    std::vector<float> offset, slope, min, max;
+    //'i', 'f', 'T' or 0 if unused, 'l' for logarithmic floats
+    std::vector<char> type;
+    //for curves, v = lut[value], with AUTOMATION_LUT_SIZE+1 entries each
+    std::vector<char>  curve;
+    std::vector<float> lut;
+    std::vector<float> result;
+    std::vector<message_t> msgs;
+    std::vector<route_t>   routes;
+
+    //smoothing type (see AutomationMapping) and its per block coefficient
+    std::vector<char>  smooth;
+    std::vector<float> smooth_coef;
+    //resolution of the parameter, smaller changes are not sent
+    std::vector<float> step;
+    //smoothed value and last value sent, NAN if unknown
+    std::vector<float> current, sent;
+
+    //slot value of each automation for the next block
+    std::vector<float> input;
+    //which automations of a slot need to be evaluated in the next block
+    enum { clean, all, smoothed };
+    std::vector<char>  dirty;
+    std::vector<char>  bundle;
+
+    //interpolated lookup of value 0..1 in the table of kernel k
+    float lookup(int k, float value) const
+    {
+        const float *tbl = lut.data() + k*(AUTOMATION_LUT_SIZE+1);
+        float pos = value*AUTOMATION_LUT_SIZE;
+        pos = pos < 0 ? 0 : pos > AUTOMATION_LUT_SIZE ? AUTOMATION_LUT_SIZE
+                                                      : pos;
+        int i = pos;
+        i = i < AUTOMATION_LUT_SIZE ? i : AUTOMATION_LUT_SIZE - 1;
+        return tbl[i] + (pos-i)*(tbl[i+1]-tbl[i]);
+    }
+
+    /*
+     * Move the smoothed value of kernel k one block towards v, and set v to
+     * it. Returns whether v changed enough to be sent. busy is set if v is
+     * not reached yet.
+     */
+    bool smoothStep(int k, float &v, bool &busy)
+    {
+        float &cur = current[k];
+        if(cur != cur) //nothing sent yet, so jump
+            cur = v;
+        else {
+            const float c = smooth_coef[k];
+            float d = v - cur;
+            if(smooth[k] == 1)
+                d *= c;
+            else
+                d = d > c ? c : d < -c ? -c : d;
+            cur += d;
+        }
+
+        const bool done = fabsf(v - cur) <= step[k]/2;
+        if(done)
+            cur = v;
+        else
+            busy = true;
+
+        const float last = sent[k];
+        const bool send = last != last ||
+            (done ? cur != last : fabsf(cur - last) >= step[k]);
+        if(send)
+            sent[k] = cur;
+        v = cur;
+        return send;
+    }
+
+    bool call(int k, const char *msg, const char *path, RtData &d) const;
+};
+
+bool AutomationMgr::resolveRoute(const char *path,
+                                 AutomationRoute &route) const
+{
+    route.port = NULL;
+    route.obj  = NULL;
+    route.leaf = 0;
+    fast_strcpy(route.path, path, sizeof(route.path));
+    if(!p)
+        return false;
+
+    //the port and runtime object are the ones which reply to a query
+    char query[AUTOMATION_MSG_SIZE];
+    char loc[AUTOMATION_MSG_SIZE];
+    if(!rtosc_message(query, sizeof(query), path, ""))
+        return false;
+    void *obj;
+    size_t leaf;
+    const Port *port = helpers::find_leaf_port(instance, *p, sizeof(loc), loc,
+                                               query, &obj, &leaf);
+    if(!port)
+        return false;
+
+    route.port = port;
+    route.obj  = obj;
+    route.leaf = leaf;
+    return true;
+}
+
+void AutomationMgr::setSlotSubRoute(int slot_id, int sub,
+                                    const AutomationRoute &route)
+{
+    if(slot_id >= nslots || slot_id < 0 || sub >= per_slot || sub < 0)
+        return;
+    const auto &au = slots[slot_id].automations[sub];
+    if(!au.used || strcmp(au.param_path, route.path))
+        return; //outdated
+    auto &r = impl->routes[slot_id*per_slot + sub];
+    r.port  = route.port;
+    r.obj   = route.obj;
+    r.leaf  = route.leaf;
+    r.state = route.port ? AutomationMgrImpl::route_t::resolved
+                         : AutomationMgrImpl::route_t::unresolvable;
+}
+
+void AutomationMgr::resolveRoutes(void)
+{
+    AutomationRoute route;
+    for(int k = 0; k < nslots*per_slot; ++k)
+    {
+        const auto &au = slots[k/per_slot].automations[k%per_slot];
+        if(!au.used ||
+           impl->routes[k].state != AutomationMgrImpl::route_t::unresolved)
+            continue;
+        resolveRoute(au.param_path, route);
+        setSlotSubRoute(k/per_slot, k%per_slot, route);
+    }
+}
+
+//call the port of kernel k with msg, like Ports::dispatch() would
+bool AutomationMgrImpl::call(int k, const char *msg, const char *path,
+                             RtData &d) const
+{
+    const route_t &route = routes[k];
+    if(route.state != route_t::resolved)
+        return false;
+    if(d.loc && d.loc_size)
+        fast_strcpy(d.loc, path, d.loc_size);
+    d.obj     = route.obj;
+    d.port    = route.port;
+    d.message = msg;
+    d.matches = 1;
+    route.port->cb(msg + route.leaf, d);
+    return true;
+}
+
+/*
+ * Curves are sampled into lookup tables from their control points, which are
+ * pairs of x (0..1, increasing) and y. Outside of the points, the curve is
+ * constant.
+ */
+
+//slope of the segment from point k to point k+1
+static float secant(const float *pts, int k)
+{
+    float h = pts[2*k+2] - pts[2*k];
+    return h > 0 ? (pts[2*k+3] - pts[2*k+1]) / h : 0;
+}
+
+//Tangent at point k of the smoothed curve. This keeps each segment
+//monotonic, so the curve never exceeds its control points.
+static float tangent(const float *pts, int n, int k)
+{
+    if(k == 0)
+        return secant(pts, 0);
+    if(k == n-1)
+        return secant(pts, n-2);
+    float d0 = secant(pts, k-1), d1 = secant(pts, k);
+    return d0*d1 > 0 ? 2*d0*d1/(d0+d1) : 0;
+}
+
+static void build_lut(const AutomationMapping &map, float *lut)
+{
+    const float *pts = map.control_points;
+    int n = map.upoints < map.npoints/2 ? map.upoints : map.npoints/2;
+    if(n < 1) {
+        memset(lut, 0, (AUTOMATION_LUT_SIZE+1)*sizeof(float));
+        return;
+    }
+
+    int seg = 0; //first point of the segment of x
+    for(int i=0; i<=AUTOMATION_LUT_SIZE; ++i) {
+        float x = i/(float)AUTOMATION_LUT_SIZE;
+        while(seg < n-1 && x >= pts[2*seg+2])
+            ++seg;
+        if(x <= pts[0] || seg == n-1) {
+            lut[i] = x <= pts[0] ? pts[1] : pts[2*n-1];
+            continue;
+        }
+
+        float x0 = pts[2*seg],   y0 = pts[2*seg+1];
+        float x1 = pts[2*seg+2], y1 = pts[2*seg+3];
+        float h  = x1-x0;
+        float t  = (x-x0)/h;
+        if(map.control_type == 1)
+            lut[i] = y0 + t*(y1-y0);
+        else { //cubic hermite
+            float m0 = tangent(pts, n, seg)*h, m1 = tangent(pts, n, seg+1)*h;
+            float t2 = t*t, t3 = t2*t;
+            lut[i] = (2*t3-3*t2+1)*y0 + (t3-2*t2+t)*m0
+                   + (-2*t3+3*t2)*y1 + (t3-t2)*m1;
+        }
+    }
+}
+
+static void emplace_uint32(char *dst, uint32_t d)
+{
+    dst[0] = (d>>24) & 0xff;
+    dst[1] = (d>>16) & 0xff;
+    dst[2] = (d>>8)  & 0xff;
+    dst[3] = (d>>0)  & 0xff;
+}
+
 AutomationMgr::AutomationMgr(int slots, int per_slot, int control_points)
-    :nslots(slots), per_slot(per_slot), active_slot(0), learn_queue_len(0), p(NULL), damaged(0)
+    :nslots(slots), per_slot(per_slot), active_slot(0), learn_queue_len(0),
+     impl(new AutomationMgrImpl(slots, per_slot)), p(NULL), instance(NULL),
+     rtdata(NULL), coalesce(false), damaged(0)
 {
     this->slots = new AutomationSlot[slots];
     memset(this->slots, 0, sizeof(AutomationSlot)*slots);
@@ -38,6 +309,7 @@ AutomationMgr::~AutomationMgr(void)
         delete[] s.automations;
     }
     delete[] this->slots;
+    delete impl;
 }
 
 void AutomationMgr::createBinding(int slot, const char *path, bool start_midi_learn)
@@ -96,6 +368,8 @@ void AutomationMgr::createBinding(int slot, const char *path, bool start_midi_le
         au.param_max = logf(au.param_max);
     } else
         au.map.control_scale = 0;
+    au.param_step = au.param_type == 'f'
+        ? (au.param_max-au.param_min)/AUTOMATION_FLOAT_STEPS : 1;
 
     au.map.gain   = 100.0;
     au.map.offset = 0;
@@ -121,11 +395,72 @@ void AutomationMgr::updateMapping(int slot_id, int sub)
     float center = (mn+mx)*(0.5 + au.map.offset/100.0);
     float range  = (mx-mn)*au.map.gain/100.0;
 
-    au.map.upoints = 2;
-    au.map.control_points[0] = 0;
-    au.map.control_points[1] = center-range/2.0;
-    au.map.control_points[2] = 1;
-    au.map.control_points[3] = center+range/2.0;
+    //curves keep their control points
+    if(au.map.control_type == 0) {
+        au.map.upoints = 2;
+        au.map.control_points[0] = 0;
+        au.map.control_points[1] = center-range/2.0;
+        au.map.control_points[2] = 1;
+        au.map.control_points[3] = center+range/2.0;
+    }
+    updateKernel(slot_id, sub);
+}
+
+void AutomationMgr::updateKernel(int slot_id, int sub)
+{
+    if(slot_id >= nslots || slot_id < 0 || sub >= per_slot || sub < 0)
+        return;
+    const auto &au = slots[slot_id].automations[sub];
+    const int k = slot_id*per_slot + sub;
+    auto &msg = impl->msgs[k];
+    char type = au.used ? au.param_type : 0;
+
+    //a new parameter starts without smoothing history and needs a new route
+    if(!type || strcmp(au.param_path, msg.data)) {
+        impl->current[k] = impl->sent[k] = NAN;
+        impl->routes[k].state = AutomationMgrImpl::route_t::unresolved;
+    }
+    const float blocks = au.map.smooth_time > 1 ? au.map.smooth_time : 1;
+    impl->smooth[k] = au.map.smooth_type;
+    impl->smooth_coef[k] = au.map.smooth_type == 1 ? 1-expf(-1/blocks)
+        : (au.param_max-au.param_min)/blocks;
+    impl->step[k] = au.param_step > 0 ? au.param_step : 1e-6f;
+
+    float a = au.map.control_points[1];
+    float b = au.map.control_points[3];
+    impl->offset[k] = a;
+    impl->slope[k]  = b-a;
+    impl->min[k]    = au.param_min;
+    impl->max[k]    = au.param_max;
+    impl->curve[k]  = au.map.control_type != 0;
+    if(impl->curve[k]) {
+        impl->offset[k] = impl->slope[k] = 0;
+        build_lut(au.map, impl->lut.data() + k*(AUTOMATION_LUT_SIZE+1));
+    }
+
+    if(type == 'i' || type == 'f') {
+        msg.len = (type == 'i')
+            ? rtosc_message(msg.data, sizeof(msg.data), au.param_path,
+                            "i", 0)
+            : rtosc_message(msg.data, sizeof(msg.data), au.param_path,
+                            "f", 0.0f);
+        msg.patch = msg.len - 4;
+        if(type == 'f' && au.map.control_scale == 1)
+            type = 'l';
+    } else if(type == 'T' || type == 'F') {
+        //the type tag is patched, T and F have no arguments
+        msg.len = rtosc_message(msg.data, sizeof(msg.data), au.param_path,
+                                "T");
+        msg.patch = msg.len - 3;
+        type = 'T';
+        //no clamping, see setSlotSub()
+        impl->min[k] = -INFINITY;
+        impl->max[k] = INFINITY;
+    } else
+        type = 0;
+    impl->type[k] = msg.len ? type : 0;
+    if(impl->type[k] != 'i' && impl->type[k] != 'f' && impl->type[k] != 'l')
+        impl->smooth[k] = 0;
 }
 
 void AutomationMgr::setSlot(int slot_id, float value)
@@ -145,6 +480,13 @@ void AutomationMgr::setSlotSub(int slot_id, int par, float value)
     auto &au = slots[slot_id].automations[par];
     if(au.used == false)
         return;
+    const int k = slot_id*per_slot + par;
+    if(impl->smooth[k]) { //done in processBlock()
+        impl->input[k] = value;
+        if(impl->dirty[slot_id] == AutomationMgrImpl::clean)
+            impl->dirty[slot_id] = AutomationMgrImpl::smoothed;
+        return;
+    }
     const char *path = au.param_path;
     float mn = au.param_min;
     float mx = au.param_max;
@@ -153,10 +495,10 @@ void AutomationMgr::setSlotSub(int slot_id, int par, float value)
     float b  = au.map.control_points[3];
 
     char type = au.param_type;
+    float v = au.map.control_type ? impl->lookup(k, value) : value*(b-a) + a;
 
     char msg[256] = {0};
     if(type == 'i') {
-        float v = value*(b-a) + a;
         if(v > mx)
             v = mx;
         else if(v < mn)
@@ -164,7 +506,6 @@ void AutomationMgr::setSlotSub(int slot_id, int par, float value)
 
         rtosc_message(msg, 256, path, "i", (int)roundf(v));
     } else if(type == 'f') {
-        float v = value*(b-a) + a;
         if(v > mx)
             v = mx;
         else if(v < mn)
@@ -175,7 +516,6 @@ void AutomationMgr::setSlotSub(int slot_id, int par, float value)
 
         rtosc_message(msg, 256, path, "f", v);
     } else if(type == 'T' || type == 'F') {
-        float v = value*(b-a) + a;
         if(v > 0.5)
             v = 1.0;
         else
@@ -185,10 +525,25 @@ void AutomationMgr::setSlotSub(int slot_id, int par, float value)
     } else
         return;
 
-    if(backend)
+    if(!callPort(k, msg) && backend)
         backend(msg);
 }
 
+bool AutomationMgr::callPort(int k, const char *msg)
+{
+    if(!rtdata)
+        return false;
+    const int slot_id = k/per_slot, sub = k%per_slot;
+    return impl->call(k, msg, slots[slot_id].automations[sub].param_path,
+                      *rtdata);
+}
+
+void AutomationMgr::invalidateRoutes(void)
+{
+    for(auto &route : impl->routes)
+        route.state = AutomationMgrImpl::route_t::unresolved;
+}
+
 float AutomationMgr::getSlot(int slot_id)
 {
     if(slot_id >= nslots || slot_id < 0)
@@ -236,6 +591,9 @@ void AutomationMgr::clearSlotSub(int slot_id, int sub)
     a.param_step = 0;
     a.map.gain   = 100;
     a.map.offset = 0;
+    a.map.control_type = 0;
+    a.map.smooth_type  = 0;
+    updateKernel(slot_id, sub);
 
     damaged = true;
 }
@@ -289,6 +647,8 @@ void AutomationMgr::setSlotSubPath(int slot, int ind, const char *path)
         au.param_max = logf(au.param_max);
     } else
         au.map.control_scale = 0;
+    au.param_step = au.param_type == 'f'
+        ? (au.param_max-au.param_min)/AUTOMATION_FLOAT_STEPS : 1;
 
     updateMapping(slot, ind);
     damaged = true;
@@ -351,37 +711,60 @@ bool AutomationMgr::handleMidi(int channel, int type, int val)
             is_nrpn = true;
             par_id = (parhi<<7) + parlo;
             value = (valhi<<7) + vallo;
-            bool bound_nrpn = false;
-            for(int i=0; i<nslots; ++i) {
-                if(slots[i].midi_nrpn == par_id) {
-                    bound_nrpn = true;
-                    setSlot(i, value/16383.0);
-                }
-            }
-
-        if(bound_nrpn)
-            return 1;
+            if(setBound(par_id, true, value/16383.0))
+                return 1;
         }
         
     }
     else {
         
         par_id = channel*128 + type;
-
-        bool bound_cc = false;
-        for(int i=0; i<nslots; ++i) {
-            if(slots[i].midi_cc == par_id) {
-                bound_cc = true;
-                setSlot(i, val/127.0);
-            }
-        }
-
-        if(bound_cc)
+        if(setBound(par_id, false, val/127.0))
             return 1;
-        
     }
 
     //No bound CC, now to see if there's something to learn
+    learnMidi(par_id, is_nrpn, is_nrpn ? value/16383.0 : val/127.0);
+    return 0;
+}
+
+bool AutomationMgr::handleMidi14(int channel, int par, int val, bool nrpn)
+{
+    const int par_id = nrpn ? par : channel*128 + par;
+    const float value = (val & 0x3fff)/16383.0;
+    if(setBound(par_id, nrpn, value))
+        return 1;
+    learnMidi(par_id, nrpn, value);
+    return 0;
+}
+
+bool AutomationMgr::handleMidi32(int channel, int par, uint32_t val, bool nrpn)
+{
+    const int par_id = nrpn ? par : channel*128 + par;
+    const float value = val/4294967295.0;
+    if(setBound(par_id, nrpn, value))
+        return 1;
+    learnMidi(par_id, nrpn, value);
+    return 0;
+}
+
+bool AutomationMgr::setBound(int par_id, bool is_nrpn, float value)
+{
+    bool bound = false;
+    for(int i=0; i<nslots; ++i) {
+        if((is_nrpn ? slots[i].midi_nrpn : slots[i].midi_cc) == par_id) {
+            bound = true;
+            if(coalesce)
+                setSlotDeferred(i, value);
+            else
+                setSlot(i, value);
+        }
+    }
+    return bound;
+}
+
+void AutomationMgr::learnMidi(int par_id, bool is_nrpn, float value)
+{
     for(int i=0; i<nslots; ++i) {
         if(slots[i].learning == 1) {
             slots[i].learning = -1;
@@ -393,12 +776,11 @@ bool AutomationMgr::handleMidi(int channel, int type, int val)
                 if(slots[j].learning > 1)
                     slots[j].learning -= 1;
             learn_queue_len--;
-            setSlot(i, val/127.0);
+            setSlot(i, value);
             damaged = 1;
             break;
         }
     }
-    return 0;
 }
 
 //Returns 0 if there is NRPN or 1 if there is not
@@ -441,6 +823,8 @@ void AutomationMgr::setparameternumber(unsigned int type, int value)
 
 void AutomationMgr::set_ports(const struct Ports &p_) {
     p = &p_;
+    invalidateRoutes();
+    resolveRoutes();
 };
 //
 //        AutomationSlot *slots;
@@ -449,6 +833,13 @@ void AutomationMgr::set_ports(const struct Ports &p_) {
 void AutomationMgr::set_instance(void *v)
 {
     this->instance = v;
+    invalidateRoutes();
+    resolveRoutes();
+}
+
+void AutomationMgr::set_rtdata(RtData *d)
+{
+    rtdata = d;
 }
 
 void AutomationMgr::simpleSlope(int slot_id, int par, float slope, float offset)
@@ -456,12 +847,118 @@ void AutomationMgr::simpleSlope(int slot_id, int par, float slope, float offset)
     if(slot_id >= nslots || slot_id < 0 || par >= per_slot || par < 0)
         return;
     auto &map = slots[slot_id].automations[par].map;
+    map.control_type = 0;
     map.upoints = 2;
     map.control_points[0] = 0;
     map.control_points[1] = -(slope/2)+offset;
     map.control_points[2] =  1;
     map.control_points[3] =  slope/2+offset;
+    updateKernel(slot_id, par);
+}
+
+void AutomationMgr::setCurve(int slot_id, int sub, int control_type,
+                             const float *points, int n)
+{
+    if(slot_id >= nslots || slot_id < 0 || sub >= per_slot || sub < 0)
+        return;
+    auto &map = slots[slot_id].automations[sub].map;
+    if(n > map.npoints/2)
+        n = map.npoints/2;
+    map.control_type = control_type;
+    map.upoints = n;
+    memcpy(map.control_points, points, 2*n*sizeof(float));
+    updateMapping(slot_id, sub);
+}
+
+void AutomationMgr::setSlotSubSmoothing(int slot_id, int sub, int type,
+                                        float blocks)
+{
+    if(slot_id >= nslots || slot_id < 0 || sub >= per_slot || sub < 0)
+        return;
+    auto &map = slots[slot_id].automations[sub].map;
+    map.smooth_type = type;
+    map.smooth_time = blocks;
+    updateKernel(slot_id, sub);
+}
+
+void AutomationMgr::setSlotDeferred(int slot_id, float value)
+{
+    if(slot_id >= nslots || slot_id < 0)
+        return;
+    for(int i=0; i<per_slot; ++i)
+        impl->input[slot_id*per_slot + i] = value;
+    impl->dirty[slot_id] = AutomationMgrImpl::all;
+    slots[slot_id].current_state = value;
+}
+
+void AutomationMgr::processBlock(void)
+{
+    char *bundle = impl->bundle.data();
+    size_t len = 16;
+    int nmsgs = 0;
+
+    for(int i=0; i<nslots; ++i) {
+        const char mode = impl->dirty[i];
+        if(mode == AutomationMgrImpl::clean)
+            continue;
+        impl->dirty[i] = AutomationMgrImpl::clean;
+        const int k0 = i*per_slot;
+        bool busy = false;
+
+        //map all automations of the slot at once
+        const float *value  = impl->input.data() + k0;
+        const float *offset = impl->offset.data() + k0;
+        const float *slope  = impl->slope.data() + k0;
+        const float *mn     = impl->min.data() + k0;
+        const float *mx     = impl->max.data() + k0;
+        float *res          = impl->result.data();
+        for(int j=0; j<per_slot; ++j)
+            res[j] = value[j]*slope[j] + offset[j];
+        for(int j=0; j<per_slot; ++j)
+            if(impl->curve[k0+j])
+                res[j] = impl->lookup(k0+j, value[j]);
+        for(int j=0; j<per_slot; ++j) {
+            float v = res[j] > mx[j] ? mx[j] : res[j];
+            res[j] = v < mn[j] ? mn[j] : v;
+        }
+
+        for(int j=0; j<per_slot; ++j) {
+            const char type = impl->type[k0+j];
+            if(!type)
+                continue;
+            if(impl->smooth[k0+j]) {
+                if(!impl->smoothStep(k0+j, res[j], busy))
+                    continue;
+            } else if(mode != AutomationMgrImpl::all)
+                continue;
+            const auto &msg = impl->msgs[k0+j];
+            char *dst = bundle + len + 4;
+            emplace_uint32(bundle + len, msg.len);
+            memcpy(dst, msg.data, msg.len);
+            if(type == 'T') {
+                dst[msg.patch] = res[j] > 0.5 ? 'T' : 'F';
+            } else {
+                rtosc_arg_t arg;
+                if(type == 'i')
+                    arg.i = (int)roundf(res[j]);
+                else
+                    arg.f = type == 'l' ? expf(res[j]) : res[j];
+                emplace_uint32(dst + msg.patch, (uint32_t)arg.i);
+            }
+            if(callPort(k0+j, dst)) //already sent
+                continue;
+            len += 4 + msg.len;
+            ++nmsgs;
+        }
+        //smoothing continues in the next block
+        if(busy)
+            impl->dirty[i] = AutomationMgrImpl::smoothed;
+    }
 
+    //terminate, the bundle may be read without its length
+    emplace_uint32(bundle + len, 0);
+    if(nmsgs && backend)
+        backend(bundle);
 }
 
 int AutomationMgr::free_slot(void) const
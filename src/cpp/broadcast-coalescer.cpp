@@ -0,0 +1,227 @@
+#include <rtosc/broadcast-coalescer.h>
+#include <rtosc/thread-link.h>
+#include <rtosc/rtosc.h>
+#include <cstring>
+
+using namespace rtosc;
+
+//bundle header: "#bundle\0" and the time tag "immediately"
+static const char bundle_header[16] = {'#', 'b', 'u', 'n', 'd', 'l', 'e', 0,
+                                       0, 0, 0, 0, 0, 0, 0, 1};
+
+static uint64_t fnv1a(uint64_t h, const char *str, size_t len)
+{
+    for(size_t i = 0; i < len; ++i)
+        h = (h ^ (unsigned char)str[i]) * 1099511628211ull;
+    return h;
+}
+
+static uint64_t fnv1a(const char *str, size_t len)
+{
+    return fnv1a(14695981039346656037ull, str, len);
+}
+
+//! Hash of the path and the argument types
+static uint64_t key_hash(const char *msg)
+{
+    const char *types = rtosc_argument_string(msg);
+    return fnv1a(fnv1a(msg, strlen(msg) + 1), types, strlen(types));
+}
+
+static size_t power_of_two(size_t min)
+{
+    size_t res = 1;
+    while(res < min)
+        res *= 2;
+    return res;
+}
+
+BroadcastCoalescer::BroadcastCoalescer(ThreadLink &link, size_t max_paths,
+                                       size_t buffer_size,
+                                       size_t bundle_size,
+                                       size_t max_tracked)
+    : changes_only(false), link(link), entries(), table(),
+      data(buffer_size), data_used(0), bundle(bundle_size),
+      tracked(power_of_two(2 * max_tracked)), tracked_used(0)
+{
+    entries.reserve(max_paths);
+    pending.reserve(max_paths);
+    table.resize(power_of_two(2 * max_paths));
+    reset_stats();
+}
+
+void BroadcastCoalescer::reset_stats(void)
+{
+    m_received = m_forwarded = m_dropped = m_bundles = m_overflows = 0;
+}
+
+bool BroadcastCoalescer::insert(const char *msg, size_t length,
+                                uint32_t hash)
+{
+    const size_t mask = table.size() - 1;
+    for(size_t i = hash & mask;; i = (i + 1) & mask)
+    {
+        slot_t &slot = table[i];
+        if(!slot.entry)
+        {
+            if(entries.size() == entries.capacity() ||
+               data_used + length > data.size())
+                return false;
+            memcpy(data.data() + data_used, msg, length);
+            entries.push_back({(uint32_t)data_used, (uint32_t)length,
+                               (uint32_t)i});
+            slot.hash = hash;
+            slot.entry = entries.size();
+            data_used += length;
+            return true;
+        }
+
+        entry_t &e = entries[slot.entry - 1];
+        char *old = data.data() + e.offset;
+        if(slot.hash != hash || strcmp(old, msg) ||
+           strcmp(rtosc_argument_string(old), rtosc_argument_string(msg)))
+            continue;
+
+        //same key: replace the message
+        if(length > e.length)
+        {
+            if(data_used + length > data.size())
+                return false;
+            e.offset = data_used;
+            old = data.data() + data_used;
+            data_used += length;
+        }
+        memcpy(old, msg, length);
+        e.length = length;
+        return true;
+    }
+}
+
+bool BroadcastCoalescer::unchanged(const char *msg, size_t length,
+                                   pending_t &p)
+{
+    uint64_t key = key_hash(msg);
+    key += !key; //0 marks free slots
+    p.content = fnv1a(msg, length);
+    p.content += !p.content; //0 marks keys which were never forwarded
+    p.slot = tracked.size();
+    const size_t mask = tracked.size() - 1;
+    for(size_t i = key & mask;; i = (i + 1) & mask)
+    {
+        tracked_t &t = tracked[i];
+        if(t.key == key)
+        {
+            p.slot = i;
+            return t.content == p.content;
+        }
+        if(!t.key)
+        {
+            //if the table is full, the key is not tracked
+            if(tracked_used < tracked.size() / 2)
+            {
+                t.key = key;
+                t.content = 0;
+                ++tracked_used;
+                p.slot = i;
+            }
+            return false;
+        }
+    }
+}
+
+bool BroadcastCoalescer::forward(const char *msg, const pending_t &p)
+{
+    if(!link.raw_write(msg))
+    {
+        ++m_dropped;
+        return false;
+    }
+    //only messages which arrived are remembered for changes_only
+    if(p.slot < tracked.size())
+        tracked[p.slot].content = p.content;
+    ++m_forwarded;
+    return true;
+}
+
+void BroadcastCoalescer::broadcast(const char *msg)
+{
+    ++m_received;
+    size_t length = rtosc_message_length(msg, -1);
+    uint64_t hash = key_hash(msg);
+    if(insert(msg, length, hash ^ (hash >> 32)))
+        return;
+
+    ++m_overflows;
+    flush();
+    if(insert(msg, length, hash ^ (hash >> 32)))
+        return;
+
+    //larger than the whole buffer
+    pending_t p = {(uint32_t)tracked.size(), 0};
+    if(!changes_only || !unchanged(msg, length, p))
+        forward(msg, p);
+}
+
+void BroadcastCoalescer::write_bundle(size_t used)
+{
+    if(pending.empty())
+        return;
+    if(pending.size() == 1) //no bundle needed
+        forward(bundle.data() + sizeof(bundle_header) + 4, pending[0]);
+    else
+    {
+        memset(bundle.data() + used, 0, 4);
+        if(link.raw_write(bundle.data()))
+        {
+            for(const pending_t &p : pending)
+                if(p.slot < tracked.size())
+                    tracked[p.slot].content = p.content;
+            m_forwarded += pending.size();
+            ++m_bundles;
+        }
+        else
+            m_dropped += pending.size();
+    }
+    pending.clear();
+}
+
+void BroadcastCoalescer::flush(void)
+{
+    char *buf = bundle.data();
+    memcpy(buf, bundle_header, sizeof(bundle_header));
+    size_t used = sizeof(bundle_header);
+
+    for(const entry_t &e : entries)
+    {
+        const char *msg = data.data() + e.offset;
+        pending_t p = {(uint32_t)tracked.size(), 0};
+        if(changes_only && unchanged(msg, e.length, p))
+            continue;
+
+        //element plus the zero length at the end of the bundle
+        if(used + e.length + 8 > bundle.size())
+        {
+            write_bundle(used);
+            used = sizeof(bundle_header);
+        }
+        if(used + e.length + 8 > bundle.size())
+        {
+            //too large for any bundle
+            forward(msg, p);
+            continue;
+        }
+        buf[used++] = e.length >> 24;
+        buf[used++] = e.length >> 16;
+        buf[used++] = e.length >> 8;
+        buf[used++] = e.length;
+        memcpy(buf + used, msg, e.length);
+        used += e.length;
+        pending.push_back(p);
+    }
+    write_bundle(used);
+
+    for(const entry_t &e : entries)
+        table[e.slot].entry = 0;
+    entries.clear();
+    data_used = 0;
+}
@@ -120,42 +120,64 @@ const char* get_default_value(const char* port_name, const Ports& ports,
     return return_value;
 }
 
-int get_default_value(const char* port_name, const char* port_args,
-                      const Ports& ports, void* runtime, const Port* port_hint, std::size_t n, rtosc_arg_val_t* res,
-                      char* strbuf, size_t strbufsize)
+//! scan the pretty-printed default value @p pretty and canonicalize it
+static int scan_default_value(const char* pretty,
+                              const char* port_name, const char* port_args,
+                              const Port* port_hint, std::size_t n,
+                              rtosc_arg_val_t* res,
+                              char* strbuf, size_t strbufsize,
+                              rtosc_arena_t* arena)
 {
-    const char* pretty = get_default_value(port_name, ports, runtime, port_hint,
-                                           0);
-
-    int nargs;
-    if(pretty)
-    {
-        nargs = rtosc_count_printed_arg_vals(pretty);
+    int nargs = rtosc_count_printed_arg_vals(pretty);
 #ifdef NDEBUG
-        (void)n;
+    (void)n;
 #else
-        assert(nargs > 0); // parse error => error in the metadata?
-        assert((size_t)nargs < n);
+    assert(nargs > 0); // parse error => error in the metadata?
+    assert((size_t)nargs < n);
 #endif
 
+    if(arena)
+        rtosc_scan_arg_vals_arena(pretty, res, nargs, arena);
+    else
         rtosc_scan_arg_vals(pretty, res, nargs, strbuf, strbufsize);
 
-        {
-            // TODO: port_hint could be NULL here!
-            int errs_found = canonicalize_arg_vals(res,
-                                                   nargs,
-                                                   port_args,
-                                                   port_hint->meta());
-            if(errs_found)
-                fprintf(stderr, "Could not canonicalize %s for port %s\n",
-                        pretty, port_name);
-            assert(!errs_found); // error in the metadata?
-        }
+    {
+        // TODO: port_hint could be NULL here!
+        int errs_found = canonicalize_arg_vals(res,
+                                               nargs,
+                                               port_args,
+                                               port_hint->meta());
+        if(errs_found)
+            fprintf(stderr, "Could not canonicalize %s for port %s\n",
+                    pretty, port_name);
+        assert(!errs_found); // error in the metadata?
     }
-    else
-        nargs = -1;
 
     return nargs;
 }
 
+int get_default_value(const char* port_name, const char* port_args,
+                      const Ports& ports, void* runtime, const Port* port_hint, std::size_t n, rtosc_arg_val_t* res,
+                      char* strbuf, size_t strbufsize)
+{
+    const char* pretty = get_default_value(port_name, ports, runtime, port_hint,
+                                           0);
+    return pretty ? scan_default_value(pretty, port_name, port_args,
+                                       port_hint, n, res,
+                                       strbuf, strbufsize, nullptr)
+                  : -1;
+}
+
+int get_default_value(const char* port_name, const char* port_args,
+                      const Ports& ports, void* runtime, const Port* port_hint, std::size_t n, rtosc_arg_val_t* res,
+                      rtosc_arena_t* arena)
+{
+    const char* pretty = get_default_value(port_name, ports, runtime, port_hint,
+                                           0);
+    return pretty ? scan_default_value(pretty, port_name, port_args,
+                                       port_hint, n, res,
+                                       nullptr, 0, arena)
+                  : -1;
+}
+
 }
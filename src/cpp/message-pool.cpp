@@ -0,0 +1,180 @@
+#include <rtosc/message-pool.h>
+#include <rtosc/rtosc.h>
+#include <algorithm>
+#include <stdexcept>
+
+using namespace rtosc;
+
+static const uint64_t index_mask = 0xffffffffu;
+
+//constructed at load time, so the realtime thread never has to create it
+static MessagePool default_instance;
+
+MessagePool &MessagePool::default_pool(void)
+{
+    return default_instance;
+}
+
+MessagePool::buffer &MessagePool::buffer::operator=(buffer &&other)
+{
+    if(this != &other) {
+        release();
+        pool = other.pool;
+        m_data = other.m_data;
+        m_size = other.m_size;
+        other.m_data = nullptr;
+    }
+    return *this;
+}
+
+void MessagePool::buffer::release(void)
+{
+    if(m_data)
+        pool->release(m_data);
+    m_data = nullptr;
+}
+
+MessagePool::MessagePool(void)
+    : MessagePool({{256, 64}, {1024, 32}, {8192, 16}, {65536, 4}})
+{
+}
+
+MessagePool::MessagePool(const std::vector<size_class> &classes_)
+    : classes(new class_t[classes_.size()]), num_classes(classes_.size()),
+      m_in_use(0)
+{
+    std::vector<size_class> sorted = classes_;
+    std::sort(sorted.begin(), sorted.end(),
+              [](const size_class &a, const size_class &b) {
+                  return a.size < b.size; });
+
+    size_t total = 0;
+    for(size_class &s : sorted) {
+        if(!s.size || s.count >= index_mask)
+            throw std::invalid_argument("invalid size class");
+        s.size = (s.size + 3) & ~(size_t)3; //keep messages 4 byte aligned
+        total += s.size * s.count;
+    }
+    memory.resize(total);
+
+    char *pos = memory.data();
+    for(size_t i = 0; i < num_classes; ++i)
+    {
+        class_t &c = classes[i];
+        c.size = sorted[i].size;
+        c.count = sorted[i].count;
+        c.memory = pos;
+        pos += c.size * c.count;
+        c.next.reset(new std::atomic<uint32_t>[c.count]);
+        for(size_t b = 0; b < c.count; ++b)
+            c.next[b] = b + 1 < c.count ? b + 2 : 0;
+        c.head = c.count ? 1 : 0;
+    }
+    reset_stats();
+}
+
+MessagePool::~MessagePool(void)
+{
+}
+
+void MessagePool::reset_stats(void)
+{
+    m_acquired = m_spilled = m_failed = 0;
+    m_high_water = m_in_use.load();
+}
+
+size_t MessagePool::max_size(void) const
+{
+    return num_classes ? classes[num_classes - 1].size : 0;
+}
+
+char *MessagePool::pop(class_t &c)
+{
+    uint64_t head = c.head.load(std::memory_order_acquire);
+    for(;;)
+    {
+        uint32_t first = head & index_mask;
+        if(!first)
+            return nullptr;
+        uint64_t next = ((head >> 32) + 1) << 32 |
+                        c.next[first - 1].load(std::memory_order_relaxed);
+        if(c.head.compare_exchange_weak(head, next,
+                                        std::memory_order_acq_rel,
+                                        std::memory_order_acquire))
+            return c.memory + (first - 1) * c.size;
+    }
+}
+
+void MessagePool::push(class_t &c, uint32_t index)
+{
+    uint64_t head = c.head.load(std::memory_order_relaxed);
+    uint64_t next;
+    do {
+        c.next[index].store(head & index_mask, std::memory_order_relaxed);
+        next = ((head >> 32) + 1) << 32 | (index + 1);
+    } while(!c.head.compare_exchange_weak(head, next,
+                                          std::memory_order_release,
+                                          std::memory_order_relaxed));
+}
+
+MessagePool::buffer MessagePool::acquire(size_t size)
+{
+    for(size_t index = 0; index < num_classes; ++index)
+    {
+        class_t &c = classes[index];
+        if(c.size < size)
+            continue;
+        char *data = pop(c);
+        if(!data) //exhausted, try a larger class
+            continue;
+
+        ++m_acquired;
+        if(index && classes[index - 1].size >= size)
+            ++m_spilled;
+        size_t used = ++m_in_use;
+        size_t high = m_high_water.load(std::memory_order_relaxed);
+        while(used > high &&
+              !m_high_water.compare_exchange_weak(high, used,
+                                                  std::memory_order_relaxed))
+            ;
+        return buffer(this, data, c.size);
+    }
+    ++m_failed;
+    return buffer();
+}
+
+void MessagePool::release(char *data)
+{
+    for(size_t i = 0; i < num_classes; ++i)
+    {
+        class_t &c = classes[i];
+        if(data >= c.memory && data < c.memory + c.size * c.count) {
+            push(c, (data - c.memory) / c.size);
+            --m_in_use;
+            return;
+        }
+    }
+}
+
+MessagePool::buffer MessagePool::vmessage(const char *path, const char *args,
+                                          va_list va)
+{
+    va_list va_len;
+    va_copy(va_len, va);
+    size_t len = rtosc_vmessage(nullptr, 0, path, args, va_len);
+    va_end(va_len);
+    buffer res = acquire(len);
+    if(res)
+        rtosc_vmessage(res.data(), res.size(), path, args, va);
+    return res;
+}
+
+MessagePool::buffer MessagePool::message(const char *path, const char *args,
+                                         ...)
+{
+    va_list va;
+    va_start(va, args);
+    buffer res = vmessage(path, args, va);
+    va_end(va);
+    return res;
+}
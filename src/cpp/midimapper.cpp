@@ -47,55 +47,168 @@ int getInd(const T&t,const U&u){
  * Storage *
  ***********/
 
-bool MidiMapperStorage::handleCC(int ID, int val, write_cb write)
+//Channel and CC bits of a MIDI ID, if it is a CC
+static bool cc_index(int ID, int *index)
 {
+    //ID = (nrpn<<18) + (channel<<14) + parameter
+    if(ID < 0 || (ID & ~0x3c07f))
+        return false;
+    *index = ((ID>>14)<<7) | (ID & 0x7f);
+    return true;
+}
+
+static unsigned id_hash(int ID)
+{
+    return (unsigned)ID * 2654435761u;
+}
+
+void MidiMapperStorage::buildLookup(void)
+{
+    cc_lookup = TinyVector<int>(16*128);
+    for(int i=0; i<cc_lookup.size(); ++i)
+        cc_lookup[i] = -1;
+
+    int others = 0, index;
     for(int i=0; i<mapping.size(); ++i)
-    {
-        if(std::get<0>(mapping[i]) == ID)
-        {
-            bool coarse = std::get<1>(mapping[i]);
-            int  ind    = std::get<2>(mapping[i]);
-            if(coarse)
-                values[ind] = (val<<7)|(values[ind]&0x7f);
-            else
-                values[ind] = val|(values[ind]&0x3f80);
-            callbacks[ind](values[ind],write);
-            return true;
+        if(!cc_index(std::get<0>(mapping[i]), &index))
+            ++others;
+    int buckets = 0;
+    if(others) {
+        buckets = 1;
+        while(buckets < 2*others)
+            buckets *= 2;
+    }
+    id_lookup = TinyVector<std::pair<int,int>>(buckets);
+    for(int i=0; i<buckets; ++i)
+        id_lookup[i] = std::make_pair(-1, -1);
+
+    //the first mapping of an ID wins, like in a linear search
+    for(int i=0; i<mapping.size(); ++i) {
+        int ID = std::get<0>(mapping[i]);
+        if(cc_index(ID, &index)) {
+            if(cc_lookup[index] == -1)
+                cc_lookup[index] = i;
+            continue;
         }
+        unsigned h = id_hash(ID) & (buckets-1);
+        while(id_lookup[h].first != -1 && id_lookup[h].first != ID)
+            h = (h+1) & (buckets-1);
+        if(id_lookup[h].first == -1)
+            id_lookup[h] = std::make_pair(ID, i);
+    }
+
+    changed = TinyVector<int>(values.size());
+    queued  = TinyVector<char>(values.size());
+    for(int i=0; i<queued.size(); ++i)
+        queued[i] = 0;
+    nchanged = 0;
+}
+
+int MidiMapperStorage::findMapping(int ID) const
+{
+    if(!cc_lookup.size()) {
+        for(int i=0; i<mapping.size(); ++i)
+            if(std::get<0>(mapping[i]) == ID)
+                return i;
+        return -1;
+    }
+
+    int index;
+    if(cc_index(ID, &index))
+        return cc_lookup[index];
+    const int buckets = id_lookup.size();
+    if(!buckets)
+        return -1;
+    for(unsigned h = id_hash(ID) & (buckets-1);; h = (h+1) & (buckets-1)) {
+        const std::pair<int,int> e = id_lookup[h];
+        if(e.first == ID || e.first == -1)
+            return e.second;
     }
-    return false;
 }
 
-//TODO try to change O(n^2) algorithm to O(n)
+//Call the callback of a changed value, or defer it to flush()
+static void changed_value(MidiMapperStorage &s, int ind,
+                          MidiMapperStorage::write_cb write, bool defer)
+{
+    if(!defer || ind >= s.queued.size()) {
+        s.callbacks[ind](s.values[ind],write);
+        return;
+    }
+    if(!s.queued[ind]) {
+        s.queued[ind] = 1;
+        s.changed[s.nchanged++] = ind;
+    }
+}
+
+bool MidiMapperStorage::handleCC(int ID, int val, write_cb write, bool defer)
+{
+    const int i = findMapping(ID);
+    if(i < 0)
+        return false;
+
+    bool coarse = std::get<1>(mapping[i]);
+    int  ind    = std::get<2>(mapping[i]);
+    if(coarse)
+        values[ind] = (val<<7)|(values[ind]&0x7f);
+    else
+        values[ind] = val|(values[ind]&0x3f80);
+    changed_value(*this, ind, write, defer);
+    return true;
+}
+
+bool MidiMapperStorage::handleValue(int ID, int val, write_cb write,
+                                    bool defer)
+{
+    const int i = findMapping(ID);
+    if(i < 0)
+        return false;
+
+    int ind = std::get<2>(mapping[i]);
+    values[ind] = val & 0x3fff;
+    changed_value(*this, ind, write, defer);
+    return true;
+}
+
+void MidiMapperStorage::flush(write_cb write)
+{
+    for(int i=0; i<nchanged; ++i) {
+        const int ind = changed[i];
+        queued[ind] = 0;
+        callbacks[ind](values[ind],write);
+    }
+    nchanged = 0;
+}
+
 void MidiMapperStorage::cloneValues(const MidiMapperStorage &storage)
 {
     //XXX this method is SUPER error prone
     for(int i=0; i<values.size(); ++i)
         values[i] = 0;
 
+    //Linear time if storage has its lookup tables (see buildLookup()),
+    //which is true for all storages passed to the realtime side
     for(int i=0; i<mapping.size(); ++i) {
-        for(int j=0; j<storage.mapping.size(); ++j) {
-            if(std::get<0>(mapping[i]) == std::get<0>(storage.mapping[j])) {
-                bool coarse_src = std::get<1>(storage.mapping[j]);
-                int ind_src     = std::get<2>(storage.mapping[j]);
-
-                bool coarse_dest = std::get<1>(mapping[i]);
-                int ind_dest     = std::get<2>(mapping[i]);
-
-                int val = 0;
-                //Extract
-                if(coarse_src)
-                    val = storage.values[ind_src]>>7;
-                else
-                    val = storage.values[ind_src]&0x7f;
-
-                //Blit
-                if(coarse_dest)
-                    values[ind_dest] = (val<<7)|(values[ind_dest]&0x7f);
-                else
-                    values[ind_dest] = val|(values[ind_dest]&0x3f80);
-            }
-        }
+        int j = storage.findMapping(std::get<0>(mapping[i]));
+        if(j < 0)
+            continue;
+        bool coarse_src = std::get<1>(storage.mapping[j]);
+        int ind_src     = std::get<2>(storage.mapping[j]);
+
+        bool coarse_dest = std::get<1>(mapping[i]);
+        int ind_dest     = std::get<2>(mapping[i]);
+
+        int val = 0;
+        //Extract
+        if(coarse_src)
+            val = storage.values[ind_src]>>7;
+        else
+            val = storage.values[ind_src]&0x7f;
+
+        //Blit
+        if(coarse_dest)
+            values[ind_dest] = (val<<7)|(values[ind_dest]&0x7f);
+        else
+            values[ind_dest] = val|(values[ind_dest]&0x3f80);
     }
 }
 
@@ -229,6 +342,7 @@ void MidiMappernRT::addNewMapper(int ID, const Port &port, std::string addr)
     storage = nstorage;
     inv_map[addr] = std::make_tuple(storage->callbacks.size()-1, ID,-1,bi);
 
+    storage->buildLookup();
     char buf[1024];
     rtosc_message(buf, 1024, "/midi-learn/midi-bind", "b", sizeof(storage), &storage);
     rt_cb(buf);
@@ -298,6 +412,7 @@ void MidiMappernRT::useFreeID(int ID)
 
     //TODO clean up unused value and callback objects
 
+    storage->buildLookup();
     char buf[1024];
     rtosc_message(buf, 1024, "/midi-learn/midi-bind", "b", sizeof(storage), &storage);
     rt_cb(buf);
@@ -336,6 +451,7 @@ void MidiMappernRT::unMap(const char *addr, bool coarse)
 
     //TODO clean up unused value and callback objects
 
+    storage->buildLookup();
     char buf[1024];
     rtosc_message(buf, 1024, "/midi-learn/midi-bind", "b", sizeof(storage), &storage);
     rt_cb(buf);
@@ -353,6 +469,7 @@ void MidiMappernRT::clear(void)
     storage = new MidiMapperStorage();
     learnQueue.clear();
     inv_map.clear();
+    storage->buildLookup();
     char buf[1024];
     rtosc_message(buf, 1024, "/midi-learn/midi-bind", "b", sizeof(storage), &storage);
     rt_cb(buf);
@@ -476,6 +593,7 @@ void MidiMappernRT::setBounds(const char *str, float low, float high)
 
     storage = nstorage;
 
+    storage->buildLookup();
     char buf[1024];
     rtosc_message(buf, 1024, "/midi-learn/midi-bind", "b", sizeof(storage), &storage);
     rt_cb(buf);
@@ -560,7 +678,7 @@ int MidiMappernRT::getFine(std::string addr)
  *****************/
 
 MidiMapperRT::MidiMapperRT(void)
-:storage(NULL), watchSize(0)
+:storage(NULL), watchSize(0), coalesce(false)
 {}
 void MidiMapperRT::setBackendCb(std::function<void(const char*)> cb) {backend = cb;}
 void MidiMapperRT::setFrontendCb(std::function<void(const char*)> cb) {frontend = cb;}
@@ -569,7 +687,25 @@ void MidiMapperRT::handleCC(int par, int val, char chan, bool isNrpn) {
     if(chan<1) chan=1;
     int ID = (isNrpn<<18) + (((chan-1)&0x0f)<<14) + par;
     //printf("handling CC(%d,%d){%d,%d,%d}\n", ID, val, (int)storage, pending.has(ID), watchSize);
-    if((!storage || !storage->handleCC(ID, val, backend)) && !pending.has(ID) && watchSize) {
+    if(!storage || !storage->handleCC(ID, val, backend, coalesce))
+        watch(ID);
+}
+void MidiMapperRT::handleCC14(int par, int val, char chan, bool isNrpn) {
+    if(chan<1) chan=1;
+    int ID = (isNrpn<<18) + (((chan-1)&0x0f)<<14) + par;
+    if(!storage || !storage->handleValue(ID, val, backend, coalesce))
+        watch(ID);
+}
+void MidiMapperRT::handleValue(int par, uint32_t val, char chan, bool isNrpn) {
+    handleCC14(par, val>>18, chan, isNrpn);
+}
+void MidiMapperRT::processBlock(void) {
+    if(storage)
+        storage->flush(backend);
+}
+//Offer an unmapped ID for learning
+void MidiMapperRT::watch(int ID) {
+    if(!pending.has(ID) && watchSize) {
         watchSize--;
         pending.insert(ID);
         char msg[1024];
@@ -596,6 +732,7 @@ const rtosc::Ports MidiMapperRT::ports = {
             MidiMapperStorage *nstorage =
                 *(MidiMapperStorage**)rtosc_argument(msg,0).b.data;
             if(midi.storage) {
+                midi.storage->flush(midi.backend);
                 nstorage->cloneValues(*midi.storage);
                 midi.storage = nstorage;
             } else
@@ -619,6 +756,7 @@ Port MidiMapperRT::bindPort(void) {
         MidiMapperStorage *nstorage =
             *(MidiMapperStorage**)rtosc_argument(msg,0).b.data;
         if(storage) {
+            storage->flush(backend);
             nstorage->cloneValues(*storage);
             storage = nstorage;
         } else
@@ -5,7 +5,9 @@
 using namespace rtosc;
 
 #define RTOSC_INVALID_MIDI 255
-        
+#define RTOSC_MIDI_CHANNELS 16
+#define RTOSC_MIDI_CONTROLLERS 128
+
 class rtosc::MidiTable_Impl
 {
     public:
@@ -32,9 +34,23 @@ class rtosc::MidiTable_Impl
         MidiAddr *begin(void) {return table;}
         MidiAddr *end(void) {return table + elms;}
 
+        //Find the entries of all channels and controllers again
+        void rebuild(void)
+        {
+            memset(lookup, 0, sizeof(lookup));
+            //backwards, so the first entry wins, like in a linear search
+            for(unsigned i=elms; i-- > 0;) {
+                MidiAddr &e = table[i];
+                if(e.ch < RTOSC_MIDI_CHANNELS && e.ctl < RTOSC_MIDI_CONTROLLERS)
+                    lookup[e.ch][e.ctl] = &e;
+            }
+        }
+
         unsigned len;
         unsigned elms;
         MidiAddr *table;
+        //Entry of each channel and controller, or NULL
+        MidiAddr *lookup[RTOSC_MIDI_CHANNELS][RTOSC_MIDI_CONTROLLERS] = {};
 };
 
 //MidiAddr::MidiAddr(void)
@@ -67,15 +83,18 @@ MidiTable::~MidiTable()
 
 bool MidiTable::has(uint8_t ch, uint8_t ctl) const
 {
-    for(auto e: *impl) {
-        if(e.ch == ch && e.ctl == ctl)
-            return true;
-    }
-    return false;
+    return get(ch, ctl);
 }
 
 MidiAddr *MidiTable::get(uint8_t ch, uint8_t ctl)
 {
+    if(ch < RTOSC_MIDI_CHANNELS && ctl < RTOSC_MIDI_CONTROLLERS) {
+        MidiAddr *e = impl->lookup[ch][ctl];
+        //entries may have been changed through this function, so only hits
+        //are certain, and misses are searched
+        if(e && e->ch == ch && e->ctl == ctl)
+            return e;
+    }
     for(auto &e: *impl)
         if(e.ch==ch && e.ctl == ctl)
             return &e;
@@ -84,10 +103,7 @@ MidiAddr *MidiTable::get(uint8_t ch, uint8_t ctl)
 
 const MidiAddr *MidiTable::get(uint8_t ch, uint8_t ctl) const
 {
-    for(auto &e:*impl)
-        if(e.ch==ch && e.ctl == ctl)
-            return &e;
-    return NULL;
+    return const_cast<MidiTable*>(this)->get(ch, ctl);
 }
 
 bool MidiTable::mash_port(MidiAddr &e, const Port &port)
@@ -96,10 +112,32 @@ bool MidiTable::mash_port(MidiAddr &e, const Port &port)
     if(!args)
         return false;
 
+    e.scale = 0;
+    e.a = e.b = 0;
+
     //Consider a path to be typed based upon the argument restrictors
     if(strchr(args, 'f')) {
         e.type = 'f';
         e.conversion = port.metadata;
+
+        //precompile translate()
+        Port::MetaContainer meta(port.metadata);
+        if(!meta["min"] || !meta["max"] || !meta["scale"]) {
+            fprintf(stderr, "failed to get properties\n");
+            return true;
+        }
+        const float min   = atof(meta["min"]);
+        const float max   = atof(meta["max"]);
+        const char *scale = meta["scale"];
+        if(!strcmp(scale,"linear")) {
+            e.scale = 'l';
+            e.a = max-min;
+            e.b = min;
+        } else if(!strcmp(scale,"logarithmic")) {
+            e.scale = 'e';
+            e.b = log(meta["logmin"] ? atof(meta["logmin"]) : min);
+            e.a = log(max)-e.b;
+        }
     } else if(strchr(args, 'i'))
         e.type = 'i';
     else if(strchr(args, 'T'))
@@ -127,6 +165,7 @@ void MidiTable::addElm(uint8_t ch, uint8_t ctl, const char *path)
             e->ctl = RTOSC_INVALID_MIDI;
             error_cb("Failed to read metadata", path);
         }
+        impl->rebuild();
         modify_cb("REPLACE", path, e->conversion, (int) ch, (int) ctl);
         return;
     }
@@ -141,6 +180,7 @@ void MidiTable::addElm(uint8_t ch, uint8_t ctl, const char *path)
                 e.ctl = RTOSC_INVALID_MIDI;
                 error_cb("Failed to read metadata", path);
             }
+            impl->rebuild();
             modify_cb("ADD", path, e.conversion, (int) ch, (int) ctl);
             return;
         }
@@ -175,6 +215,7 @@ void MidiTable::clear_entry(const char *s)
             //Invalidate
             impl->table[i].ch  = RTOSC_INVALID_MIDI;
             impl->table[i].ctl = RTOSC_INVALID_MIDI;
+            impl->rebuild();
             modify_cb("DEL", s, "", -1, -1);
             break;
         }
@@ -196,7 +237,7 @@ void MidiTable::process(uint8_t ch, uint8_t ctl, uint8_t val)
     {
         case 'f':
             rtosc_message(buffer, 1024, addr->path,
-                    "f", translate(val,addr->conversion));
+                    "f", convert(val, *addr));
             break;
         case 'i':
             rtosc_message(buffer, 1024, addr->path,
@@ -266,3 +307,14 @@ float MidiTable::translate(uint8_t val, const char *meta_)
 
     return 0.0f;
 }
+
+float MidiTable::convert(uint8_t val, const MidiAddr &addr)
+{
+    float x = val!=64.0 ? val/127.0 : 0.5;
+    switch(addr.scale)
+    {
+        case 'l': return addr.a*x+addr.b;
+        case 'e': return expf(addr.a*x+addr.b);
+        default:  return 0.0f;
+    }
+}
@@ -22,7 +22,9 @@
  * DEALINGS IN THE SOFTWARE.
  */
 
+#include <algorithm>
 #include <cassert>
+#include <chrono>
 #include <vector>
 #include <set>
 #include <cstring>
@@ -181,6 +183,50 @@ void port_checker::server::init(const char *target_url)
     }
 }
 
+void port_checker::server::keep(std::vector<char>&& msg)
+{
+    auto itr = m_received.find(msg.data());
+    if(itr != m_received.end())
+        itr->second.push_back(std::move(msg));
+}
+
+void port_checker::server::expect(const char* path)
+{
+    m_received[path];
+}
+
+void port_checker::server::unexpect(const char* path)
+{
+    m_received.erase(path);
+}
+
+bool port_checker::server::take_reply(const char* path,
+                                      std::vector<char>* buffer,
+                                      std::vector<rtosc_arg_val_t>* args)
+{
+    auto itr = m_received.find(path);
+    if(itr == m_received.end() || itr->second.empty())
+        return false;
+    *buffer = std::move(itr->second.front());
+    itr->second.pop_front();
+
+    const char* types = rtosc_argument_string(buffer->data());
+    args->resize(strlen(types));
+    for(std::size_t i = 0; i < args->size(); ++i)
+    {
+        (*args)[i].type = types[i];
+        (*args)[i].val = rtosc_argument(buffer->data(), i);
+    }
+    return true;
+}
+
+void port_checker::set_pipelined(int window,
+    std::vector<std::pair<server*, server*>> connections)
+{
+    m_window = window;
+    m_connections = std::move(connections);
+}
+
 bool port_checker::send_msg(const char* address,
                             size_t nargs, const rtosc_arg_val_t* args)
 {
@@ -414,58 +460,220 @@ void port_checker::check_port(const char* loc, const char* portname,
                         raise(issue::roptions_port_not_si);
                 }
 
-                // send and reply...
-                // first, get some useful values
-                send_msg(full_path.c_str(), 0, nullptr);
-                std::vector<rtosc_arg_val_t> args1;
-                std::vector<char> strbuf1;
-                int res = sender->wait_for_reply(&strbuf1, &args1,
-                                                 full_path.c_str());
+                // send and reply after the walk, so the values which are
+                // changed by the checks do not affect port_is_enabled()
+                m_param_checks.emplace_back(full_path,
+                                            std::string(loc) + portname);
+            }
+            }
+            else {
+                if(default_values.size())
+                    raise(issue::rdefault_without_rparameter);
+            }
+        }
+    }
+}
+
+void port_checker::check_parameter(const char* full_path,
+                                   const std::string& port)
+{
+    auto raise = [this, &port](issue issue_type) {
+        m_issues.emplace(issue_type, port);
+    };
+
+    // first, get some useful values
+    send_msg(full_path, 0, nullptr);
+    std::vector<rtosc_arg_val_t> args1;
+    std::vector<char> strbuf1;
+    int res = sender->wait_for_reply(&strbuf1, &args1, full_path);
+
+    if(res)
+    {
+        // alternate the values...
+        for(rtosc_arg_val_t& a : args1)
+            alternate_arg_val(a);
+        // ... and send them back
+        send_msg(full_path, args1.size(), args1.data());
+        args1.clear();
+        strbuf1.clear();
+        res = sender->wait_for_reply(&strbuf1, &args1,
+                                     full_path, nullptr,
+                                     "/undo_change", nullptr);
+
+        if(!res)
+            raise(issue::parameter_not_replied);
+        else {
+            if(sender->replied_path() == 1 /* i.e. undo_change */) {
+                // some apps may reply with undo_change, some may
+                // already catch those... if we get one: retry
+                res = sender->wait_for_reply(&strbuf1, &args1, full_path);
+            }
+
+            if(res)
+            {
+                res = other->wait_for_reply(&strbuf1, &args1, full_path);
+                if(!res)
+                    raise(issue::parameter_not_broadcast);
+            }
+            else raise(issue::parameter_not_replied);
+        }
+    }
+    else {
+        raise(issue::parameter_not_queryable);
+    }
+}
+
+/*
+    Pipelined parameter checks: each check runs through the same steps as in
+    check_parameter(), but instead of waiting, all replies are kept by the
+    servers and each check advances when its reply has arrived.
+*/
+namespace {
+struct param_check_state_t
+{
+    enum { queued, queried, set, broadcast, done } step = queued;
+    std::chrono::steady_clock::time_point since;
+    //! issue found, or issue::number if none
+    issue result = issue::number;
+};
+}
 
-                if(res)
+void port_checker::run_param_checks()
+{
+    using clock = std::chrono::steady_clock;
+
+    struct connection_t
+    {
+        server *sender, *other;
+        std::size_t next, end;          //!< checks not started yet
+        std::vector<std::size_t> active; //!< checks in flight
+    };
+    std::vector<connection_t> conns;
+    conns.push_back({sender, other, 0, 0, {}});
+    for(const auto& pr : m_connections)
+        conns.push_back({pr.first, pr.second, 0, 0, {}});
+
+    bool supported = m_window > 0;
+    for(connection_t& c : conns)
+        supported = supported && c.sender->receive(0) && c.other->receive(0);
+    if(!supported)
+    {
+        for(const auto& pr : m_param_checks)
+            check_parameter(pr.first.c_str(), pr.second);
+        m_param_checks.clear();
+        return;
+    }
+
+    const std::size_t n = m_param_checks.size();
+    for(std::size_t i = 0; i < conns.size(); ++i)
+    {
+        conns[i].next = i * n / conns.size();
+        conns[i].end = (i + 1) * n / conns.size();
+    }
+
+    std::vector<param_check_state_t> states(n);
+    std::set<std::string> in_flight; // duplicate ports share the path
+    std::vector<rtosc_arg_val_t> args;
+    std::vector<char> strbuf;
+    std::size_t finished = 0;
+
+    while(finished < n)
+    {
+        bool progress = false;
+        for(connection_t& c : conns)
+        {
+            const clock::time_point now = clock::now();
+            auto timed_out = [&](const param_check_state_t& st) {
+                return now - st.since >
+                       std::chrono::milliseconds(c.sender->timeout());
+            };
+            auto finish = [&](std::size_t i, issue result) {
+                const char* path = m_param_checks[i].first.c_str();
+                c.sender->unexpect(path);
+                c.other->unexpect(path);
+                in_flight.erase(path);
+                states[i].step = param_check_state_t::done;
+                states[i].result = result;
+                ++finished;
+                progress = true;
+            };
+
+            // start new checks
+            while(c.active.size() < (std::size_t)m_window && c.next < c.end &&
+                  !in_flight.count(m_param_checks[c.next].first))
+            {
+                const char* path = m_param_checks[c.next].first.c_str();
+                in_flight.insert(path);
+                c.sender->expect(path);
+                c.sender->send_msg(path, 0, nullptr);
+                states[c.next].step = param_check_state_t::queried;
+                states[c.next].since = now;
+                c.active.push_back(c.next++);
+                progress = true;
+            }
+
+            c.sender->receive(0);
+            c.other->receive(0);
+
+            // advance the checks in flight
+            for(std::size_t i : c.active)
+            {
+                param_check_state_t& st = states[i];
+                const char* path = m_param_checks[i].first.c_str();
+                switch(st.step)
                 {
-                    // alternate the values...
-                    for(rtosc_arg_val_t& a : args1)
-                        alternate_arg_val(a);
-                    // ... and send them back
-                    send_msg(full_path.c_str(), args1.size(), args1.data());
-                    args1.clear();
-                    strbuf1.clear();
-                    res = sender->wait_for_reply(&strbuf1, &args1,
-                                                 full_path.c_str(), nullptr,
-                                                 "/undo_change", nullptr);
-
-                    if(!res)
-                        raise(issue::parameter_not_replied);
-                    else {
-                        if(sender->replied_path() == 1 /* i.e. undo_change */) {
-                            // some apps may reply with undo_change, some may
-                            // already catch those... if we get one: retry
-                            res = sender->wait_for_reply(&strbuf1, &args1,
-                                                         full_path.c_str());
+                    case param_check_state_t::queried:
+                        if(c.sender->take_reply(path, &strbuf, &args))
+                        {
+                            // alternate the values and send them back
+                            for(rtosc_arg_val_t& a : args)
+                                alternate_arg_val(a);
+                            c.other->expect(path);
+                            c.sender->send_msg(path, args.size(), args.data());
+                            st.step = param_check_state_t::set;
+                            st.since = now;
+                            progress = true;
                         }
-
-                        if(res)
+                        else if(timed_out(st))
+                            finish(i, issue::parameter_not_queryable);
+                        break;
+                    case param_check_state_t::set:
+                        // "/undo_change" is not expected, so it is skipped
+                        if(c.sender->take_reply(path, &strbuf, &args))
                         {
-                            res = other->wait_for_reply(&strbuf1, &args1,
-                                                        full_path.c_str());
-                            if(!res)
-                                raise(issue::parameter_not_broadcast);
+                            st.step = param_check_state_t::broadcast;
+                            st.since = now;
+                            progress = true;
                         }
-                        else raise(issue::parameter_not_replied);
-                    }
+                        else if(timed_out(st))
+                            finish(i, issue::parameter_not_replied);
+                        break;
+                    case param_check_state_t::broadcast:
+                        if(c.other->take_reply(path, &strbuf, &args))
+                            finish(i, issue::number);
+                        else if(timed_out(st))
+                            finish(i, issue::parameter_not_broadcast);
+                        break;
+                    default:
+                        break;
                 }
-                else {
-                    raise(issue::parameter_not_queryable);
-                }
-            }
-            }
-            else {
-                if(default_values.size())
-                    raise(issue::rdefault_without_rparameter);
             }
+            c.active.erase(std::remove_if(c.active.begin(), c.active.end(),
+                [&states](std::size_t i) {
+                    return states[i].step == param_check_state_t::done; }),
+                c.active.end());
         }
+
+        // nothing to do: wait for the next message
+        if(!progress)
+            conns[0].sender->receive(1);
     }
+
+    // report issues in the order of the ports, like serial checks
+    for(std::size_t i = 0; i < n; ++i)
+        if(states[i].result != issue::number)
+            m_issues.emplace(states[i].result, m_param_checks[i].second);
+    m_param_checks.clear();
 }
 
 void port_checker::print_evaluation() const
@@ -801,14 +1009,178 @@ bool port_checker::operator()(const char* url)
 
     sender->init(sendtourl.c_str());
     other->init(sendtourl.c_str());
+    for(const auto& pr : m_connections)
+    {
+        pr.first->init(sendtourl.c_str());
+        pr.second->init(sendtourl.c_str());
+    }
 
     char loc_buffer[4096] = { '/', 0 };
     do_checks(loc_buffer, sizeof(loc_buffer));
+    run_param_checks();
 
     finish_time = time(NULL);
     return true;
 }
 
+//! RtData to send replies and broadcasts from an inprocess_app to its servers
+class inprocess_rtdata : public RtData
+{
+    char loc_buffer[1024];
+    char buffer[4*4096];
+    std::vector<inprocess_server*>& servers;
+    inprocess_server* from;
+
+public:
+    inprocess_rtdata(std::vector<inprocess_server*>& servers,
+                     inprocess_server* from, void* object)
+        : servers(servers), from(from)
+    {
+        memset(loc_buffer, 0, sizeof(loc_buffer));
+        loc = loc_buffer;
+        loc_size = sizeof(loc_buffer);
+        obj = object;
+    }
+
+    void replyArray(const char *path, const char *args,
+                    rtosc_arg_t *vals) override
+    {
+        if(rtosc_amessage(buffer, sizeof(buffer), path, args, vals))
+            reply(buffer);
+    }
+    void broadcastArray(const char *path, const char *args,
+                        rtosc_arg_t *vals) override
+    {
+        if(rtosc_amessage(buffer, sizeof(buffer), path, args, vals))
+            broadcast(buffer);
+    }
+    //! reply to the sender
+    void reply(const char *msg) override { from->deliver(msg); }
+    //! broadcast to all servers
+    void broadcast(const char *msg) override
+    {
+        for(inprocess_server* s : servers)
+            s->deliver(msg);
+    }
+    using RtData::reply;
+    using RtData::broadcast;
+};
+
+inprocess_app::inprocess_app(const Ports& ports, void* object,
+                             std::size_t max_ports)
+    : ports(ports), object(object), max_ports(max_ports),
+      path_search_buffer(max_ports * 256 + 1024)
+{
+}
+
+void inprocess_app::connect(inprocess_server* server)
+{
+    if(std::find(servers.begin(), servers.end(), server) == servers.end())
+        servers.push_back(server);
+}
+
+void inprocess_app::disconnect(inprocess_server* server)
+{
+    servers.erase(std::remove(servers.begin(), servers.end(), server),
+                  servers.end());
+}
+
+void inprocess_app::dispatch(const char* msg, inprocess_server* from)
+{
+    if(!strcmp(msg, "/path-search") &&
+       !strcmp("ssT", rtosc_argument_string(msg)))
+    {
+        std::size_t length =
+            path_search(ports, msg, max_ports, path_search_buffer.data(),
+                        path_search_buffer.size(),
+                        path_search_opts::sorted_and_unique_prefix, true);
+        if(length)
+            from->deliver(path_search_buffer.data());
+    }
+    else if(msg[0] == '/' && strrchr(msg, '/')[1])
+    {
+        inprocess_rtdata d(servers, from, object);
+        ports.dispatch(msg, d, true);
+    }
+}
+
+inprocess_server::~inprocess_server()
+{
+    app.disconnect(this);
+}
+
+void inprocess_server::vinit(const char* )
+{
+    app.connect(this);
+}
+
+void inprocess_server::deliver(const char* msg)
+{
+    inbox.emplace_back(msg, msg + rtosc_message_length(msg, -1));
+}
+
+bool inprocess_server::send_msg(const char* address,
+                                size_t nargs, const rtosc_arg_val_t* args)
+{
+    char buffer[8192];
+    std::size_t len = rtosc_avmessage(buffer, sizeof(buffer), address,
+                                      nargs, args);
+    if(!len)
+        throw std::runtime_error("could not create message");
+    app.dispatch(buffer, this);
+    return true;
+}
+
+void inprocess_server::on_recv(std::vector<char>&& msg)
+{
+    if(waiting && exp_paths_n_args[0].size())
+    {
+        _replied_path = 0;
+        for(std::vector<const char*>* exp_strs = exp_paths_n_args;
+            exp_strs->size(); ++exp_strs, ++_replied_path)
+        if(!strcmp((*exp_strs)[0], msg.data()))
+        {
+            *last_buffer = std::move(msg);
+            const char* types = rtosc_argument_string(last_buffer->data());
+            server::handle_recv(strlen(types), types, exp_strs);
+            break;
+        }
+    }
+}
+
+bool inprocess_server::_wait_for_reply(std::vector<char>* buffer,
+                                       std::vector<rtosc_arg_val_t> * args,
+                                       int n0, int n1)
+{
+    (void)n0;
+    exp_paths_n_args[n1].clear();
+
+    last_args = args;
+    last_buffer = buffer;
+
+    // all replies have been delivered already, other messages are discarded
+    while(waiting && !inbox.empty())
+    {
+        std::vector<char> msg = std::move(inbox.front());
+        inbox.pop_front();
+        on_recv(std::move(msg));
+    }
+    bool replied = !waiting;
+    waiting = true; // prepare for next round
+
+    return replied;
+}
+
+bool inprocess_server::receive(int )
+{
+    while(!inbox.empty())
+    {
+        keep(std::move(inbox.front()));
+        inbox.pop_front();
+    }
+    return true;
+}
+
 port_error::port_error(const char *errmsg, const char *port)
     : runtime_error(errmsg)
 {
@@ -27,6 +27,7 @@
 #include <cstdarg>
 #include <cstring>
 #include <cassert>
+#include <vector>
 
 #include <rtosc/pretty-format.h>
 #include <rtosc/ports.h>
@@ -137,7 +138,7 @@ class Capture : public RtData
     size_t max_args;
     rtosc_arg_val_t* arg_vals;
     int nargs;
-    std::vector<std::vector<char>>* scratch_bufs;
+    rtosc_arena_t* arena;
 
     void chain(const char *path, const char *args, ...) override
     {
@@ -152,7 +153,7 @@ class Capture : public RtData
         nargs = 0;
     }
 
-    // save blobs to *this, so the pointers still point to valid memory
+    // save blobs to the arena, so the pointers still point to valid memory
     // if the caller deletes it at the end of the capture
     void map_blobs()
     {
@@ -161,12 +162,14 @@ class Capture : public RtData
             if(arg_vals[i].type == 'b'
                && arg_vals[i].val.b.data && arg_vals[i].val.b.len)
             {
-                scratch_bufs->resize(scratch_bufs->size()+1);
-                scratch_bufs->back().resize(arg_vals[i].val.b.len);
+                assert(arena);
+                uint8_t* copy = (uint8_t*)rtosc_arena_alloc(
+                                    arena, arg_vals[i].val.b.len);
+                assert(copy);
                 std::copy_n(arg_vals[i].val.b.data,
                             arg_vals[i].val.b.len,
-                            scratch_bufs->back().begin());
-                arg_vals[i].val.b.data = (uint8_t*)scratch_bufs->back().data();
+                            copy);
+                arg_vals[i].val.b.data = copy;
             }
         }
     }
@@ -214,9 +217,9 @@ class Capture : public RtData
 public:
     //! Return the number of argument values stored
     int size() const { return nargs; }
-    Capture(std::size_t max_args, rtosc_arg_val_t* arg_vals, std::vector<std::vector<char>>* scratch_bufs) :
+    Capture(std::size_t max_args, rtosc_arg_val_t* arg_vals, rtosc_arena_t* arena) :
         max_args(max_args), arg_vals(arg_vals), nargs(-1),
-        scratch_bufs(scratch_bufs) {}
+        arena(arena) {}
     //! Silence compiler warnings
     std::size_t dont_use_this_function() { return max_args; }
 };
@@ -226,7 +229,7 @@ size_t get_value_from_runtime(void* runtime, const Port& port,
                               const char* portname_from_base,
                               std::size_t buffersize,
                               std::size_t max_args, rtosc_arg_val_t* arg_vals,
-                              std::vector<std::vector<char> >* scratch_bufs)
+                              rtosc_arena_t* arena)
 {
     assert(portname_from_base);
 
@@ -234,7 +237,7 @@ size_t get_value_from_runtime(void* runtime, const Port& port,
     fast_strcpy(buffer_with_port, loc, buffersize);
     std::size_t addr_len = strlen(buffer_with_port);
 
-    Capture d(max_args, arg_vals, scratch_bufs);
+    Capture d(max_args, arg_vals, arena);
     d.obj = runtime;
     d.loc_size = loc_size;
     d.loc = loc;
@@ -261,6 +264,101 @@ size_t get_value_from_runtime(void* runtime, const Port& port,
     return d.size();
 }
 
+size_t get_value_from_runtime(void* runtime, const Port& port,
+                              size_t loc_size, char* loc,
+                              const char* portname_from_base,
+                              std::size_t buffersize,
+                              std::size_t max_args, rtosc_arg_val_t* arg_vals,
+                              std::vector<std::vector<char>>* scratch_bufs)
+{
+    rtosc_arena_t arena;
+    rtosc_arena_init(&arena, 256);
+    size_t nargs = get_value_from_runtime(runtime, port, loc_size, loc,
+                                          portname_from_base, buffersize,
+                                          max_args, arg_vals,
+                                          scratch_bufs ? &arena : nullptr);
+
+    // move the blobs from the arena, which is destroyed now
+    for(size_t i = 0; i < nargs; ++i)
+    {
+        if(arg_vals[i].type == 'b'
+           && arg_vals[i].val.b.data && arg_vals[i].val.b.len)
+        {
+            scratch_bufs->emplace_back(arg_vals[i].val.b.data,
+                                       arg_vals[i].val.b.data +
+                                           arg_vals[i].val.b.len);
+            arg_vals[i].val.b.data = (uint8_t*)scratch_bufs->back().data();
+        }
+    }
+    rtosc_arena_destroy(&arena);
+    return nargs;
+}
+
+size_t get_value_from_runtime(void* runtime, const Port& port,
+                              size_t loc_size, char* loc,
+                              const char* portname_from_base,
+                              std::size_t buffersize,
+                              std::size_t max_args, rtosc_arg_val_t* arg_vals,
+                              std::nullptr_t)
+{
+    return get_value_from_runtime(runtime, port, loc_size, loc,
+                                  portname_from_base, buffersize,
+                                  max_args, arg_vals,
+                                  (rtosc_arena_t*)nullptr);
+}
+
+//! RtData subclass to capture the port and runtime object which reply to
+//! a query
+class RouteCapture : public RtData
+{
+    void capture(void)
+    {
+        if(!found)
+            found = port, runtime = obj;
+    }
+
+    void reply(const char *) override { capture(); }
+    void reply(const char *, const char *, ...) override { capture(); }
+    void replyArray(const char *, const char *, rtosc_arg_t *) override
+    { capture(); }
+    void broadcast(const char *) override { capture(); }
+    void broadcast(const char *, const char *, ...) override { capture(); }
+    void broadcastArray(const char *, const char *, rtosc_arg_t *) override
+    { capture(); }
+
+public:
+    const Port *found = NULL;
+    void *runtime = NULL;
+};
+
+const Port* find_leaf_port(void* runtime, const Ports& ports,
+                           size_t loc_size, char* loc,
+                           const char* query,
+                           void** obj, std::size_t* leaf)
+{
+    RouteCapture d;
+    d.obj = runtime;
+    d.loc = loc;
+    d.loc_size = loc_size;
+    ports.dispatch(query, d, *query == '/');
+    if(!d.found || d.found->ports)
+        return NULL;
+
+    //the port receives the last path components, one more than its slashes
+    int components = 1;
+    for(const char *c = d.found->name; *c && *c != ':'; ++c)
+        components += *c == '/';
+    std::size_t pos = strlen(query);
+    while(pos > 0 && (query[pos-1] != '/' || --components))
+        --pos;
+    if(components > 1)
+        return NULL; //the query is shorter than the port's name
+
+    *obj = d.runtime;
+    *leaf = pos;
+    return d.found;
+}
+
 } // namespace helpers
 } // namespace rtosc
 
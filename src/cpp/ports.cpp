@@ -3,6 +3,7 @@
 #include "../../include/rtosc/ports.h"
 #include "../../include/rtosc/ports-runtime.h"
 #include "../../include/rtosc/bundle-foreach.h"
+#include "../../include/rtosc/message-pool.h"
 
 #include <ostream>
 #include <cassert>
@@ -71,13 +72,40 @@ void RtData::replyArray(const char *path, const char *args,
     (void) args;
     (void) vals;
 }
+/*
+ * Build a message from arguments and pass it to f
+ *
+ * Messages are built on the stack, only larger ones take a buffer of the
+ * message pool. Messages which fit no free buffer are dropped and counted
+ * by the pool.
+ */
+template<class F>
+static void build_message(RtData &d, const char *path, const char *args,
+                          va_list va, F f)
+{
+    char buffer[8192];
+    va_list va_try;
+    va_copy(va_try, va);
+    size_t len = rtosc_vmessage(buffer,sizeof(buffer),path,args,va_try);
+    va_end(va_try);
+    if(len) {
+        f(buffer);
+        return;
+    }
+    MessagePool *pool = d.message_pool();
+    if(!pool)
+        return;
+    MessagePool::buffer msg = pool->vmessage(path,args,va);
+    if(msg)
+        f(msg.data());
+}
+
 void RtData::reply(const char *path, const char *args, ...)
 {
     va_list va;
     va_start(va,args);
-    char buffer[8192];
-    rtosc_vmessage(buffer,8192,path,args,va);
-    reply(buffer);
+    build_message(*this, path, args, va,
+                  [this](const char *msg) { reply(msg); });
     va_end(va);
 }
 void RtData::reply(const char *msg)
@@ -103,9 +131,8 @@ void RtData::broadcast(const char *path, const char *args, ...)
 {
     va_list va;
     va_start(va,args);
-    char buffer[8192];
-    rtosc_vmessage(buffer,8192,path,args,va);
-    broadcast(buffer);
+    build_message(*this, path, args, va,
+                  [this](const char *msg) { broadcast(msg); });
     va_end(va);
 }
 void RtData::broadcast(const char *msg)
@@ -123,6 +150,11 @@ void RtData::forward(const char *rational)
     (void) rational;
 }
 
+MessagePool *RtData::message_pool(void)
+{
+    return &MessagePool::default_pool();
+}
+
 void metaiterator_advance(const char *&title, const char *&value)
 {
     if(!title || !*title) {
@@ -474,6 +506,13 @@ static void generate_minimal_hash(std::vector<std::string> str, Port_Matcher &pm
         return;
     }
     pm.assoc = find_assoc(str, pm.pos);
+    //the associated values are only a heuristic, so colliding ports would
+    //overwrite each other in the remap table
+    auto hashed = do_hash(str, pm.pos, pm.assoc);
+    if(count_dups(hashed)) {
+        pm.pos.clear();
+        return;
+    }
     pm.remap = find_remap(str, pm.pos, pm.assoc);
 }
 
@@ -1088,7 +1127,7 @@ static void walk_ports_recurse0(const Port& p, char* name_buffer,
 #ifdef NDEBUG
     (void)write_space;
 #endif
-    const char* hash_ptr = strchr(read_head + 1,'#');
+    const char* hash_ptr = *read_head ? strchr(read_head + 1,'#') : NULL;
     ssize_t to_copy = hash_ptr ? hash_ptr - read_head : strlen(read_head);
 
     // Check write space is sufficient
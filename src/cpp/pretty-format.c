@@ -27,6 +27,10 @@
 #include <inttypes.h>
 #include <limits.h>
 #include <ctype.h>
+#include <float.h>
+#include <math.h>
+#include <stdarg.h>
+#include <stdlib.h>
 #include <string.h>
 #include <time.h>
 #include <stdio.h>
@@ -109,6 +113,56 @@ static size_t remove_trailing_zeroes(char* str)
     return removed;
 }
 
+/**
+ * Append @p c at @p wrt, truncating like snprintf if @p bs is too small
+ * @return the length the output would have with enough space
+ */
+static size_t append_char(char* buffer, size_t bs, size_t wrt, char c)
+{
+    if(wrt + 1 < bs)
+    {
+        buffer[wrt] = c;
+        buffer[wrt + 1] = 0;
+    }
+    return wrt + 1;
+}
+
+/**
+ * Print a floating point value like "%#.*f", but without calling snprintf
+ *   for all common values
+ */
+static size_t print_fixed(char* buffer, size_t bs, double val, int prec)
+{
+    size_t wrt = fast_print_fixed(buffer, bs, val, prec);
+    return wrt ? wrt : (size_t)asnprintf(buffer, bs, "%#.*f", prec, val);
+}
+
+/**
+ * Print the lossless part of a floating point value, i.e. " (%a)"
+ * @param strip_zeroes Whether to remove trailing zeroes if snprintf has
+ *   been used (the fast path never prints them)
+ */
+static size_t print_lossless(char* buffer, size_t bs, double val,
+                             int strip_zeroes)
+{
+    size_t wrt;
+    size_t hexlen = (bs > 2) ? fast_print_hexfloat(buffer + 2, bs - 2, val)
+                             : 0;
+    if(hexlen)
+    {
+        buffer[0] = ' ';
+        buffer[1] = '(';
+        wrt = append_char(buffer, bs, 2 + hexlen, ')');
+    }
+    else
+    {
+        wrt = asnprintf(buffer, bs, " (%a)", val);
+        if(strip_zeroes)
+            wrt -= remove_trailing_zeroes(buffer + 2);
+    }
+    return wrt;
+}
+
 //! return the offset of the next arg from cur, arrays seen as one arg and
 //! delta args (from ranges) seen as @p additional_for_delta args
 static int next_arg_offset(const rtosc_arg_val_t* cur)
@@ -380,7 +434,10 @@ static int32_t rtosc_convert_to_range(const rtosc_arg_val_t* const arg,
         return 0;
     char type = arg->type;
     size_t num_common = 0;
-    for(size_t i = 0; i < size; i += incsize(arg+i), ++num_common)
+    // do not count further than range_min, this function is called for each
+    // arg val (and must thereby be in O(1) if no range is found)
+    for(size_t i = 0; i < size && num_common < range_min;
+        i += incsize(arg+i), ++num_common)
     {
         if(type != arg[i].type)
             break;
@@ -401,6 +458,13 @@ static int32_t rtosc_convert_to_range(const rtosc_arg_val_t* const arg,
     }
     else return 0;
 
+    if(type != 'a')
+    {
+        num_common = rtosc_arg_val_run_length(arg, size,
+                                              has_delta ? &delta : NULL);
+        skipped = num_common;
+    }
+    else
     {
         int go_on = 1;
         size_t next;
@@ -466,7 +530,8 @@ size_t rtosc_print_arg_val(const rtosc_arg_val_t *arg,
             wrt = 3;
             break;
         case 'h':
-            wrt = asnprintf(buffer, bs, "%"PRId64"h", val->h);
+            wrt = fast_print_int64(buffer, bs, val->h);
+            wrt = append_char(buffer, bs, wrt, 'h');
             break;
         case 't': // write to ISO 8601 date
         {
@@ -531,28 +596,20 @@ size_t rtosc_print_arg_val(const rtosc_arg_val_t *arg,
             int prec = opt->floating_point_precision;
             assert(prec>=0);
             assert(prec<100);
-            char fmtstr[9];
             if(arg->type == 'f')
             {
-                // e.g. "%.42f" or "%.0f.":
-                asnprintf(fmtstr, 6, "%%#.%df", prec);
-                wrt = asnprintf(buffer, bs, fmtstr, val->f);
-                if(opt->lossless)
-                {
-                    char* last_pos = buffer + wrt;
-                    wrt += asnprintf(buffer + wrt, bs - wrt,
-                                     " (%a)", val->f);
-                    wrt -= remove_trailing_zeroes(last_pos+2);
-                }
+                // e.g. "42.00" or "1."
+                wrt = print_fixed(buffer, bs, val->f, prec);
+                if(opt->lossless && wrt < bs)
+                    wrt += print_lossless(buffer + wrt, bs - wrt, val->f, 1);
             }
             else
             {
-                // e.g. "%.42lfd" or "%.0lf.d"
-                asnprintf(fmtstr, 8, "%%#.%dlfd", prec);
-                wrt = asnprintf(buffer, bs, fmtstr, val->d);
-                if(opt->lossless)
-                    wrt += asnprintf(buffer + wrt, bs - wrt,
-                                     " (%la)", val->d);
+                // e.g. "42.00d" or "1.d"
+                wrt = print_fixed(buffer, bs, val->d, prec);
+                wrt = append_char(buffer, bs, wrt, 'd');
+                if(opt->lossless && wrt < bs)
+                    wrt += print_lossless(buffer + wrt, bs - wrt, val->d, 0);
             }
             break;
         }
@@ -566,7 +623,7 @@ size_t rtosc_print_arg_val(const rtosc_arg_val_t *arg,
             break;
         }
         case 'i':
-            wrt = asnprintf(buffer, bs, "%"PRId32, val->i);
+            wrt = fast_print_int64(buffer, bs, val->i);
             break;
         case 'm':
             wrt = asnprintf(buffer, bs, "MIDI [0x%02x 0x%02x 0x%02x 0x%02x]",
@@ -779,6 +836,39 @@ static void skip_while(const char** s, int (*property)(int))
     for(;**s && (*property)(**s);++*s);
 }
 
+/**
+ * Behave like sscanf(), but only let sscanf() see the beginning of @p src
+ *
+ * sscanf() computes the length of its input, which makes scanning a large
+ * savefile quadratic. Each format in this file consumes only a few tokens,
+ * so a copy of @p src up to the first token start behind SSCANF_WINDOW bytes
+ * yields the same result.
+ */
+#define SSCANF_WINDOW 256
+static int bounded_sscanf(const char* src, const char* fmt, ...)
+{
+    char window[SSCANF_WINDOW * 4];
+    size_t len = 0;
+    for(; len < SSCANF_WINDOW && src[len]; ++len) ;
+    for(; src[len] && len < sizeof(window) - 1 &&
+          !(isspace(src[len-1]) && !isspace(src[len])); ++len) ;
+
+    // copy only if src is too long, and if the token boundary was found
+    const char* input = src;
+    if(src[len] && len < sizeof(window) - 1)
+    {
+        memcpy(window, src, len);
+        window[len] = 0;
+        input = window;
+    }
+
+    va_list ap;
+    va_start(ap, fmt);
+    int res = vsscanf(input, fmt, ap);
+    va_end(ap);
+    return res;
+}
+
 /**
  * Parse the string pointed to by @p src conforming to the format string @p
  * @param src Pointer to the input string
@@ -790,7 +880,7 @@ static int skip_fmt(const char** src, const char* fmt)
 {
     assert(!strncmp(fmt + strlen(fmt) - 2, "%n", 2));
     int rd = 0;
-    sscanf(*src, fmt, &rd);
+    bounded_sscanf(*src, fmt, &rd);
     *src += rd;
     return rd;
 }
@@ -812,7 +902,7 @@ static const char* try_fmt(const char* src, int exp, const char* fmt,
                            char* typesrc, char type)
 {
     int rd = 0;
-    sscanf(src, fmt, &rd);
+    bounded_sscanf(src, fmt, &rd);
     if(rd == exp)
     {
         *typesrc = type;
@@ -1128,7 +1218,7 @@ const char* rtosc_skip_next_printed_arg(const char* src, int* skipped,
         case '\'':
         {
             int esc = -1;
-            if(strlen(src) < 3)
+            if(!src[0] || !src[1] || !src[2])
                 return NULL;
             // type 1: '<noslash>' => normal char
             // type 2: '\<noquote>' => escaped char
@@ -1215,7 +1305,7 @@ const char* rtosc_skip_next_printed_arg(const char* src, int* skipped,
             {
                 *type = 'b';
                 int rd = 0, blobsize = 0;
-                sscanf(src, "%i %n", &blobsize, &rd);
+                bounded_sscanf(src, "%i %n", &blobsize, &rd);
                 src = rd ? (src + rd) : NULL;
                 for(;src && *src == '0';) // i.e. 0x...
                 {
@@ -1270,7 +1360,7 @@ const char* rtosc_skip_next_printed_arg(const char* src, int* skipped,
                         if(skip_fmt(&src, "%*xp%n"))
                         {
                             int rd = 0, expm;
-                            sscanf(src, "-%d s )%n", &expm, &rd);
+                            bounded_sscanf(src, "-%d s )%n", &expm, &rd);
                             if(rd && expm > 0 && expm <= 32)
                             {
                                 // ok
@@ -1558,6 +1648,7 @@ size_t rtosc_scan_arg_val(const char* src,
                           size_t args_before, int follow_ellipsis)
 {
     int rd = 0;
+    int range_multiplier = 0;
     const char* start = src;
     assert(nargs);
     --nargs;
@@ -1595,7 +1686,7 @@ size_t rtosc_scan_arg_val(const char* src,
         case '#':
         {
             arg->type = 'r';
-            sscanf(++src, "%x", &arg->val.i);
+            bounded_sscanf(++src, "%x", &arg->val.i);
             src+=8;
             break;
         }
@@ -1662,9 +1753,9 @@ size_t rtosc_scan_arg_val(const char* src,
             {
                 arg->type = 'm';
                 int32_t tmp[4];
-                sscanf(src, "MIDI [ 0x%"PRIx32" 0x%"PRIx32
-                                  " 0x%"PRIx32" 0x%"PRIx32" ]%n",
-                       tmp, tmp + 1, tmp + 2, tmp + 3, &rd); src+=rd;
+                bounded_sscanf(src, "MIDI [ 0x%"PRIx32" 0x%"PRIx32
+                                          " 0x%"PRIx32" 0x%"PRIx32" ]%n",
+                               tmp, tmp + 1, tmp + 2, tmp + 3, &rd); src+=rd;
                 for(size_t i = 0; i < 4; ++i)
                     arg->val.m[i] = tmp[i]; // copy to 8 bit array
             }
@@ -1714,7 +1805,7 @@ size_t rtosc_scan_arg_val(const char* src,
         case 'B': // blob
         {
             arg->type = 'b';
-            sscanf(src, "BLOB [ %"PRIi32" %n", &arg->val.b.len, &rd);
+            bounded_sscanf(src, "BLOB [ %"PRIi32" %n", &arg->val.b.len, &rd);
             if(rd)
             {
                 src +=rd;
@@ -1726,7 +1817,7 @@ size_t rtosc_scan_arg_val(const char* src,
                 {
                     int32_t tmp;
                     int rd;
-                    sscanf(src, "0x%x %n", &tmp, &rd);
+                    bounded_sscanf(src, "0x%x %n", &tmp, &rd);
                     arg->val.b.data[i] = tmp;
                     src+=rd;
                 }
@@ -1743,7 +1834,8 @@ size_t rtosc_scan_arg_val(const char* src,
             {
                 // collect information for range_arg
                 int multiplier, rd = 0;
-                sscanf(src, "%dx%n", &multiplier, &rd);
+                bounded_sscanf(src, "%dx%n", &multiplier, &rd);
+                range_multiplier = 1;
                 src += rd;
                 arg->type = '-';
                 rtosc_av_rep_num_set(arg, multiplier);
@@ -1787,18 +1879,19 @@ size_t rtosc_scan_arg_val(const char* src,
                 m_tm.tm_hour = 0;
                 m_tm.tm_min = 0;
                 m_tm.tm_sec = 0;
-                sscanf(src, "%4d-%2d-%2d%n",
-                       &m_tm.tm_year, &m_tm.tm_mon, &m_tm.tm_mday, &rd);
+                bounded_sscanf(src, "%4d-%2d-%2d%n",
+                               &m_tm.tm_year, &m_tm.tm_mon, &m_tm.tm_mday, &rd);
                 src+=rd;
                 float secfracsf;
 
                 rd = 0;
-                sscanf(src, " %2d:%2d%n", &m_tm.tm_hour, &m_tm.tm_min, &rd);
+                bounded_sscanf(src, " %2d:%2d%n",
+                               &m_tm.tm_hour, &m_tm.tm_min, &rd);
                 if(rd)
                  src+=rd;
 
                 rd = 0;
-                sscanf(src, ":%2d%n", &m_tm.tm_sec, &rd);
+                bounded_sscanf(src, ":%2d%n", &m_tm.tm_sec, &rd);
                 if(rd)
                  src+=rd;
 
@@ -1808,15 +1901,15 @@ size_t rtosc_scan_arg_val(const char* src,
                 //  => take it directly from there
                 if(skip_fmt(&src, "%*f (%n"))
                 {
-                    sscanf(src, " ... + 0x%8"PRIx64"p-32 s )%n",
-                           &secfracs, &rd);
+                    bounded_sscanf(src, " ... + 0x%8"PRIx64"p-32 s )%n",
+                                   &secfracs, &rd);
                     src += rd;
                 }
                 // float number, but not lossless?
                 //  => convert it to fractions of seconds
                 else if(*src == '.')
                 {
-                    sscanf(src, "%f%n", &secfracsf, &rd);
+                    bounded_sscanf(src, "%f%n", &secfracsf, &rd);
                     src += rd;
 
                     secfracs = rtosc_float2secfracs(secfracsf);
@@ -1846,17 +1939,24 @@ size_t rtosc_scan_arg_val(const char* src,
                                                            &type);
                     if(!arg->type) // the first occurrence determines the type
                      arg->type = type;
+                    else if(arg->type == 'd')
+                    {
+                        // the lossless part has no 'd' suffix, but it
+                        // must be read into the double
+                        fmtstr = "%lf%n";
+                        type = 'd';
+                    }
 
                     switch(type)
                     {
                         case 'h':
-                            sscanf(src, fmtstr, &arg->val.h, &rd); break;
+                            bounded_sscanf(src, fmtstr, &arg->val.h, &rd); break;
                         case 'i':
-                            sscanf(src, fmtstr, &arg->val.i, &rd); break;
+                            bounded_sscanf(src, fmtstr, &arg->val.i, &rd); break;
                         case 'f':
-                            sscanf(src, fmtstr, &arg->val.f, &rd); break;
+                            bounded_sscanf(src, fmtstr, &arg->val.f, &rd); break;
                         case 'd':
-                            sscanf(src, fmtstr, &arg->val.d, &rd); break;
+                            bounded_sscanf(src, fmtstr, &arg->val.d, &rd); break;
                     }
                     src += rd;
 
@@ -1893,6 +1993,11 @@ size_t rtosc_scan_arg_val(const char* src,
         rtosc_arg_val_t delta, rhs;
         size_t zero;
 
+        // a range as lhs, e.g. "2x1 ... 5", which the syntax check accepts
+        // (arg already points behind the range)
+        if(range_multiplier)
+            return 0;
+
         // lhsarg has already been read
         rtosc_arg_val_t lhsarg = *arg;
 
@@ -1944,7 +2049,8 @@ size_t rtosc_scan_arg_val(const char* src,
                                       infinite_range ? NULL : &rhs,
                                       &delta, llhsarg_is_useless);
 
-            assert(infinite_range || num > 0);
+            if(!infinite_range && num <= 0)
+                return 0;
             if(infinite_range && num == -1)
             {
                 has_delta = false;
@@ -1963,15 +2069,21 @@ size_t rtosc_scan_arg_vals(const char* src,
 {
     size_t last_bufsize;
     size_t rd=0;
+    size_t recent_length = 0; // length of the previous arg val
     for(size_t i = 0; i < n; )
     {
         last_bufsize = bufsize;
 
+        // the value before a range is never taken from inside an array
+        size_t before = (i && (args - recent_length)->type == 'a')
+                        ? 0 : i;
         size_t tmp = rtosc_scan_arg_val(src, args, n-i,
-                                        buffer_for_strings, &bufsize, i, 1);
+                                        buffer_for_strings, &bufsize, before,
+                                        1);
         src += tmp;
         rd += tmp;
         size_t length = next_arg_offset(args);
+        recent_length = length;
         i += length;
         args += length;
 
@@ -1988,6 +2100,17 @@ size_t rtosc_scan_arg_vals(const char* src,
     return rd;
 }
 
+size_t rtosc_scan_arg_vals_arena(const char* src,
+                                 rtosc_arg_val_t *args, size_t n,
+                                 rtosc_arena_t* arena)
+{
+    // scanned strings and blobs are never longer than
+    // their printed form (+1 for the terminating zero)
+    size_t bufsize = strlen(src) + 1;
+    char* strbuf = rtosc_arena_alloc(arena, bufsize);
+    return strbuf ? rtosc_scan_arg_vals(src, args, n, strbuf, bufsize) : 0;
+}
+
 size_t rtosc_scan_message(const char* src,
                           char* address, size_t adrsize,
                           rtosc_arg_val_t *args, size_t n,
@@ -2011,3 +2134,555 @@ size_t rtosc_scan_message(const char* src,
     return rd;
 }
 
+
+/*
+    single pass scanner
+*/
+
+//! skip whitespace and comments, like rtosc_count_printed_arg_vals() does
+static void skip_space_and_comments(const char** src)
+{
+    for(;;)
+    {
+        skip_while(src, isspace);
+        if(**src != '%')
+            break;
+        for(; **src && **src != '\n'; ++*src) ;
+    }
+}
+
+//! return true if an ellipsis follows (after optional whitespace)
+static int ellipsis_follows(const char* src)
+{
+    skip_while(&src, isspace);
+    return !strncmp(src, "...", 3);
+}
+
+//! return true if @p c terminates a number, like in scanf_fmtstr()
+static int ends_numeric(char c)
+{
+    return !c || isspace(c) || c == ')' || c == ']';
+}
+
+static int hexdigit_value(char c)
+{
+    return isdigit(c) ? (c - '0') : (tolower(c) - 'a' + 10);
+}
+
+/**
+ * Scan a hex float like "-0x1.8p+0" exactly, as far as possible without
+ * strtod()
+ * @param as_double Whether to store the result into @p arg as 'd' or 'f'
+ * @return The position after the number, or NULL if the syntax is not simple
+ */
+static const char* scan_simple_hexfloat(const char* src,
+                                        rtosc_arg_val_t* arg, int as_double)
+{
+    const char* s = src;
+    int negative = (*s == '-');
+    if(*s == '-' || *s == '+')
+        ++s;
+    if(s[0] != '0' || (s[1] != 'x' && s[1] != 'X'))
+        return NULL;
+    s += 2;
+
+    uint64_t mant = 0;
+    int sig = 0, exp2 = 0, ndigits = 0, exact = 1;
+    for(int frac = 0; ; ++s)
+    {
+        if(*s == '.' && !frac) {
+            frac = 1;
+            continue;
+        }
+        if(!isxdigit(*s))
+            break;
+        ++ndigits;
+        int d = hexdigit_value(*s);
+        if(mant || d)
+        {
+            if(sig < 15) {
+                mant = (mant << 4) | (uint64_t)d;
+                ++sig;
+            }
+            else {
+                // too many digits for exact conversion
+                exact = 0;
+                exp2 += 4;
+            }
+        }
+        if(frac)
+            exp2 -= 4;
+    }
+    if(!ndigits || (*s != 'p' && *s != 'P'))
+        return NULL;
+    ++s;
+    int exp_negative = (*s == '-');
+    if(*s == '-' || *s == '+')
+        ++s;
+    if(!isdigit(*s))
+        return NULL;
+    int exp = 0;
+    for(; isdigit(*s); ++s)
+        if(exp < 100000)
+            exp = exp * 10 + (*s - '0');
+    if(!ends_numeric(*s))
+        return NULL;
+    exp2 += exp_negative ? -exp : exp;
+
+    // can ldexp compute it exactly (mantissa fits, result is normal)?
+    int mant_bits = 0;
+    for(uint64_t m = mant; m; m >>= 1)
+        ++mant_bits;
+    int max_bits = as_double ? 53 : 24;
+    int min_exp = as_double ? -1021 : -125,
+        max_exp = as_double ? 1024 : 128;
+    int res_exp = mant_bits + exp2; // value is in [2^(res_exp-1), 2^res_exp)
+    if(exact && (!mant || (mant_bits <= max_bits &&
+                           res_exp >= min_exp && res_exp <= max_exp)))
+    {
+        double d = ldexp((double)mant, mant ? exp2 : 0);
+        if(negative)
+            d = -d;
+        if(as_double)
+            arg->val.d = d;
+        else
+            arg->val.f = (float)d;
+    }
+    else if(as_double)
+        arg->val.d = strtod(src, NULL);
+    else
+        arg->val.f = strtof(src, NULL);
+    return s;
+}
+
+/**
+ * Try to scan a simple numeric value in a single pass, e.g. "42", "-7h",
+ * "1.5f" or "0.50 (0x1p-1)"
+ *
+ * The result is the same as in rtosc_scan_arg_val().
+ *
+ * @return The position after the value, or NULL if the value is not simple
+ *   (this is no syntax error, the caller must then use the generic scanner)
+ */
+static const char* scan_simple_numeric(const char* src, rtosc_arg_val_t* arg)
+{
+    const char* s = src;
+    int negative = (*s == '-');
+    if(*s == '-' || *s == '+')
+        ++s;
+    // leading zeroes mean octal or hex numbers for some formats
+    if(*s == '0' && (isdigit(s[1]) || s[1] == 'x' || s[1] == 'X'))
+        return NULL;
+
+    // src = mant * 10^exp10
+    uint64_t mant = 0;
+    int sig = 0, exp10 = 0, ndigits = 0, is_float = 0;
+    for(int frac = 0; ; ++s)
+    {
+        if(*s == '.' && !frac) {
+            frac = is_float = 1;
+            continue;
+        }
+        if(!isdigit(*s))
+            break;
+        ++ndigits;
+        int d = *s - '0';
+        if(mant || d)
+        {
+            if(sig == 19)
+                return NULL; // too many digits for our mantissa
+            mant = mant * 10 + (uint64_t)d;
+            ++sig;
+        }
+        if(frac)
+            --exp10;
+    }
+    if(!ndigits)
+        return NULL;
+    if(*s == 'e' || *s == 'E')
+    {
+        is_float = 1;
+        ++s;
+        int exp_negative = (*s == '-');
+        if(*s == '-' || *s == '+')
+            ++s;
+        if(!isdigit(*s))
+            return NULL;
+        int exp = 0;
+        for(; isdigit(*s); ++s)
+            if(exp < 100000)
+                exp = exp * 10 + (*s - '0');
+        exp10 += exp_negative ? -exp : exp;
+    }
+
+    // suffix, in the order of scanf_fmtstr()
+    char type;
+    if(!is_float && (*s == 'h' || *s == 'i'))
+        type = *s++;
+    else if(*s == 'd' || *s == 'f')
+        type = *s++;
+    else
+        type = is_float ? 'f' : 'i';
+
+    if(!ends_numeric(*s) || ellipsis_follows(s))
+        return NULL;
+
+    arg->type = type;
+    switch(type)
+    {
+        case 'h':
+            // 19 decimal digits always fit, except for 9223372036854775808
+            if(mant > (uint64_t)INT64_MAX)
+                return NULL;
+            arg->val.h = negative ? -(int64_t)mant : (int64_t)mant;
+            break;
+        case 'i':
+            if(mant > (uint64_t)INT32_MAX + negative)
+                return NULL; // overflow behavior is up to scanf
+            arg->val.i = negative ? (int32_t)(0 - mant) : (int32_t)mant;
+            break;
+        case 'f':
+        {
+            // exact if both operands are exact (Clinger's fast path)
+            static const float pow10f[] = { 1e0f, 1e1f, 1e2f, 1e3f, 1e4f,
+                                            1e5f, 1e6f, 1e7f, 1e8f, 1e9f,
+                                            1e10f };
+#if FLT_EVAL_METHOD == 0
+            if(mant <= (UINT64_C(1) << 24) && exp10 >= -10 && exp10 <= 10)
+            {
+                float f = (float)mant;
+                f = (exp10 < 0) ? (f / pow10f[-exp10]) : (f * pow10f[exp10]);
+                arg->val.f = negative ? -f : f;
+            }
+            else
+#endif
+                arg->val.f = strtof(src, NULL);
+            (void)pow10f;
+            break;
+        }
+        case 'd':
+        {
+            static const double pow10[] = { 1e0, 1e1, 1e2, 1e3, 1e4, 1e5,
+                                            1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+                                            1e12, 1e13, 1e14, 1e15, 1e16,
+                                            1e17, 1e18, 1e19, 1e20, 1e21,
+                                            1e22 };
+#if FLT_EVAL_METHOD == 0
+            if(mant <= (UINT64_C(1) << 53) && exp10 >= -22 && exp10 <= 22)
+            {
+                double d = (double)mant;
+                d = (exp10 < 0) ? (d / pow10[-exp10]) : (d * pow10[exp10]);
+                arg->val.d = negative ? -d : d;
+            }
+            else
+#endif
+                arg->val.d = strtod(src, NULL);
+            (void)pow10;
+            break;
+        }
+    }
+
+    // is a lossless part appended in parentheses?
+    const char* after_num = s;
+    skip_while(&after_num, isspace);
+    if(*after_num == '(')
+    {
+        if(type != 'f' && type != 'd')
+            return NULL;
+        ++after_num;
+        skip_while(&after_num, isspace);
+        s = scan_simple_hexfloat(after_num, arg, type == 'd');
+        if(!s)
+            return NULL;
+        skip_while(&s, isspace);
+        if(*s != ')')
+            return NULL;
+        ++s;
+        if(ellipsis_follows(s))
+            return NULL;
+    }
+    return s;
+}
+
+/**
+ * Try to scan a simple string in a single pass, e.g. "\"abc\"" or
+ * "\"a\"\\\n    \"bc\"S"
+ * @return The position after the string, or NULL if the value is not simple
+ *   (this is no syntax error, the caller must then use the generic scanner)
+ */
+static const char* scan_simple_string(const char* src, rtosc_arg_val_t* arg,
+                                      rtosc_arena_t* arena)
+{
+    // first, validate and measure (the output is never longer than the input)
+    const char* end = end_of_printed_string(src);
+    if(!end)
+        return NULL;
+    char* dest = rtosc_arena_alloc(arena, end - src);
+    if(!dest)
+        return NULL;
+    arg->val.s = dest;
+
+    for(++src; ; )
+    {
+        if(*src == '"')
+        {
+            if(src[1] != '\\')
+                break;
+            // continuation, like "\"\\ \""
+            src += 2;
+            skip_while(&src, isspace);
+            assert(*src == '"'); // checked by end_of_printed_string()
+            ++src;
+        }
+        else if(*src == '\\') {
+            *dest++ = get_escaped_char(src[1], false);
+            src += 2;
+        }
+        else
+            *dest++ = *src++;
+    }
+    *dest = 0;
+    ++src; // skip final '"'
+
+    if(*src == 'S') {
+        ++src;
+        arg->type = 'S';
+    }
+    else
+        arg->type = 's';
+    return ellipsis_follows(src) ? NULL : src;
+}
+
+/**
+ * Try to scan a simple keyword or identifier in a single pass,
+ * e.g. "true", "nil" or "an_identifier"
+ * @return The position after the value, or NULL if the value is not simple
+ *   (this is no syntax error, the caller must then use the generic scanner)
+ */
+static const char* scan_simple_word(const char* src, rtosc_arg_val_t* arg,
+                                    rtosc_arena_t* arena)
+{
+    const char* s = src;
+    if(skip_word("true", &s) || skip_word("false", &s))
+    {
+        arg->type = toupper(*src);
+        arg->val.T = (*src == 't');
+    }
+    else if(skip_word("nil", &s) || skip_word("inf", &s))
+        arg->type = toupper(*src);
+    else if(!strncmp(src, "now", 3) || !strncmp(src, "immediately", 11) ||
+            !strncmp(src, "MIDI", 4) || !strncmp(src, "BLOB", 4))
+        return NULL; // timestamp, MIDI or blob, or an identifier
+    else
+    {
+        s = skip_identifier(src);
+        if(!s)
+            return NULL;
+        char* dest = rtosc_arena_alloc(arena, s - src + 1);
+        if(!dest)
+            return NULL;
+        memcpy(dest, src, s - src);
+        dest[s - src] = 0;
+        arg->type = 'S';
+        arg->val.s = dest;
+    }
+    return ellipsis_follows(s) ? NULL : s;
+}
+
+/**
+ * Make sure that @p *av, allocated from @p arena, has space for @p needed arg
+ * vals
+ * @return 1 on success, 0 if malloc failed
+ */
+static int reserve_arg_vals(rtosc_arena_t* arena, rtosc_arg_val_t** av,
+                            size_t* capacity, size_t needed)
+{
+    if(needed > *capacity)
+    {
+        size_t new_capacity = *capacity ? (*capacity * 2) : 8;
+        if(new_capacity < needed)
+            new_capacity = needed;
+        *av = rtosc_arena_grow(arena, *av, *capacity * sizeof(rtosc_arg_val_t),
+                               new_capacity * sizeof(rtosc_arg_val_t));
+        if(!*av)
+            return 0;
+        *capacity = new_capacity;
+    }
+    return 1;
+}
+
+/**
+ * Try to scan a simple value (no array) in a single pass
+ * @return The position after the value, or NULL if the value is not simple
+ *   (this is no syntax error, the caller must then use the generic scanner)
+ */
+static const char* scan_simple_value(const char* src, rtosc_arg_val_t* arg,
+                                     rtosc_arena_t* arena)
+{
+    switch(*src)
+    {
+        case '"':
+            return scan_simple_string(src, arg, arena);
+        case '+': case '-': case '.':
+        case '0': case '1': case '2': case '3': case '4':
+        case '5': case '6': case '7': case '8': case '9':
+            return scan_simple_numeric(src, arg);
+        default:
+            return (*src == '_' || isalpha(*src))
+                   ? scan_simple_word(src, arg, arena)
+                   : NULL;
+    }
+}
+
+/**
+ * Try to scan an array of simple values in a single pass, e.g. "[1 2 3]"
+ *
+ * The array is appended to @p *av at position @p n, growing @p *av if
+ * required.
+ *
+ * @return The position after the array, or NULL if the array is not simple
+ *   (this is no syntax error, the caller must then use the generic scanner)
+ */
+static const char* scan_simple_array(const char* src, rtosc_arg_val_t** av,
+                                     size_t* capacity, size_t n,
+                                     rtosc_arena_t* arena)
+{
+    assert(*src == '[');
+    ++src;
+    skip_while(&src, isspace);
+
+    size_t start = n++;
+    char arrtype = ' ';
+    for(; *src != ']'; ++n)
+    {
+        if(!reserve_arg_vals(arena, av, capacity, n + 1))
+            return NULL;
+        src = scan_simple_value(src, *av + n, arena);
+        if(!src)
+            return NULL;
+        char cur = (*av)[n].type;
+        if(arrtype != ' ' && !types_match(arrtype, cur))
+            return NULL; // let the generic scanner report the error
+        arrtype = cur;
+        skip_while(&src, isspace);
+    }
+    ++src; // ']'
+
+    rtosc_arg_val_t* header = *av + start;
+    header->type = 'a';
+    rtosc_av_arr_type_set(header, arrtype);
+    rtosc_av_arr_len_set(header, (int32_t)(n - start - 1));
+    return ellipsis_follows(src) ? NULL : src;
+}
+
+int rtosc_scan_message_arena(const char* src,
+                             const char** address,
+                             rtosc_arg_val_t** args, size_t* nargs,
+                             rtosc_arena_t* arena)
+{
+    const char* start = src;
+    skip_space_and_comments(&src);
+    if(!*src)
+        return INT_MIN;
+    if(*src != '/')
+        return -1;
+
+    const char* adr_end = src;
+    for(; *adr_end && !isspace(*adr_end); ++adr_end) ;
+    char* adr = rtosc_arena_alloc(arena, adr_end - src + 1);
+    if(!adr)
+        return -1;
+    memcpy(adr, src, adr_end - src);
+    adr[adr_end - src] = 0;
+    *address = adr;
+    src = adr_end;
+    skip_space_and_comments(&src);
+
+    size_t n = 0, capacity = 0;
+    rtosc_arg_val_t* av = NULL;
+    const char* args_src = src;
+    const char* recent_src = NULL;
+    size_t recent_n = 0; // position of the arg val of recent_src
+    int syntax_checked = 0;
+    while(*src && *src != '/')
+    {
+        // make sure there is space for the most common case (one arg val)
+        if(!reserve_arg_vals(arena, &av, &capacity, n + 1))
+            return -(int)n-1;
+
+        // fast path: only one pass
+        const char* newsrc;
+        size_t scanned = 1, n_before = n;
+        if(*src == '[')
+        {
+            newsrc = scan_simple_array(src, &av, &capacity, n, arena);
+            if(newsrc)
+                scanned = rtosc_av_arr_len(av + n) + 1;
+        }
+        else
+            newsrc = scan_simple_value(src, av + n, arena);
+
+        if(newsrc)
+            n += scanned;
+        else
+        {
+            // generic path: check syntax, then scan
+            // like the two pass scanner, check the syntax of all args
+            // before scanning any of them
+            if(!syntax_checked)
+            {
+                int counted = rtosc_count_printed_arg_vals(args_src);
+                if(counted < 0)
+                    return counted;
+                syntax_checked = 1;
+            }
+            int skipped;
+            newsrc = rtosc_skip_next_printed_arg(src, &skipped, NULL,
+                                                 recent_src, 1, 0);
+            if(!newsrc)
+                return -(int)n-skipped;
+            if(!reserve_arg_vals(arena, &av, &capacity, n + skipped))
+                return -(int)n-skipped;
+
+            // scan a copy of only the checked part, so the scanner can not
+            // read further; scanned strings and blobs are never longer than
+            // their printed form (+1 for the terminating zero)
+            size_t len = newsrc - src, bufsize = len + 1;
+            char small_copy[256];
+            char* copy = (bufsize <= sizeof(small_copy)) ? small_copy
+                                                         : malloc(bufsize);
+            char* strbuf = rtosc_arena_alloc(arena, bufsize);
+            if(!copy || !strbuf)
+            {
+                if(copy != small_copy)
+                    free(copy);
+                return -(int)n-skipped;
+            }
+            memcpy(copy, src, len);
+            copy[len] = 0;
+            // the value before a range is never taken from inside an array
+            size_t before = (n && av[recent_n].type == 'a') ? 0 : n;
+            size_t rd = rtosc_scan_arg_val(copy, av + n, skipped,
+                                           strbuf, &bufsize, before, 1);
+            if(copy != small_copy)
+                free(copy);
+            // the syntax check and the scanner disagree: report the error
+            // at the argument where the syntax check continues
+            if(rd != len)
+            {
+                int counted = rtosc_count_printed_arg_vals(src);
+                return (counted < 0) ? -(int)n+counted : -(int)(n+skipped)-1;
+            }
+            n += skipped;
+        }
+
+        recent_src = src;
+        recent_n = n_before;
+        src = newsrc;
+        skip_space_and_comments(&src);
+    }
+
+    *args = av;
+    *nargs = n;
+    return (int)(src - start);
+}
@@ -34,6 +34,7 @@
 #include <rtosc/arg-ext.h>
 #include <rtosc/arg-val-cmp.h>
 #include <rtosc/arg-val-itr.h>
+#include <rtosc/arg-val-math.h>
 #include <rtosc/pretty-format.h>
 #include <rtosc/bundle-foreach.h>
 #include <rtosc/ports.h>
@@ -46,6 +47,14 @@ namespace rtosc {
 namespace {
     constexpr std::size_t buffersize = 32768;
     constexpr size_t max_arg_vals = 2048;
+
+    //! RAII wrapper for an arena of buffersize bytes per block
+    struct arena_guard_t
+    {
+        rtosc_arena_t arena;
+        arena_guard_t() { rtosc_arena_init(&arena, buffersize); }
+        ~arena_guard_t() { rtosc_arena_destroy(&arena); }
+    };
 }
 
 int rtosc_arg_val_size(char type)
@@ -120,6 +129,8 @@ std::string get_changed_values(const Ports& ports, void* runtime,
         std::string res;
         std::set<std::string> written;
         const std::vector<std::string>* propsToExclude;
+        // strings and blobs of the current port, reset for each port
+        arena_guard_t arena_guard;
     } data;
     std::swap(data.written, alreadyWritten);
     data.propsToExclude = &propsToExclude;
@@ -189,7 +200,8 @@ std::string get_changed_values(const Ports& ports, void* runtime,
         rtosc_arg_val_t arg_vals_runtime[max_arg_vals];
         // buffer to hold the message (i.e. /port ..., without port's bases)
         char buffer_with_port[buffersize];
-        char strbuf[buffersize]; // temporary string buffer for pretty-printing
+        rtosc_arena_t* arena = &((data_t*)data)->arena_guard.arena;
+        rtosc_arena_reset(arena);
 
         std::string* res = &((data_t*)data)->res;
         assert(strlen(port_buffer) + 1 < buffersize);
@@ -220,13 +232,11 @@ std::string get_changed_values(const Ports& ports, void* runtime,
                                               p,
                                               max_arg_vals,
                                               arg_vals_default,
-                                              strbuf,
-                                              buffersize);
+                                              arena);
 
         if(nargs_default > 0)
         {
             size_t nargs_runtime = 0;
-            std::vector<std::vector<char> > scratch_bufs;
 
             auto ftor = [&](const Port* p, const char* ,
                             const char* old_end,
@@ -258,7 +268,7 @@ std::string get_changed_values(const Ports& ports, void* runtime,
                                                     max_arg_vals,
                                                     arg_vals_runtime +
                                                         nargs_runtime,
-                                                    &scratch_bufs);
+                                                    arena);
                 nargs_runtime += nargs_runtime_cur;
             };
 
@@ -466,7 +476,6 @@ struct message_t
     std::string portname;
     std::vector<rtosc_arg_val_t> arg_vals;
     std::vector<std::size_t> dependees;
-    std::vector<char> strbuf;
 };
 
 void scan_deps(const std::string& orig_portname, std::string cur_portname,
@@ -525,6 +534,7 @@ int dispatch_printed_messages(const char* messages,
 {
     constexpr std::size_t buffersize = 8192;
     char messagebuf[buffersize];
+    std::vector<char> large_messagebuf;
     int rd, rd_total = 0;
     int nargs;
     int msgs_read = 0;
@@ -539,31 +549,32 @@ int dispatch_printed_messages(const char* messages,
     std::vector<message_t> message_v;
     std::map<std::string, message_t*> message_map;
 
+    // holds all scanned strings and blobs until the messages are dispatched
+    arena_guard_t arena_guard;
+
     {
         msgs_read = 0;
         rd_total = 0;
         const char* msg_ptr = messages;
         while(*msg_ptr && ok)
         {
-            nargs = rtosc_count_printed_arg_vals_of_msg(msg_ptr);
-            if(nargs >= 0)
+            const char* portname;
+            rtosc_arg_val_t* arg_vals;
+            size_t nargs_scanned;
+            rd = rtosc_scan_message_arena(msg_ptr, &portname,
+                                          &arg_vals, &nargs_scanned,
+                                          &arena_guard.arena);
+            if(rd > 0)
             {
                 message_t m;
-                m.arg_vals.resize(nargs);
-                std::vector<char> portname_v;
-                portname_v.resize(buffersize);
-
-                m.strbuf.resize(buffersize);
-                rd = rtosc_scan_message(msg_ptr, portname_v.data(), buffersize,
-                                        m.arg_vals.data(), nargs, m.strbuf.data(), buffersize);
-
-                m.portname = portname_v.data();
+                m.arg_vals.assign(arg_vals, arg_vals + nargs_scanned);
+                m.portname = portname;
                 rd_total += rd;
                 message_v.emplace_back(std::move(m));
                 msg_ptr += rd;
                 ++msgs_read;
             }
-            else if(nargs == std::numeric_limits<int>::min())
+            else if(rd == std::numeric_limits<int>::min())
             {
                 // this means the (rest of the) file is whitespace only
                 // => don't increase msgs_read
@@ -692,33 +703,36 @@ int dispatch_printed_messages(const char* messages,
                     // convert array from savefile into blob
                     rtosc_arg_val_t* av0 = message.arg_vals.data();
                     int32_t len = rtosc_av_arr_len(av0);
-                    rtosc_arg_t last_arg;
-                    int32_t j = 0, todo = 0;
+                    int32_t j = 0;
                     const char* blob_type = apropos->meta()["blob type"];
                     assert(blob_type); // if this fails, add rBlobType() to port
+                    const int elem_size = rtosc_arg_val_size(blob_type[0]);
                     for(int32_t i = 0; i < len; ++i)
                     {
                         const rtosc_arg_val_t& av = message.arg_vals[1+i];
-                        switch(av.type)
+                        if(av.type == '-')
                         {
-                            case '-':
-                                todo = rtosc_av_rep_num(&av) - 1;
-                                continue;
-                            default:
-                                assert(av.type == blob_type[0]);
-                                last_arg = av.val;
-                                ++todo;
-                                break;
+                            // expand the whole range at once, then skip
+                            // its delta (if any) and its start value
+                            int32_t num = rtosc_av_rep_num(&av);
+                            assert((j + num) * elem_size <= (int32_t)buffersize);
+                            size_t expanded = rtosc_arg_val_range_expand(
+                                &av, 0, num, tmp_memory + j * elem_size);
+                            assert(expanded == (size_t)num);
+                            (void)expanded;
+                            j += num;
+                            i += 1 + !!rtosc_av_rep_has_delta(&av);
+                            continue;
                         }
+                        assert(av.type == blob_type[0]);
+                        assert((j + 1) * elem_size <= (int32_t)buffersize);
                         switch(av.type)
                         {
                             case 'f':
-                                for(; todo>0; --todo)
-                                    ((float*)tmp_memory)[j++] = last_arg.f;
+                                ((float*)tmp_memory)[j++] = av.val.f;
                                 break;
                             case 'i':
-                                for(; todo>0; --todo)
-                                    ((int32_t*)tmp_memory)[j++] = last_arg.i;
+                                ((int32_t*)tmp_memory)[j++] = av.val.i;
                                 break;
                             default:
                                 assert(false);
@@ -805,10 +819,21 @@ int dispatch_printed_messages(const char* messages,
                     if(is_array)
                         snprintf(portname_end, 8, "%d", (int)arr_idx);
 
-                    rtosc_amessage(messagebuf, buffersize, portname,
-                                   argstr, vals);
+                    const char* msg = messagebuf;
+                    if(!rtosc_amessage(messagebuf, buffersize, portname,
+                                       argstr, vals))
+                    {
+                        // e.g. large blobs, which do not fit the stack
+                        // (loading is not realtime, so the heap is fine)
+                        large_messagebuf.resize(rtosc_amessage(
+                            nullptr, 0, portname, argstr, vals));
+                        rtosc_amessage(large_messagebuf.data(),
+                                       large_messagebuf.size(), portname,
+                                       argstr, vals);
+                        msg = large_messagebuf.data();
+                    }
 
-                    ok = (*dispatcher)(messagebuf);
+                    ok = (*dispatcher)(msg);
                     //printf("%s, %s, %d -> %s\n", messagebuf, portname, nargs, ok ? "yes": "no");
                 }
             }
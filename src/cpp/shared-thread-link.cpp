@@ -0,0 +1,206 @@
+#include <rtosc/shared-thread-link.h>
+
+#include <atomic>
+#include <cerrno>
+#include <climits>
+#include <cstdint>
+#include <cstring>
+#include <ctime>
+#include <new>
+#include <stdexcept>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#ifdef __linux__
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#endif
+
+using namespace rtosc;
+
+static_assert(ATOMIC_INT_LOCK_FREE == 2 && ATOMIC_LONG_LOCK_FREE == 2,
+              "shared atomics must not need locks");
+
+namespace rtosc {
+//Start of the shared memory, followed by the ringbuffer
+struct shared_header_t
+{
+    std::atomic<uint32_t> magic;
+    uint32_t version;
+    uint64_t max_message_length;
+    uint64_t max_messages;
+    //! Incremented by notify(), waited on by wait()
+    std::atomic<uint32_t> sequence;
+    //! Number of readers in wait()
+    std::atomic<uint32_t> waiters;
+};
+}
+
+constexpr uint32_t shared_magic = 0x7274736c; // "rtsl"
+constexpr uint32_t shared_version = 1;
+//the ringbuffer starts at its own cache line
+constexpr size_t ring_offset = (sizeof(shared_header_t) + 63) / 64 * 64;
+
+[[noreturn]] static void throw_errno(const char *what, const char *name)
+{
+    throw std::runtime_error(std::string(what) + " \"" + name + "\": " +
+                             strerror(errno));
+}
+
+#ifdef __linux__
+static void futex_wait(std::atomic<uint32_t> *addr, uint32_t expected,
+                       int timeout_msecs)
+{
+    timespec ts;
+    ts.tv_sec = timeout_msecs / 1000;
+    ts.tv_nsec = (timeout_msecs % 1000) * 1000000L;
+    syscall(SYS_futex, (uint32_t*)addr, FUTEX_WAIT, expected,
+            timeout_msecs < 0 ? nullptr : &ts, nullptr, 0);
+}
+
+static void futex_wake(std::atomic<uint32_t> *addr)
+{
+    syscall(SYS_futex, (uint32_t*)addr, FUTEX_WAKE, INT_MAX, nullptr,
+            nullptr, 0);
+}
+#endif
+
+SharedThreadLink::mapping_t SharedThreadLink::map(const char *name,
+    bool create, size_t max_message_length, size_t max_messages)
+{
+    mapping_t m;
+    m.created = create;
+    int fd;
+    if(create)
+    {
+        shm_unlink(name); //remove a stale object
+        fd = shm_open(name, O_CREAT | O_EXCL | O_RDWR, 0600);
+        if(fd < 0)
+            throw_errno("can not create", name);
+        m.map_size = ring_offset +
+                     memory_size(max_message_length, max_messages);
+        if(ftruncate(fd, m.map_size) < 0)
+        {
+            int err = errno;
+            close(fd);
+            shm_unlink(name);
+            errno = err;
+            throw_errno("can not resize", name);
+        }
+    }
+    else
+    {
+        fd = shm_open(name, O_RDWR, 0);
+        if(fd < 0)
+            throw_errno("can not open", name);
+        struct stat st;
+        if(fstat(fd, &st) < 0 || (size_t)st.st_size < ring_offset)
+        {
+            close(fd);
+            throw std::runtime_error(std::string("invalid shared memory \"")
+                                     + name + "\"");
+        }
+        m.map_size = st.st_size;
+    }
+
+    void *memory = mmap(nullptr, m.map_size, PROT_READ | PROT_WRITE,
+                        MAP_SHARED, fd, 0);
+    int err = errno;
+    close(fd);
+    if(memory == MAP_FAILED)
+    {
+        if(create)
+            shm_unlink(name);
+        errno = err;
+        throw_errno("can not map", name);
+    }
+
+    if(create)
+    {
+        m.header = new(memory) shared_header_t;
+        m.header->version = shared_version;
+        m.header->max_message_length = max_message_length;
+        m.header->max_messages = max_messages;
+        m.header->sequence = 0;
+        m.header->waiters = 0;
+        //magic is set when the ringbuffer is ready, too
+    }
+    else
+    {
+        m.header = (shared_header_t*)memory;
+        if(m.header->magic.load(std::memory_order_acquire) != shared_magic ||
+           m.header->version != shared_version ||
+           ring_offset + memory_size(m.header->max_message_length,
+                                     m.header->max_messages) > m.map_size)
+        {
+            munmap(memory, m.map_size);
+            throw std::runtime_error(std::string("shared memory \"") + name
+                                     + "\" is not a SharedThreadLink");
+        }
+    }
+    m.max_message_length = m.header->max_message_length;
+    m.max_messages = m.header->max_messages;
+    return m;
+}
+
+SharedThreadLink::SharedThreadLink(const mapping_t &m, const char *name)
+    :ThreadLink(m.max_message_length, m.max_messages,
+                (char*)m.header + ring_offset, m.created),
+    m(m), name(name)
+{
+    if(m.created)
+        m.header->magic.store(shared_magic, std::memory_order_release);
+}
+
+SharedThreadLink::SharedThreadLink(const char *name,
+                                   size_t max_message_length,
+                                   size_t max_messages)
+    :SharedThreadLink(map(name, true, max_message_length, max_messages),
+                      name)
+{
+}
+
+SharedThreadLink::SharedThreadLink(const char *name)
+    :SharedThreadLink(map(name, false, 0, 0), name)
+{
+}
+
+SharedThreadLink::~SharedThreadLink(void)
+{
+    munmap(m.header, m.map_size);
+    if(m.created)
+        shm_unlink(name.c_str());
+}
+
+void SharedThreadLink::notify(void)
+{
+    m.header->sequence.fetch_add(1);
+#ifdef __linux__
+    if(m.header->waiters.load())
+        futex_wake(&m.header->sequence);
+#endif
+}
+
+bool SharedThreadLink::wait(int timeout_msecs)
+{
+    if(hasNext())
+        return true;
+    uint32_t sequence = m.header->sequence.load();
+#ifdef __linux__
+    //register first, so a notify() after the check will wake us up
+    m.header->waiters.fetch_add(1);
+    if(!hasNext())
+        futex_wait(&m.header->sequence, sequence, timeout_msecs);
+    m.header->waiters.fetch_sub(1);
+#else
+    //poll every millisecond
+    timespec ms = {0, 1000000L};
+    for(int waited = 0; !hasNext() &&
+        m.header->sequence.load() == sequence &&
+        (timeout_msecs < 0 || waited < timeout_msecs); ++waited)
+        nanosleep(&ms, nullptr);
+#endif
+    return hasNext();
+}
@@ -0,0 +1,222 @@
+#include <rtosc/state-snapshot.h>
+#include <rtosc/ports.h>
+#include <rtosc/port-sugar.h>
+#include <rtosc/rtosc.h>
+#include <cstdarg>
+#include <cstring>
+#include <cstdint>
+#include <cmath>
+#include <string>
+#include <vector>
+
+using namespace rtosc;
+
+//Storage of one parameter and its place in the image
+struct entry_t
+{
+    char    *ptr;
+    uint32_t offset;
+    uint8_t  size;
+    char     kind; //!< 'f', 'i', 'u' or 'd' (discrete)
+};
+
+//! RtData subclass to capture the storage which a port replies to a probe
+class StorageCapture : public RtData
+{
+    public:
+        void reply(const char *, const char *args, ...) override
+        {
+            if(found || strcmp(args, "bii"))
+                return;
+            va_list va;
+            va_start(va, args);
+            int blen = va_arg(va, int);
+            const uint8_t *blob = va_arg(va, const uint8_t*);
+            size = va_arg(va, int);
+            kind = va_arg(va, int);
+            va_end(va);
+            if(blen == sizeof(void*)) {
+                memcpy(&ptr, blob, sizeof(void*));
+                found = true;
+            }
+        }
+        void reply(const char *) override {}
+        void broadcast(const char *, const char *, ...) override {}
+        void broadcast(const char *) override {}
+
+        bool  found = false;
+        void *ptr   = nullptr;
+        int   size  = 0;
+        int   kind  = 0;
+};
+
+struct rtosc::StateSnapshotImpl
+{
+    std::vector<entry_t>     entries;
+    std::vector<std::string> paths;
+    size_t image_size = 0;
+
+    //running crossfade
+    const char *from = nullptr, *to = nullptr;
+    int blocks = 0, block = 0;
+
+    void clamp(size_t &first, size_t &count) const
+    {
+        if(first > entries.size())
+            first = entries.size();
+        if(count > entries.size() - first)
+            count = entries.size() - first;
+    }
+};
+
+StateSnapshot::StateSnapshot(const Ports &ports, void *object)
+    :impl(new StateSnapshotImpl)
+{
+    struct walk_t
+    {
+        StateSnapshotImpl *impl;
+        const Ports *ports;
+        void *object;
+    } walk = {impl, &ports, object};
+
+    char name[1024];
+    memset(name, 0, sizeof(name));
+    walk_ports(&ports, name, sizeof(name), &walk,
+               [](const Port *p, const char *path, const char*,
+                  const Ports&, void *dat, void*) {
+            if(p->meta().find("parameter") == p->meta().end())
+                return;
+            walk_t &w = *(walk_t*)dat;
+
+            //ask the port for its storage instead of its value
+            char query[1024], loc[1024];
+            if(!rtosc_message(query, sizeof(query), path+1, ""))
+                return;
+            StorageCapture d;
+            strcpy(loc, path);
+            d.loc      = loc;
+            d.loc_size = 0; //the location is already complete
+            d.obj      = w.object;
+            d.message  = storage_probe();
+            w.ports->dispatch(query, d);
+            if(!d.found || d.size <= 0 || d.size > 8)
+                return;
+
+            entry_t e;
+            e.ptr    = (char*)d.ptr;
+            e.size   = d.size;
+            e.kind   = (char)d.kind;
+            e.offset = (uint32_t)w.impl->image_size;
+            w.impl->entries.push_back(e);
+            w.impl->paths.push_back(path);
+            w.impl->image_size += e.size;
+        });
+}
+
+StateSnapshot::~StateSnapshot(void)
+{
+    delete impl;
+}
+
+size_t StateSnapshot::size(void) const
+{
+    return impl->entries.size();
+}
+
+size_t StateSnapshot::image_size(void) const
+{
+    return impl->image_size;
+}
+
+const char *StateSnapshot::path(size_t i) const
+{
+    return i < impl->paths.size() ? impl->paths[i].c_str() : NULL;
+}
+
+void StateSnapshot::capture(char *image, size_t first, size_t count) const
+{
+    impl->clamp(first, count);
+    for(const entry_t *e = impl->entries.data() + first, *end = e + count;
+        e != end; ++e)
+        memcpy(image + e->offset, e->ptr, e->size);
+}
+
+void StateSnapshot::apply(const char *image, size_t first, size_t count)
+{
+    impl->clamp(first, count);
+    for(const entry_t *e = impl->entries.data() + first, *end = e + count;
+        e != end; ++e)
+        memcpy(e->ptr, image + e->offset, e->size);
+}
+
+void StateSnapshot::swap(char *image, size_t first, size_t count)
+{
+    impl->clamp(first, count);
+    char tmp[8];
+    for(const entry_t *e = impl->entries.data() + first, *end = e + count;
+        e != end; ++e) {
+        memcpy(tmp, e->ptr, e->size);
+        memcpy(e->ptr, image + e->offset, e->size);
+        memcpy(image + e->offset, tmp, e->size);
+    }
+}
+
+//interpolate a value of type T, rounding integers
+template<class T>
+static void lerp(char *dst, const char *a, const char *b, float t)
+{
+    T va, vb;
+    memcpy(&va, a, sizeof(T));
+    memcpy(&vb, b, sizeof(T));
+    double v = va + (vb - (double)va) * t;
+    T res = std::is_floating_point<T>::value ? (T)v : (T)std::floor(v + 0.5);
+    memcpy(dst, &res, sizeof(T));
+}
+
+void StateSnapshot::morph(const char *a, const char *b, float t,
+                          size_t first, size_t count)
+{
+    //the end points are exact copies
+    if(t <= 0 || t >= 1) {
+        apply(t <= 0 ? a : b, first, count);
+        return;
+    }
+
+    impl->clamp(first, count);
+    for(const entry_t *e = impl->entries.data() + first, *end = e + count;
+        e != end; ++e) {
+        const char *va = a + e->offset, *vb = b + e->offset;
+        switch(e->kind << 8 | e->size)
+        {
+            case 'f' << 8 | 4: lerp<float>   (e->ptr, va, vb, t); break;
+            case 'f' << 8 | 8: lerp<double>  (e->ptr, va, vb, t); break;
+            case 'i' << 8 | 1: lerp<int8_t>  (e->ptr, va, vb, t); break;
+            case 'i' << 8 | 2: lerp<int16_t> (e->ptr, va, vb, t); break;
+            case 'i' << 8 | 4: lerp<int32_t> (e->ptr, va, vb, t); break;
+            case 'i' << 8 | 8: lerp<int64_t> (e->ptr, va, vb, t); break;
+            case 'u' << 8 | 1: lerp<uint8_t> (e->ptr, va, vb, t); break;
+            case 'u' << 8 | 2: lerp<uint16_t>(e->ptr, va, vb, t); break;
+            case 'u' << 8 | 4: lerp<uint32_t>(e->ptr, va, vb, t); break;
+            case 'u' << 8 | 8: lerp<uint64_t>(e->ptr, va, vb, t); break;
+            default: //toggles, options and unknown types switch
+                memcpy(e->ptr, t < 0.5f ? va : vb, e->size);
+        }
+    }
+}
+
+void StateSnapshot::crossfade(const char *a, const char *b, int blocks)
+{
+    impl->from   = a;
+    impl->to     = b;
+    impl->blocks = blocks < 1 ? 1 : blocks;
+    impl->block  = 0;
+}
+
+bool StateSnapshot::process_block(void)
+{
+    if(impl->block >= impl->blocks)
+        return false;
+    ++impl->block;
+    morph(impl->from, impl->to, impl->block / (float)impl->blocks);
+    return impl->block < impl->blocks;
+}
@@ -0,0 +1,163 @@
+#include <rtosc/subscriptions.h>
+#include <rtosc/rtosc.h>
+#include <algorithm>
+#include <cstring>
+
+using namespace rtosc;
+
+//characters which are not compared verbatim by rtosc_match()
+static const char *special_chars = "{*#:";
+//maximum number of literal patterns an option list is expanded to
+static const size_t max_expansions = 64;
+
+/**
+ * Replace option lists ("{a,b}") which come before any other special
+ * character by each of their options, so the options become part of the
+ * literal prefix, e.g. "/part{0,1}/volume" becomes "/part0/volume" and
+ * "/part1/volume".
+ * @param out Receives the literal patterns, must be empty at first, so the
+ *   limit applies per pattern
+ * @return false if there would be too many expansions
+ */
+static bool expand(const std::string &pattern, std::vector<std::string> &out)
+{
+    size_t open = pattern.find('{');
+    if(open == std::string::npos ||
+       open > strcspn(pattern.c_str(), special_chars + 1)) { //all but '{'
+        out.push_back(pattern);
+        return out.size() <= max_expansions;
+    }
+    size_t close = pattern.find('}', open);
+    if(close == std::string::npos) {
+        out.push_back(pattern);
+        return out.size() <= max_expansions;
+    }
+
+    for(size_t begin = open + 1; begin <= close; )
+    {
+        size_t end = std::min(pattern.find(',', begin), close);
+        if(!expand(pattern.substr(0, open) +
+                   pattern.substr(begin, end - begin) +
+                   pattern.substr(close + 1), out))
+            return false;
+        begin = end + 1;
+    }
+    return true;
+}
+
+SubscriptionRegistry::SubscriptionRegistry(void)
+    : generation(0)
+{
+    compile();
+}
+
+bool SubscriptionRegistry::subscribe(int client, const char *pattern)
+{
+    if(*pattern != '/')
+        return false;
+    for(const pattern_t &p : patterns)
+        if(p.client == client && p.pattern == pattern)
+            return true;
+    patterns.push_back({pattern, client});
+    compile();
+    return true;
+}
+
+bool SubscriptionRegistry::unsubscribe(int client, const char *pattern)
+{
+    auto itr = std::find_if(patterns.begin(), patterns.end(),
+        [&](const pattern_t &p) {
+            return p.client == client && p.pattern == pattern; });
+    if(itr == patterns.end())
+        return false;
+    patterns.erase(itr);
+    compile();
+    return true;
+}
+
+void SubscriptionRegistry::unsubscribe_all(int client)
+{
+    patterns.erase(std::remove_if(patterns.begin(), patterns.end(),
+        [client](const pattern_t &p) { return p.client == client; }),
+        patterns.end());
+    compile();
+}
+
+size_t SubscriptionRegistry::match(const char *msg, std::vector<int> &clients)
+{
+    clients.clear();
+    match(msg, [&clients](int client) { clients.push_back(client); });
+    return clients.size();
+}
+
+bool SubscriptionRegistry::verify_match(const char *pattern, const char *msg)
+{
+    return rtosc_match(pattern, msg, nullptr);
+}
+
+void SubscriptionRegistry::reset_seen(void)
+{
+    std::fill(seen.begin(), seen.end(), 0);
+    generation = 1;
+}
+
+void SubscriptionRegistry::compile(void)
+{
+    //expand all patterns first, the refs point into the expanded strings
+    expanded.clear();
+    std::vector<int> expanded_clients;
+    std::vector<std::string> options;
+    for(const pattern_t &p : patterns)
+    {
+        options.clear();
+        if(!expand(p.pattern, options))
+            options.assign(1, p.pattern);
+        for(std::string &option : options)
+            expanded.push_back(std::move(option));
+        expanded_clients.resize(expanded.size(), p.client);
+    }
+
+    client_ids.clear();
+    nodes.assign(1, node_t());
+    std::vector<std::vector<ref_t>> node_refs(1);
+
+    for(size_t e = 0; e < expanded.size(); ++e)
+    {
+        int id = expanded_clients[e];
+        auto itr = std::find(client_ids.begin(), client_ids.end(), id);
+        uint32_t client = itr - client_ids.begin();
+        if(itr == client_ids.end())
+            client_ids.push_back(id);
+
+        //walk (and extend) the trie along the literal prefix
+        const char *pattern = expanded[e].c_str();
+        size_t literal = strcspn(pattern, special_chars);
+        uint32_t n = 0;
+        for(size_t i = 0; i < literal; ++i)
+        {
+            uint32_t next = child(nodes[n], pattern[i]);
+            if(!next)
+            {
+                next = nodes.size();
+                nodes[n].children.emplace_back(pattern[i], next);
+                nodes.emplace_back();
+                node_refs.emplace_back();
+            }
+            n = next;
+        }
+
+        kind_t kind = pattern[literal] ? verify
+                    : pattern[literal - 1] == '/' ? prefix : exact;
+        node_refs[n].push_back({kind, client, pattern});
+    }
+
+    refs.clear();
+    for(size_t n = 0; n < nodes.size(); ++n)
+    {
+        nodes[n].first = refs.size();
+        refs.insert(refs.end(), node_refs[n].begin(), node_refs[n].end());
+        nodes[n].last = refs.size();
+    }
+    seen.assign(client_ids.size(), 0);
+    generation = 0;
+}
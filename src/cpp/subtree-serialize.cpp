@@ -1,8 +1,12 @@
+#include "util.h"
 #include <rtosc/subtree-serialize.h>
 #include <rtosc/ports.h>
+#include <rtosc/message-pool.h>
+#include <rtosc/ports-runtime.h>
 #include <rtosc/rtosc.h>
 #include <cstring>
 #include <cassert>
+#include <vector>
 
 
 using namespace rtosc;
@@ -49,6 +53,8 @@ class VarCapture : public RtData
 {
     public:
         char buf[128];
+        MessagePool::buffer large; //!< for replies which do not fit buf
+        const char *captured;
         char location[128];
         char msg[128];
         const char *dummy;
@@ -58,8 +64,9 @@ class VarCapture : public RtData
             :dummy("/ser\0\0\0\0,\0\0\0")
         {
             memset(buf, 0, sizeof(buf));
-            memset(location, 0, sizeof(buf));
+            memset(location, 0, sizeof(location));
             this->loc = location;
+            captured = NULL;
             success = false;
         }
 
@@ -71,25 +78,32 @@ class VarCapture : public RtData
             location[0] = '/';
             strcpy(location+1, path);
             success = false;
+            large.release();
             size_t len = rtosc_message(msg, 128, path, "");
             (void) len;
             assert(len);
             assert(!strchr(path, ':'));
 
             p->dispatch(msg, *this);
-            return success ? buf : NULL;
+            return success ? captured : NULL;
         }
 
         virtual void reply(const char *path, const char *args, ...)
         {
             assert(!success);
             assert(*path);
-            va_list va;
+            va_list va, va_try;
             va_start(va, args);
-            size_t len = rtosc_vmessage(buf, 128, path, args, va);
-            (void) len;
-            assert(len != 0);
-            success = true;
+            va_copy(va_try, va);
+            captured = buf;
+            if(!rtosc_vmessage(buf, sizeof(buf), path, args, va_try)) {
+                MessagePool *pool = message_pool();
+                if(pool)
+                    large = pool->vmessage(path, args, va);
+                captured = large.data();
+            }
+            success = captured != NULL;
+            va_end(va_try);
             va_end(va);
         }
         virtual void broadcast(const char *msg)
@@ -124,7 +138,7 @@ size_t subtree_serialize(char *buffer, size_t buffer_size,
     args.ports       = ports;
 
 
-    //TODO FIXME this is not currently RT safe at the moment
+    //This is not RT safe, see rtosc::SubtreeSerializer for an RT safe version
     walk_ports(ports, args.v.loc, 128, &args, [](const Port *p, const char *,
                                                  const char*,
                                                  const Ports&, void *dat,
@@ -137,19 +151,391 @@ size_t subtree_serialize(char *buffer, size_t buffer_size,
             const char *buf = args->vv.capture(args->ports, args->v.loc+1, args->object);
             if(buf)
                 args->len = append_bundle(args->buffer, buf, args->buffer_size, args->len,
-                    rtosc_message_length(buf, 128));
+                    rtosc_message_length(buf, -1));
             });
 
     return args.len;
 }
 
+//Call f on each element of a bundle in one pass
+//(rtosc_bundle_fetch() would search from the start for each element)
+template<class F>
+static void for_each_element(const char *buffer, size_t buffer_size, F f)
+{
+    size_t pos = 16;
+    while(pos + 4 <= buffer_size) {
+        const uint8_t *l = (const uint8_t*)buffer + pos;
+        uint32_t len = l[0]<<24 | l[1]<<16 | l[2]<<8 | l[3];
+        if(!len || pos + 4 + len > buffer_size)
+            break;
+        f(buffer + pos + 4);
+        pos += 4 + len;
+    }
+}
+
 void subtree_deserialize(char *buffer, size_t buffer_size,
         void *object, rtosc::Ports *ports, RtData &d)
 {
     d.obj = object;
     //simply replay all objects seen here
-    for(unsigned i=0; i<rtosc_bundle_elements(buffer, buffer_size); ++i) {
-        const char *msg = rtosc_bundle_fetch(buffer, i);
-        ports->dispatch(msg+1, d);
+    for_each_element(buffer, buffer_size, [&](const char *msg) {
+            ports->dispatch(msg+1, d);
+            d.obj = object;
+        });
+}
+
+//This object captures the reply of a port directly into the remaining space
+//of a bundle, including the element's length
+//Only the first reply is kept, all broadcasts are ignored
+class BundleCapture : public RtData
+{
+    public:
+        char  *dst;
+        size_t space;
+        size_t written;
+        bool   overflow;
+
+        void reset(char *dst_, size_t space_)
+        {
+            dst      = dst_;
+            space    = space_;
+            written  = 0;
+            overflow = false;
+            matches  = 0;
+        }
+
+        void reply(const char *path, const char *args, ...) override
+        {
+            if(written || overflow)
+                return;
+            va_list va;
+            va_start(va, args);
+            store(space > 4 ? rtosc_vmessage(dst+4, space-4, path, args, va)
+                            : 0);
+            va_end(va);
+        }
+        void replyArray(const char *path, const char *args,
+                        rtosc_arg_t *vals) override
+        {
+            if(written || overflow)
+                return;
+            store(space > 4 ? rtosc_amessage(dst+4, space-4, path, args, vals)
+                            : 0);
+        }
+        void reply(const char *msg) override
+        {
+            if(written || overflow)
+                return;
+            size_t len = rtosc_message_length(msg, -1);
+            if(space < len + 4) {
+                store(0);
+                return;
+            }
+            memcpy(dst+4, msg, len);
+            store(len);
+        }
+        void broadcast(const char *, const char *, ...) override {}
+        void broadcastArray(const char *, const char *,
+                            rtosc_arg_t *) override {}
+        void broadcast(const char *) override {}
+
+    private:
+        void store(size_t len)
+        {
+            if(!len) {
+                overflow = true;
+                return;
+            }
+            emplace_uint32((uint8_t*)dst, len);
+            written = len + 4;
+        }
+};
+
+//Port and runtime object of a leaf port, to call it without dispatching
+struct route_t
+{
+    const Port *port;
+    void       *obj;
+    uint32_t    leaf; //!< offset of the part of the path the port receives
+    enum { unresolved, resolved, unresolvable } state;
+};
+
+//FNV-1a hash of a path
+static uint32_t path_hash(const char *path)
+{
+    uint32_t h = 2166136261u;
+    for(; *path; ++path)
+        h = (h ^ (uint8_t)*path) * 16777619u;
+    return h;
+}
+
+struct rtosc::SubtreeSerializerImpl
+{
+    const Ports *ports;
+
+    //Per leaf port: "/path\0" and the precompiled query message
+    std::vector<char>   paths;
+    std::vector<char>   queries;
+    std::vector<size_t> path_pos;
+    std::vector<size_t> query_pos;
+    std::vector<char>   location;
+
+    //Open addressing hash table of the paths, index plus 1 or 0 if empty
+    std::vector<uint32_t> table;
+
+    BundleCapture d;
+
+    //Routes of the leaf ports, valid for routes_object
+    std::vector<route_t> routes;
+    void *routes_object = nullptr;
+
+    //Current snapshot
+    char  *buffer      = nullptr;
+    size_t buffer_size = 0;
+    size_t len         = 0;
+    void  *object      = nullptr;
+    size_t next        = 0;
+    SubtreeSerializer::status_t status = SubtreeSerializer::idle;
+
+    void add(const char *path)
+    {
+        path_pos.push_back(paths.size());
+        paths.insert(paths.end(), path, path + strlen(path) + 1);
+        if(location.size() < strlen(path) + 1)
+            location.resize(strlen(path) + 1);
+
+        query_pos.push_back(queries.size());
+        size_t qlen = rtosc_message(nullptr, 0, path+1, "");
+        queries.resize(queries.size() + qlen);
+        rtosc_message(queries.data() + query_pos.back(), qlen, path+1, "");
+    }
+
+    //Fill the hash table once all leaf ports are added
+    void build_table(void)
+    {
+        size_t size = 16;
+        while(size < 2 * path_pos.size())
+            size *= 2;
+        table.assign(size, 0);
+        for(size_t i = 0; i < path_pos.size(); ++i) {
+            size_t h = path_hash(paths.data() + path_pos[i]) & (size - 1);
+            while(table[h])
+                h = (h + 1) & (size - 1);
+            table[h] = i + 1;
+        }
+    }
+
+    //Use the routes of object, dropping those of any other object
+    void use_routes(void *obj)
+    {
+        if(obj == routes_object)
+            return;
+        for(route_t &route : routes)
+            route.state = route_t::unresolved;
+        routes_object = obj;
+    }
+
+    //Capture the value of leaf port i, returns false if it does not fit
+    bool capture(size_t i)
+    {
+        if(routes[i].state == route_t::unresolved)
+            resolve(i);
+        const route_t &route = routes[i];
+        const char *query = queries.data() + query_pos[i];
+
+        strcpy(location.data(), paths.data() + path_pos[i]);
+        d.loc      = location.data();
+        d.loc_size = 0; //the location is already complete
+        d.reset(buffer + len, buffer_size - len);
+        if(route.state == route_t::resolved) {
+            //the query has no leading slash, unlike the path
+            d.obj     = route.obj;
+            d.port    = route.port;
+            d.message = query;
+            d.matches = 1;
+            route.port->cb(query + route.leaf - 1, d);
+        } else {
+            d.obj = object;
+            ports->dispatch(query, d);
+        }
+        if(d.overflow)
+            return false;
+        len += d.written;
+        return true;
+    }
+
+    //Index of the leaf port with path, or size() if none
+    size_t find(const char *path) const
+    {
+        const size_t mask = table.size() - 1;
+        for(size_t h = path_hash(path) & mask; table[h]; h = (h + 1) & mask)
+            if(!strcmp(path, paths.data() + path_pos[table[h] - 1]))
+                return table[h] - 1;
+        return path_pos.size();
     }
+
+    void resolve(size_t i);
+};
+
+/*
+ * Find the port and runtime object of leaf port i by dispatching its query.
+ * This walks the port tree once, afterwards the port can be called directly.
+ */
+void SubtreeSerializerImpl::resolve(size_t i)
+{
+    route_t &route = routes[i];
+    route.state = route_t::unresolvable;
+
+    strcpy(location.data(), paths.data() + path_pos[i]);
+    void *obj;
+    size_t leaf;
+    const Port *port = helpers::find_leaf_port(routes_object, *ports, 0,
+                                               location.data(),
+                                               queries.data() + query_pos[i],
+                                               &obj, &leaf);
+    if(!port)
+        return;
+
+    //the leaf is an offset in the path, which has a leading slash
+    route.port  = port;
+    route.obj   = obj;
+    route.leaf  = leaf + 1;
+    route.state = route_t::resolved;
+}
+
+SubtreeSerializer::SubtreeSerializer(const Ports &ports)
+    :impl(new SubtreeSerializerImpl)
+{
+    impl->ports = &ports;
+    char name[1024];
+    memset(name, 0, sizeof(name));
+    walk_ports(&ports, name, sizeof(name), impl,
+               [](const Port *p, const char *path, const char*,
+                  const Ports&, void *dat, void*) {
+            if(p->meta().find("internal") != p->meta().end())
+                return;
+            ((SubtreeSerializerImpl*)dat)->add(path);
+        });
+    impl->build_table();
+    impl->routes.resize(impl->path_pos.size());
+    invalidate_routes();
+}
+
+SubtreeSerializer::~SubtreeSerializer(void)
+{
+    delete impl;
+}
+
+void SubtreeSerializer::begin(char *buffer, size_t buffer_size, void *object)
+{
+    assert(buffer);
+    impl->buffer      = buffer;
+    impl->buffer_size = buffer_size;
+    impl->object      = object;
+    impl->next        = 0;
+    impl->use_routes(object);
+    //only write the header, the remaining buffer is filled by resume()
+    impl->len = buffer_size < 16 ? 0
+              : rtosc_bundle(buffer, 16, 0xdeadbeef0a0b0c0dULL, 0);
+    impl->status = impl->len ? pending : truncated;
+}
+
+SubtreeSerializer::status_t SubtreeSerializer::resume(size_t max_ports)
+{
+    if(impl->status != pending)
+        return impl->status;
+    const size_t n = impl->path_pos.size();
+    for(; max_ports && impl->next < n; --max_ports, ++impl->next)
+        if(!impl->capture(impl->next))
+            return impl->status = truncated;
+    if(impl->next == n)
+        impl->status = done;
+    return impl->status;
+}
+
+SubtreeSerializer::status_t
+SubtreeSerializer::resume_for(std::chrono::nanoseconds budget)
+{
+    using clock = std::chrono::steady_clock;
+    const clock::time_point end = clock::now() + budget;
+    while(resume(1) == pending && clock::now() < end)
+        ;
+    return impl->status;
+}
+
+SubtreeSerializer::status_t SubtreeSerializer::status(void) const
+{
+    return impl->status;
+}
+
+size_t SubtreeSerializer::length(void) const
+{
+    return impl->len;
+}
+
+size_t SubtreeSerializer::size(void) const
+{
+    return impl->path_pos.size();
+}
+
+size_t SubtreeSerializer::position(void) const
+{
+    return impl->next;
+}
+
+void SubtreeSerializer::restore(const char *buffer, size_t buffer_size,
+                                void *object, RtData &d)
+{
+    SubtreeSerializerImpl &im = *impl;
+    im.use_routes(object);
+
+    //the elements are usually in the order of the leaf ports
+    const size_t n = im.routes.size();
+    size_t next = 0;
+    for_each_element(buffer, buffer_size, [&](const char *msg) {
+            size_t i = next < n && !strcmp(msg, im.paths.data() +
+                                                im.path_pos[next])
+                     ? next : im.find(msg);
+            if(i < n && im.routes[i].state == route_t::unresolved)
+                im.resolve(i);
+            if(i < n)
+                next = i + 1;
+            if(i == n || im.routes[i].state != route_t::resolved) {
+                //unknown message, use the port tree
+                d.obj = object;
+                im.ports->dispatch(msg, d, true);
+            } else {
+                const route_t &route = im.routes[i];
+                if(d.loc && d.loc_size)
+                    fast_strcpy(d.loc, msg, d.loc_size);
+                d.obj     = route.obj;
+                d.port    = route.port;
+                d.message = msg;
+                d.matches = 1;
+                route.port->cb(msg + route.leaf, d);
+            }
+        });
+    d.obj = object;
+}
+
+void SubtreeSerializer::compile(void *object)
+{
+    impl->use_routes(object);
+    for(size_t i = 0; i < impl->routes.size(); ++i)
+        if(impl->routes[i].state == route_t::unresolved)
+            impl->resolve(i);
+}
+
+void SubtreeSerializer::invalidate_routes(void)
+{
+    for(route_t &route : impl->routes)
+        route.state = route_t::unresolved;
+    impl->routes_object = nullptr;
+}
+
+const char *SubtreeSerializer::truncated_path(void) const
+{
+    if(impl->status != truncated || impl->next >= impl->path_pos.size())
+        return NULL;
+    return impl->paths.data() + impl->path_pos[impl->next];
 }
@@ -1,4 +1,5 @@
 #include <atomic>
+#include <new>
 #include "../../include/rtosc/thread-link.h"
 
 namespace rtosc {
@@ -8,9 +9,9 @@ namespace rtosc {
 #define off_t signed long
 
 
-//Ringbuffer internal structure
+//Ringbuffer internal structure, directly followed by the buffer memory
+//(so it can be placed in memory which is shared between processes)
 struct internal_ringbuffer_t {
-    char *buffer;
     std::atomic<off_t> write;
     std::atomic<off_t> read;
     /* read_lookahead strictly speaking does not need to be atomic as it is
@@ -23,6 +24,11 @@ struct internal_ringbuffer_t {
 
 typedef internal_ringbuffer_t ringbuffer_t;
 
+static char *ring_buffer(ringbuffer_t *ring)
+{
+    return (char*)(ring + 1);
+}
+
 static size_t ring_read_size(ringbuffer_t *ring, bool lookahead)
 {
     const size_t w = ring->write;
@@ -48,10 +54,10 @@ static void ring_write(ringbuffer_t *ring, const char *data, size_t len)
     if(next_write < ring->write) {
         const size_t w1 = ring->size - ring->write;
         const size_t w2 = len - w1;
-        memcpy(ring->buffer+ring->write, data,    w1);
-        memcpy(ring->buffer,             data+w1, w2);
+        memcpy(ring_buffer(ring)+ring->write, data,    w1);
+        memcpy(ring_buffer(ring),             data+w1, w2);
     } else { //contiguous
-        memcpy(ring->buffer+ring->write, data, len);
+        memcpy(ring_buffer(ring)+ring->write, data, len);
     }
     ring->write = next_write;
 }
@@ -65,10 +71,10 @@ static void ring_read(ringbuffer_t *ring, char *data, size_t len, bool lookahead
     if(next_read < read) {
         const size_t r1 = ring->size - read;
         const size_t r2 = len - r1;
-        memcpy(data,    ring->buffer+read, r1);
-        memcpy(data+r1, ring->buffer,      r2);
+        memcpy(data,    ring_buffer(ring)+read, r1);
+        memcpy(data+r1, ring_buffer(ring), r2);
     } else { //contiguous
-        memcpy(data, ring->buffer+read, len);
+        memcpy(data, ring_buffer(ring)+read, len);
     }
     if (lookahead)
         ring->read_lookahead = next_read;
@@ -85,12 +91,12 @@ static void ring_read_vector(ringbuffer_t *ring, ring_t *r, bool lookahead)
     assert(r);
     size_t read_size = ring_read_size(ring, lookahead);
     off_t  read      = lookahead ? ring->read_lookahead : ring->read;
-    r[0].data = ring->buffer+read;
+    r[0].data = ring_buffer(ring)+read;
     if(read_size+read > ring->size) { //discontinuous
         size_t r2 = (read_size+read)%ring->size;
         size_t r1 = read_size - r2;
         r[0].len  = r1;
-        r[1].data = ring->buffer;
+        r[1].data = ring_buffer(ring);
         r[1].len  = r2;
     } else {
         r[0].len  = read_size;
@@ -100,29 +106,49 @@ static void ring_read_vector(ringbuffer_t *ring, ring_t *r, bool lookahead)
 }
 
 ThreadLink::ThreadLink(size_t max_message_length, size_t max_messages)
+    :ThreadLink(max_message_length, max_messages,
+                new char[memory_size(max_message_length, max_messages)],
+                true)
+{
+    owns_ring = true;
+}
+
+ThreadLink::ThreadLink(size_t max_message_length, size_t max_messages,
+                       void *memory, bool initialize)
     :MaxMsg(max_message_length),
     BufferSize(MaxMsg*max_messages),
     write_buffer(new char[MaxMsg]),
     read_buffer(new char[MaxMsg]),
-    ring(new ringbuffer_t)
+    ring((ringbuffer_t*)memory),
+    owns_ring(false)
 {
-    ring->buffer         = new char[BufferSize];
-    ring->size           = BufferSize;
-    ring->read           = 0;
-    ring->read_lookahead = 0;
-    ring->write          = 0;
+    if(initialize) {
+        ring = new(memory) ringbuffer_t;
+        ring->size           = BufferSize;
+        ring->read           = 0;
+        ring->read_lookahead = 0;
+        ring->write          = 0;
+    }
     memset(write_buffer, 0, MaxMsg);
     memset(read_buffer, 0, MaxMsg);
 }
 
 ThreadLink::~ThreadLink(void)
 {
-    delete[] ring->buffer;
-    delete   ring;
+    if(owns_ring) {
+        ring->~ringbuffer_t();
+        delete[] (char*)ring;
+    }
     delete[] write_buffer;
     delete[] read_buffer;
 }
 
+size_t ThreadLink::memory_size(size_t max_message_length,
+                               size_t max_messages)
+{
+    return sizeof(ringbuffer_t) + max_message_length*max_messages;
+}
+
 void ThreadLink::write(const char *dest, const char *args, ...)
 {
     va_list va;
@@ -145,11 +171,17 @@ void ThreadLink::writeArray(const char *dest, const char *args, const rtosc_arg_
 /**
  * Directly write message to ringbuffer
  */
-void ThreadLink::raw_write(const char *msg)
+bool ThreadLink::raw_write(const char *msg)
 {
-    const size_t len = rtosc_message_length(msg, -1);//assumed valid
-    if(ring_write_size(ring) >= len)
-        ring_write(ring,msg,len);
+    size_t len = rtosc_message_length(msg, -1);//assumed valid
+    //bundles end with a zero length, which must be passed, too
+    if(rtosc_bundle_p(msg))
+        len += 4;
+    //read() could not copy longer messages into its buffer
+    if(len > MaxMsg || ring_write_size(ring) < len)
+        return false;
+    ring_write(ring,msg,len);
+    return true;
 }
 
 /**
@@ -183,8 +215,10 @@ bool ThreadLink::hasNextLookahead(void) const
 msg_t ThreadLink::read(bool lookahead) {
     ring_t r[2];
     ring_read_vector(ring,r,lookahead);
-    const size_t len =
-        rtosc_message_ring_length(r);
+    size_t len = rtosc_message_ring_length(r);
+    //including the zero length at the end
+    if(r[0].data[0] == '#')
+        len += 4;
     assert(ring_read_size(ring, lookahead) >= len);
     assert(len <= MaxMsg);
     ring_read(ring, read_buffer, len, lookahead);
@@ -221,5 +255,9 @@ char *ThreadLink::buffer(void) {return write_buffer;}
  * Access to write buffer length
  */
 size_t ThreadLink::buffer_size(void) const {return BufferSize;}
+/**
+ * Maximum length of a message
+ */
+size_t ThreadLink::max_message_length(void) const {return MaxMsg;}
 
 };
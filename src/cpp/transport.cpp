@@ -0,0 +1,833 @@
+#include <rtosc/transport.h>
+#include <rtosc/thread-link.h>
+#include <rtosc/rtosc.h>
+
+#include <cerrno>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <stdexcept>
+
+#include <fcntl.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/uio.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+using namespace rtosc;
+
+#ifdef MSG_NOSIGNAL
+#define RTOSC_SEND_FLAGS MSG_NOSIGNAL
+#else
+#define RTOSC_SEND_FLAGS 0
+#endif
+
+//Number of datagrams per recvmmsg()/sendmmsg()
+constexpr unsigned datagram_batch = 16;
+
+//SLIP special characters (RFC 1055)
+constexpr unsigned char slip_end     = 0300;
+constexpr unsigned char slip_esc     = 0333;
+constexpr unsigned char slip_esc_end = 0334;
+constexpr unsigned char slip_esc_esc = 0335;
+
+static uint32_t read_be32(const char *p)
+{
+    const unsigned char *u = (const unsigned char*)p;
+    return (uint32_t)u[0] << 24 | (uint32_t)u[1] << 16 |
+           (uint32_t)u[2] << 8  | (uint32_t)u[3];
+}
+
+static void write_be32(char *p, uint32_t v)
+{
+    p[0] = v >> 24;
+    p[1] = v >> 16;
+    p[2] = v >> 8;
+    p[3] = v;
+}
+
+bool rtosc::valid_packet(const char *packet, size_t length)
+{
+    if(length < 4 || length % 4)
+        return false;
+    if(!rtosc_bundle_p(packet))
+        return rtosc_valid_message_p(packet, length);
+
+    //bundle: "#bundle\0", time tag, then size prefixed elements
+    if(length < 16 || memcmp(packet, "#bundle", 8))
+        return false;
+    for(size_t pos = 16; pos < length;)
+    {
+        if(length - pos < 4)
+            return false;
+        size_t elm_length = read_be32(packet + pos);
+        pos += 4;
+        if(elm_length > length - pos ||
+           !valid_packet(packet + pos, elm_length))
+            return false;
+        pos += elm_length;
+    }
+    return true;
+}
+
+size_t rtosc::framed_size(size_t length, framing f)
+{
+    return f == framing::slip ? 2 * length + 2 : length + 4;
+}
+
+size_t rtosc::frame_packet(char *dst, size_t size, const char *packet,
+                           size_t length, framing f)
+{
+    if(f == framing::length_prefix)
+    {
+        if(size < length + 4)
+            return 0;
+        write_be32(dst, length);
+        memcpy(dst + 4, packet, length);
+        return length + 4;
+    }
+
+    char *pos = dst, *end = dst + size;
+    if(pos == end)
+        return 0;
+    *pos++ = slip_end;
+    for(size_t i = 0; i < length; ++i)
+    {
+        unsigned char c = packet[i];
+        if(c == slip_end || c == slip_esc)
+        {
+            if(end - pos < 2)
+                return 0;
+            *pos++ = slip_esc;
+            *pos++ = c == slip_end ? slip_esc_end : slip_esc_esc;
+        }
+        else
+        {
+            if(pos == end)
+                return 0;
+            *pos++ = c;
+        }
+    }
+    if(pos == end)
+        return 0;
+    *pos++ = slip_end;
+    return pos - dst;
+}
+
+/*
+    stream_decoder
+ */
+
+stream_decoder::stream_decoder(framing f, size_t max_packet)
+    : f(f), max_packet(max_packet), buffer(2 * (max_packet + 4))
+{
+}
+
+void stream_decoder::reset()
+{
+    fill = skip = 0;
+    escape = discard = false;
+}
+
+size_t stream_decoder::commit(size_t n, const packet_cb &cb)
+{
+    if(f == framing::slip)
+        return commit_slip(space(), n, cb);
+    fill += n;
+    return commit_length_prefix(cb);
+}
+
+size_t stream_decoder::feed(const char *data, size_t n, const packet_cb &cb)
+{
+    size_t packets = 0;
+    while(n)
+    {
+        size_t chunk = n < space_size() ? n : space_size();
+        memcpy(space(), data, chunk);
+        packets += commit(chunk, cb);
+        data += chunk;
+        n -= chunk;
+    }
+    return packets;
+}
+
+size_t stream_decoder::commit_length_prefix(const packet_cb &cb)
+{
+    size_t packets = 0, pos = 0;
+    char *buf = buffer.data();
+    while(pos < fill)
+    {
+        if(skip)
+        {
+            size_t skipped = skip < fill - pos ? skip : fill - pos;
+            pos  += skipped;
+            skip -= skipped;
+            continue;
+        }
+        if(fill - pos < 4)
+            break;
+        size_t length = read_be32(buf + pos);
+        if(length > max_packet)
+        {
+            ++m_dropped;
+            skip = length;
+            pos += 4;
+            continue;
+        }
+        if(fill - pos - 4 < length)
+            break;
+        //the packet is used right where it was received
+        const char *packet = buf + pos + 4;
+        if(valid_packet(packet, length))
+        {
+            cb(packet, length);
+            ++packets;
+        }
+        else
+            ++m_dropped;
+        pos += 4 + length;
+    }
+
+    //move the incomplete packet to the front
+    memmove(buf, buf + pos, fill - pos);
+    fill -= pos;
+    return packets;
+}
+
+size_t stream_decoder::commit_slip(const char *raw, size_t n,
+                                   const packet_cb &cb)
+{
+    //decoding never makes the data longer, so it is done in place
+    size_t packets = 0;
+    char *buf = buffer.data();
+    char *out = buf + fill, *start = buf;
+    for(const char *end = raw + n; raw != end; ++raw)
+    {
+        unsigned char c = *raw;
+        if(c == slip_end)
+        {
+            size_t length = out - start;
+            if(discard)
+                discard = false;
+            else if(length)
+            {
+                if(valid_packet(start, length))
+                {
+                    cb(start, length);
+                    ++packets;
+                }
+                else
+                    ++m_dropped;
+            }
+            escape = false;
+            start = out;
+        }
+        else if(discard)
+            ;
+        else if(c == slip_esc)
+            escape = true;
+        else
+        {
+            if(escape)
+            {
+                c = c == slip_esc_end ? slip_end
+                  : c == slip_esc_esc ? slip_esc : c;
+                escape = false;
+            }
+            if((size_t)(out - start) == max_packet)
+            {
+                ++m_dropped;
+                discard = true;
+                out = start;
+            }
+            else
+                *out++ = c;
+        }
+    }
+
+    //move the incomplete packet to the front
+    memmove(buf, start, out - start);
+    fill = out - start;
+    return packets;
+}
+
+/*
+    helpers for sockets
+ */
+
+[[noreturn]] static void throw_errno(const char *what)
+{
+    throw std::runtime_error(std::string(what) + ": " + strerror(errno));
+}
+
+static void set_nonblocking(int fd)
+{
+    int flags = fcntl(fd, F_GETFL, 0);
+    fcntl(fd, F_SETFL, flags | O_NONBLOCK);
+}
+
+static void set_nosigpipe(int fd)
+{
+#ifdef SO_NOSIGPIPE
+    int one = 1;
+    setsockopt(fd, SOL_SOCKET, SO_NOSIGPIPE, &one, sizeof(one));
+#else
+    (void)fd;
+#endif
+}
+
+//! Wait until @p fd has the @p events, return false on timeout
+static bool wait_for(int fd, short events, int timeout_msecs)
+{
+    pollfd pfd;
+    pfd.fd = fd;
+    pfd.events = events;
+    pfd.revents = 0;
+    int res;
+    do
+        res = poll(&pfd, 1, timeout_msecs);
+    while(res < 0 && errno == EINTR);
+    return res > 0;
+}
+
+//! Resolve @p host:@p port, the result must be freed with freeaddrinfo()
+static addrinfo *resolve(const char *host, int port, int type, bool passive)
+{
+    addrinfo hints, *result;
+    memset(&hints, 0, sizeof(hints));
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = type;
+    hints.ai_flags = passive ? AI_PASSIVE : 0;
+    char service[16];
+    snprintf(service, sizeof(service), "%d", port);
+    int err = getaddrinfo(host, service, &hints, &result);
+    if(err)
+        throw std::runtime_error(std::string("getaddrinfo: ") +
+                                 gai_strerror(err));
+    return result;
+}
+
+//! Create a socket of @p type connected to or bound to @p host:@p port
+static int inet_socket(const char *host, int port, int type, bool bind_it)
+{
+    addrinfo *result = resolve(host, port, type, bind_it);
+    int fd = -1;
+    for(addrinfo *ai = result; ai && fd < 0; ai = ai->ai_next)
+    {
+        fd = socket(ai->ai_family, ai->ai_socktype, ai->ai_protocol);
+        if(fd < 0)
+            continue;
+        if(bind_it)
+        {
+            int one = 1;
+            setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+        }
+        if((bind_it ? bind(fd, ai->ai_addr, ai->ai_addrlen)
+                    : connect(fd, ai->ai_addr, ai->ai_addrlen)) < 0)
+        {
+            ::close(fd);
+            fd = -1;
+        }
+    }
+    freeaddrinfo(result);
+    if(fd < 0)
+        throw_errno(bind_it ? "bind" : "connect");
+    return fd;
+}
+
+static sockaddr_un unix_address(const char *path)
+{
+    sockaddr_un addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    if(strlen(path) >= sizeof(addr.sun_path))
+        throw std::runtime_error("UNIX socket path too long");
+    strcpy(addr.sun_path, path);
+    return addr;
+}
+
+static int bound_port(int fd)
+{
+    sockaddr_storage addr;
+    socklen_t len = sizeof(addr);
+    if(fd < 0 || getsockname(fd, (sockaddr*)&addr, &len) < 0)
+        return 0;
+    if(addr.ss_family == AF_INET)
+        return ntohs(((sockaddr_in*)&addr)->sin_port);
+    if(addr.ss_family == AF_INET6)
+        return ntohs(((sockaddr_in6*)&addr)->sin6_port);
+    return 0;
+}
+
+//! Write @p packet into @p link, unpacking bundles
+//! @param dropped incremented for each message which was not written
+static size_t write_to_link(ThreadLink &link, const char *packet,
+                            size_t length, size_t &dropped)
+{
+    if(!rtosc_bundle_p(packet))
+    {
+        //longer messages would not fit the buffer which the link reads into
+        if(length <= link.max_message_length() && link.raw_write(packet))
+            return 1;
+        ++dropped;
+        return 0;
+    }
+    size_t messages = 0;
+    for(size_t pos = 16; pos < length;)
+    {
+        size_t elm_length = read_be32(packet + pos);
+        messages += write_to_link(link, packet + pos + 4, elm_length,
+                                  dropped);
+        pos += 4 + elm_length;
+    }
+    return messages;
+}
+
+/*
+    connection
+ */
+
+connection::connection(int fd, bool stream, framing f, size_t max_packet)
+    : fd(fd), stream(stream), f(f), max_packet(max_packet)
+{
+    set_nonblocking(fd);
+    set_nosigpipe(fd);
+    if(stream)
+        decoder.reset(new stream_decoder(f, max_packet));
+    else
+        slots.resize(datagram_batch * max_packet);
+}
+
+connection::connection(connection &&other)
+{
+    *this = std::move(other);
+}
+
+connection& connection::operator=(connection &&other)
+{
+    if(this != &other)
+    {
+        close();
+        fd = other.fd;
+        stream = other.stream;
+        f = other.f;
+        max_packet = other.max_packet;
+        decoder = std::move(other.decoder);
+        slots = std::move(other.slots);
+        out = std::move(other.out);
+        out_ends = std::move(other.out_ends);
+        send_timeout = other.send_timeout;
+        m_dropped = other.m_dropped;
+        other.fd = -1;
+    }
+    return *this;
+}
+
+connection::~connection()
+{
+    close();
+}
+
+void connection::close()
+{
+    if(fd >= 0)
+        ::close(fd);
+    fd = -1;
+}
+
+connection connection::tcp(const char *host, int port, framing f,
+                           size_t max_packet)
+{
+    int fd = inet_socket(host, port, SOCK_STREAM, false);
+    int one = 1;
+    setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+    return connection(fd, true, f, max_packet);
+}
+
+connection connection::unix_socket(const char *path, framing f,
+                                   size_t max_packet)
+{
+    sockaddr_un addr = unix_address(path);
+    int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if(fd < 0)
+        throw_errno("socket");
+    if(connect(fd, (sockaddr*)&addr, sizeof(addr)) < 0)
+    {
+        int err = errno;
+        ::close(fd);
+        errno = err;
+        throw_errno("connect");
+    }
+    return connection(fd, true, f, max_packet);
+}
+
+connection connection::udp(int local_port, const char *host,
+                           int remote_port, size_t max_packet)
+{
+    //bind to any address of the peer's family
+    addrinfo *result = resolve(host, remote_port, SOCK_DGRAM, false);
+    int family = result->ai_family;
+    freeaddrinfo(result);
+
+    sockaddr_storage addr;
+    memset(&addr, 0, sizeof(addr));
+    socklen_t addr_len;
+    if(family == AF_INET6)
+    {
+        sockaddr_in6 *in6 = (sockaddr_in6*)&addr;
+        in6->sin6_family = AF_INET6;
+        in6->sin6_port = htons(local_port);
+        in6->sin6_addr = in6addr_any;
+        addr_len = sizeof(sockaddr_in6);
+    }
+    else
+    {
+        sockaddr_in *in = (sockaddr_in*)&addr;
+        in->sin_family = AF_INET;
+        in->sin_port = htons(local_port);
+        in->sin_addr.s_addr = htonl(INADDR_ANY);
+        addr_len = sizeof(sockaddr_in);
+    }
+    int fd = socket(family, SOCK_DGRAM, 0);
+    if(fd < 0)
+        throw_errno("socket");
+    if(bind(fd, (sockaddr*)&addr, addr_len) < 0)
+    {
+        int err = errno;
+        ::close(fd);
+        errno = err;
+        throw_errno("bind");
+    }
+
+    connection con(fd, false, framing::length_prefix, max_packet);
+    if(remote_port)
+        con.connect_udp(host, remote_port);
+    return con;
+}
+
+void connection::connect_udp(const char *host, int port)
+{
+    addrinfo *result = resolve(host, port, SOCK_DGRAM, false);
+    bool connected = false;
+    for(addrinfo *ai = result; ai && !connected; ai = ai->ai_next)
+        connected = !connect(fd, ai->ai_addr, ai->ai_addrlen);
+    freeaddrinfo(result);
+    if(!connected)
+        throw_errno("connect");
+}
+
+int connection::local_port() const
+{
+    return bound_port(fd);
+}
+
+size_t connection::dropped() const
+{
+    return m_dropped + (decoder ? decoder->dropped() : 0);
+}
+
+size_t connection::write_all(const char *data, size_t length)
+{
+    size_t written = 0;
+    while(written < length && fd >= 0)
+    {
+        ssize_t res = ::send(fd, data + written, length - written,
+                             RTOSC_SEND_FLAGS);
+        if(res > 0)
+            written += res;
+        else if(res < 0 && errno == EINTR)
+            ;
+        else if(res < 0 && (errno == EAGAIN || errno == EWOULDBLOCK))
+        {
+            if(!wait_for(fd, POLLOUT, send_timeout))
+                break;
+        }
+        else
+            close();
+    }
+    return written;
+}
+
+void connection::set_send_timeout(int timeout_msecs)
+{
+    send_timeout = timeout_msecs;
+}
+
+bool connection::send(const char *packet, size_t length)
+{
+    return send(&packet, &length, 1) == 1;
+}
+
+bool connection::send(const char *msg)
+{
+    return send(msg, rtosc_message_length(msg, -1));
+}
+
+size_t connection::send(const char *const *packets, const size_t *lengths,
+                        size_t n)
+{
+    if(fd < 0)
+        return 0;
+
+    if(stream)
+    {
+        //frame all packets into one buffer and write that at once
+        size_t size = 0;
+        for(size_t i = 0; i < n; ++i)
+            size += framed_size(lengths[i], f);
+        if(out.size() < size)
+            out.resize(size);
+        if(out_ends.size() < n)
+            out_ends.resize(n);
+        size_t used = 0;
+        for(size_t i = 0; i < n; ++i)
+        {
+            used += frame_packet(out.data() + used, out.size() - used,
+                                 packets[i], lengths[i], f);
+            out_ends[i] = used;
+        }
+        size_t written = write_all(out.data(), used);
+        if(written == used)
+            return n;
+
+        //a cut frame would garble the stream, so give it up
+        size_t complete = 0;
+        while(complete < n && out_ends[complete] <= written)
+            ++complete;
+        if(written && (!complete || out_ends[complete-1] != written))
+            close();
+        return complete;
+    }
+
+    size_t sent = 0;
+#ifdef __linux__
+    mmsghdr msgs[datagram_batch];
+    iovec iovs[datagram_batch];
+    while(sent < n)
+    {
+        unsigned batch = 0;
+        for(; batch < datagram_batch && sent + batch < n; ++batch)
+        {
+            iovs[batch].iov_base = (void*)packets[sent + batch];
+            iovs[batch].iov_len  = lengths[sent + batch];
+            memset(&msgs[batch], 0, sizeof(mmsghdr));
+            msgs[batch].msg_hdr.msg_iov    = &iovs[batch];
+            msgs[batch].msg_hdr.msg_iovlen = 1;
+        }
+        int res = sendmmsg(fd, msgs, batch, 0);
+        if(res > 0)
+            sent += res;
+        else if(res < 0 && errno == EINTR)
+            ;
+        else if(res < 0 && (errno == EAGAIN || errno == EWOULDBLOCK))
+        {
+            if(!wait_for(fd, POLLOUT, send_timeout))
+                break;
+        }
+        else
+            break;
+    }
+#else
+    while(sent < n)
+    {
+        ssize_t res = ::send(fd, packets[sent], lengths[sent], 0);
+        if(res >= 0)
+            ++sent;
+        else if(errno == EINTR)
+            ;
+        else if(errno == EAGAIN || errno == EWOULDBLOCK)
+        {
+            if(!wait_for(fd, POLLOUT, send_timeout))
+                break;
+        }
+        else
+            break;
+    }
+#endif
+    return sent;
+}
+
+size_t connection::receive_datagrams(const packet_cb &cb)
+{
+    size_t packets = 0;
+#ifdef __linux__
+    mmsghdr msgs[datagram_batch];
+    iovec iovs[datagram_batch];
+    for(unsigned i = 0; i < datagram_batch; ++i)
+    {
+        iovs[i].iov_base = slots.data() + i * max_packet;
+        iovs[i].iov_len  = max_packet;
+        memset(&msgs[i], 0, sizeof(mmsghdr));
+        msgs[i].msg_hdr.msg_iov    = &iovs[i];
+        msgs[i].msg_hdr.msg_iovlen = 1;
+    }
+    while(true)
+    {
+        int res = recvmmsg(fd, msgs, datagram_batch, 0, nullptr);
+        if(res < 0 && errno == EINTR)
+            continue;
+        if(res <= 0)
+            break;
+        for(int i = 0; i < res; ++i)
+        {
+            const char *packet = (const char*)iovs[i].iov_base;
+            size_t length = msgs[i].msg_len;
+            if(!(msgs[i].msg_hdr.msg_flags & MSG_TRUNC) &&
+               valid_packet(packet, length))
+            {
+                cb(packet, length);
+                ++packets;
+            }
+            else
+                ++m_dropped;
+        }
+        if(res < (int)datagram_batch)
+            break;
+    }
+#else
+    while(true)
+    {
+        ssize_t res = ::recv(fd, slots.data(), max_packet, MSG_TRUNC);
+        if(res < 0 && errno == EINTR)
+            continue;
+        if(res < 0)
+            break;
+        if((size_t)res <= max_packet && valid_packet(slots.data(), res))
+        {
+            cb(slots.data(), res);
+            ++packets;
+        }
+        else
+            ++m_dropped;
+    }
+#endif
+    return packets;
+}
+
+size_t connection::receive(const packet_cb &cb, int timeout_msecs)
+{
+    if(fd < 0 || !wait_for(fd, POLLIN, timeout_msecs))
+        return 0;
+    if(!stream)
+        return receive_datagrams(cb);
+
+    size_t packets = 0;
+    while(fd >= 0)
+    {
+        size_t space = decoder->space_size();
+        ssize_t res = ::recv(fd, decoder->space(), space, 0);
+        if(res > 0)
+        {
+            packets += decoder->commit(res, cb);
+            //a partial read means the socket is drained
+            if((size_t)res < space)
+                break;
+        }
+        else if(res < 0 && errno == EINTR)
+            ;
+        else if(res < 0 && (errno == EAGAIN || errno == EWOULDBLOCK))
+            break;
+        else //closed by the peer, or error
+            close();
+    }
+    return packets;
+}
+
+size_t connection::receive(ThreadLink &link, int timeout_msecs)
+{
+    size_t messages = 0;
+    receive([&](const char *packet, size_t length) {
+        messages += write_to_link(link, packet, length, m_dropped);
+    }, timeout_msecs);
+    return messages;
+}
+
+/*
+    listener
+ */
+
+listener::listener(listener &&other)
+{
+    *this = std::move(other);
+}
+
+listener& listener::operator=(listener &&other)
+{
+    if(this != &other)
+    {
+        close();
+        fd = other.fd;
+        path = std::move(other.path);
+        other.fd = -1;
+        other.path.clear();
+    }
+    return *this;
+}
+
+listener::~listener()
+{
+    close();
+}
+
+void listener::close()
+{
+    if(fd >= 0)
+        ::close(fd);
+    if(!path.empty())
+        unlink(path.c_str());
+    fd = -1;
+    path.clear();
+}
+
+listener listener::tcp(int port, const char *host)
+{
+    listener l;
+    l.fd = inet_socket(host, port, SOCK_STREAM, true);
+    if(listen(l.fd, 16) < 0)
+        throw_errno("listen");
+    return l;
+}
+
+listener listener::unix_socket(const char *path)
+{
+    sockaddr_un addr = unix_address(path);
+    listener l;
+    l.fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if(l.fd < 0)
+        throw_errno("socket");
+    //remove a stale socket, but never other files
+    struct stat st;
+    if(!lstat(path, &st) && S_ISSOCK(st.st_mode))
+        unlink(path);
+    if(bind(l.fd, (sockaddr*)&addr, sizeof(addr)) < 0)
+        throw_errno("bind");
+    l.path = path;
+    if(listen(l.fd, 16) < 0)
+        throw_errno("listen");
+    return l;
+}
+
+int listener::port() const
+{
+    return bound_port(fd);
+}
+
+connection listener::accept(framing f, int timeout_msecs, size_t max_packet)
+{
+    if(fd < 0 || !wait_for(fd, POLLIN, timeout_msecs))
+        return connection();
+    int con = ::accept(fd, nullptr, nullptr);
+    if(con < 0)
+        return connection();
+    if(path.empty())
+    {
+        int one = 1;
+        setsockopt(con, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+    }
+    return connection(con, true, f, max_packet);
+}
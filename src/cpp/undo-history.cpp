@@ -1,40 +1,157 @@
+#include <atomic>
+#include <chrono>
 #include <deque>
+#include <vector>
 #include <cstring>
 #include <cstdio>
+#include <cstdint>
 #include <cassert>
-#include <ctime>
 #include <rtosc/rtosc.h>
 #include <rtosc/undo-history.h>
-
-using std::pair;
-using std::make_pair;
+#include <rtosc/subtree-serialize.h>
 
 namespace rtosc {
+
+//Default memory budget of the recorded events
+#define UNDO_DEFAULT_BUDGET (64*1024)
+//Smallest expected size of an undo event, used to size the event index
+#define UNDO_MIN_EVENT_SIZE 24
+//Default number of checkpoints which are kept
+#define UNDO_DEFAULT_CHECKPOINTS 8
+//Events of one address are merged if they are at most 2 seconds apart
+#define UNDO_MERGE_TIME 2000000000LL
+
+static const char undo_change_addr[] = "/undo_change";
+
+static size_t pad4(size_t len)
+{
+    return (len + 3) & ~(size_t)3;
+}
+
+/*
+ * Header of an /undo_change event in the ring. The event's path is stored as
+ * the number of bytes it shares with the path of the first event of its undo
+ * step (the "key"), followed by the remaining bytes of the path, the types
+ * after the 's' and the raw argument data. All other events are stored as
+ * they are.
+ */
+struct change_header_t
+{
+    uint16_t shared;     //!< bytes of the path shared with the key's path
+    uint16_t suffix_len; //!< bytes of the path stored after the header
+    uint16_t args_len;   //!< bytes of argument data after the types
+    uint8_t  types_len;  //!< number of types after the 's'
+    uint8_t  unused;
+};
+
+/*
+ * All events are stored in one preallocated byte ring. The ring is indexed
+ * by a circular array of event descriptors, ordered from oldest to newest.
+ * When an event does not fit, the oldest undo steps are dropped.
+ */
 class UndoHistoryImpl
 {
     public:
-        UndoHistoryImpl(void)
-            :max_history_size(20)
-        {}
-        ~UndoHistoryImpl(void)
+        enum
         {
-            clear();
+            STEP_BEGIN = 1, //!< first event of an undo step
+            COMPRESSED = 2  //!< stored with a change_header_t
+        };
+
+        struct event_t
+        {
+            int64_t  time;    //!< monotonic time in nanoseconds
+            size_t   offset;  //!< position of the event in the ring
+            size_t   size;    //!< bytes reserved in the ring
+            size_t   key_seq; //!< sequence number of the step's first event
+            uint32_t hash;    //!< hash of the undo address
+            uint32_t flags;
+        };
+
+        //! state of all ports at a history position
+        struct checkpoint_t
+        {
+            size_t seq;      //!< number of events applied to the state
+            size_t nmsgs;    //!< number of messages in data
+            std::vector<char> data;
+        };
+
+        UndoHistoryImpl(size_t memory_budget)
+            :first(0), count(0), dropped(0), history_pos(0),
+             transaction_depth(0), transaction_seq(0),
+             object(nullptr), ports(nullptr), snapshot_size(0),
+             checkpoint_interval(0), max_checkpoints(UNDO_DEFAULT_CHECKPOINTS),
+             since_checkpoint(0)
+        {
+            setBudget(memory_budget);
         }
-        std::deque<pair<time_t, const char *>> history;
+
+        std::vector<char>    ring;
+        std::vector<event_t> events;
+        size_t first;   //!< index of the oldest event in events
+        size_t count;   //!< number of events in the history
+        size_t dropped; //!< number of events that ever left the history
+        //! sequence number (+1) of the latest event per address hash
+        std::vector<size_t> last_of_hash;
+        std::vector<char> merge_buf, decode_buf;
         long history_pos;
-        unsigned max_history_size;//XXX Expose this via a public API
         std::function<void(const char*)> cb;
 
+        int    transaction_depth;
+        size_t transaction_seq; //!< sequence number of the open step's start
+
+        void  *object;
+        Ports *ports;
+        size_t snapshot_size;
+        size_t checkpoint_interval;
+        size_t max_checkpoints;
+        size_t since_checkpoint; //!< events appended since the last checkpoint
+        std::deque<checkpoint_t> checkpoints;
+        std::vector<char> snapshot_buf;
+
+        event_t &at(size_t i) { return events[(first+i)%events.size()]; }
+        const event_t &at(size_t i) const
+        {
+            return events[(first+i)%events.size()];
+        }
+        bool valid(size_t seq) const
+        {
+            return seq >= dropped && seq < dropped + count;
+        }
+        const char *message(size_t i);
+        const char *keyPath(const event_t &ev, size_t *len) const;
+        size_t encodedSize(const char *msg, size_t len,
+                           const event_t &ev, size_t *shared) const;
+        void encode(const char *msg, size_t len, size_t shared,
+                    char *dst) const;
+
         void rewind(const char *msg);
         void replay(const char *msg);
-        bool mergeEvent(time_t t, const char *msg, char *buf, size_t N);
-        void clear(void);
+        void record(int64_t t, const char *msg, bool applied);
+        bool mergeEvent(int64_t t, const char *msg, uint32_t hash);
+        void appendEvent(int64_t t, const char *msg, size_t len,
+                         uint32_t hash);
+        bool reserve(size_t len, size_t *offset);
+        void popFront(void);
+        void setBudget(size_t memory_budget);
+        bool checkpoint(void);
+        void autoCheckpoint(void);
+        void dropCheckpoints(size_t min_seq, size_t max_seq);
+        void restore(const checkpoint_t &cp);
+        bool isStepBegin(size_t i) const
+        {
+            return i == count || (at(i).flags & STEP_BEGIN);
+        }
 };
 
 UndoHistory::UndoHistory(void)
 {
-    impl = new UndoHistoryImpl;
-    impl->history_pos  = 0;
+    impl = new UndoHistoryImpl(UNDO_DEFAULT_BUDGET);
+}
+
+UndoHistory::UndoHistory(size_t memory_budget)
+{
+    impl = new UndoHistoryImpl(memory_budget);
 }
 
 UndoHistory::~UndoHistory(void)
@@ -42,39 +159,63 @@ UndoHistory::~UndoHistory(void)
     delete impl;
 }
 
+const char *getUndoAddress(const char *msg)
+{
+    return rtosc_argument(msg,0).s;
+}
+
+//Nanoseconds of a monotonic clock, RT-safe on common platforms
+static int64_t monotonicTime(void)
+{
+    using namespace std::chrono;
+    return duration_cast<nanoseconds>(
+            steady_clock::now().time_since_epoch()).count();
+}
+
+//FNV-1a
+static uint32_t hashAddress(const char *address)
+{
+    uint32_t hash = 2166136261u;
+    for(; *address; ++address)
+        hash = (hash ^ (uint8_t)*address) * 16777619u;
+    return hash;
+}
+
 void UndoHistory::recordEvent(const char *msg)
+{
+    impl->record(monotonicTime(), msg, false);
+}
+
+//applied tells whether the checkpoint source already contains the event
+void UndoHistoryImpl::record(int64_t now, const char *msg, bool applied)
 {
     //TODO Properly account for when you have traveled back in time.
     //while this could result in another branch of history, the simple method
     //would be to kill off any future redos when new history is recorded
-    if(impl->history.size() != (unsigned) impl->history_pos) {
-        impl->history.resize(impl->history_pos);
+    if(count != (size_t)history_pos) {
+        count = history_pos;
+        dropCheckpoints(dropped, dropped + count);
     }
 
     size_t len = rtosc_message_length(msg, -1);
-    char *data = new char[len];
-    time_t now = time(NULL);
+    uint32_t hash = hashAddress(getUndoAddress(msg));
     //printf("now = '%ld'\n", now);
-    if(!impl->mergeEvent(now, msg, data, len)) {
-        memcpy(data, msg, len);
-        impl->history.push_back(make_pair(now, data));
-        impl->history_pos++;
-        if(impl->history.size() > impl->max_history_size)
-        {
-            delete[] impl->history[0].second;
-            impl->history.pop_front();
-            impl->history_pos--;
-        }
-    }
+    if(mergeEvent(now, msg, hash))
+        return;
 
+    //the state does not yet contain this event, so it matches the history
+    if(!applied)
+        autoCheckpoint();
+    appendEvent(now, msg, len, hash);
 }
 
 void UndoHistory::showHistory(void) const
 {
-    int i = 0;
-    for(auto s : impl->history)
-        printf("#%d type: %s dest: %s arguments: %s\n", i++,
-                s.second, rtosc_argument(s.second, 0).s, rtosc_argument_string(s.second));
+    for(size_t i = 0; i < impl->count; ++i) {
+        const char *msg = impl->message(i);
+        printf("#%d type: %s dest: %s arguments: %s\n", (int)i,
+                msg, rtosc_argument(msg, 0).s, rtosc_argument_string(msg));
+    }
 }
 
 static char tmp[256];
@@ -94,75 +235,401 @@ void UndoHistoryImpl::replay(const char *msg)
     int len = rtosc_amessage(tmp, 256, rtosc_argument(msg,0).s,
             rtosc_argument_string(msg)+2,
             &arg);
-    
+
     if(len)
         cb(tmp);
 }
 
-const char *getUndoAddress(const char *msg)
+//Path of the key of an event's step, or NULL if the event is stored as is
+const char *UndoHistoryImpl::keyPath(const event_t &ev, size_t *len) const
 {
-    return rtosc_argument(msg,0).s;
+    if(!valid(ev.key_seq))
+        return nullptr;
+    const event_t &key = at(ev.key_seq - dropped);
+    if(!(key.flags & COMPRESSED))
+        return nullptr;
+    change_header_t hdr;
+    memcpy(&hdr, ring.data() + key.offset, sizeof(hdr));
+    *len = hdr.suffix_len;
+    return ring.data() + key.offset + sizeof(hdr);
 }
 
-bool UndoHistoryImpl::mergeEvent(time_t now, const char *msg, char *buf, size_t N)
+//Bytes needed to store msg for an event with the key of ev, or 0 if the
+//message can not be compressed
+size_t UndoHistoryImpl::encodedSize(const char *msg, size_t len,
+                                    const event_t &ev, size_t *shared) const
 {
-    if(history_pos == 0)
+    const char *types = rtosc_argument_string(msg);
+    if(strcmp(msg, undo_change_addr) || types[0] != 's')
+        return 0;
+    const char *path = rtosc_argument(msg, 0).s;
+    size_t path_len = strlen(path);
+    size_t types_len = strlen(types+1);
+    size_t args_len = len - (path + pad4(path_len+1) - msg);
+
+    //the first event of a step is the key itself
+    *shared = 0;
+    size_t key_len;
+    const char *key = (ev.flags & STEP_BEGIN) ? nullptr
+                                              : keyPath(ev, &key_len);
+    if(key)
+        while(*shared < key_len && key[*shared] == path[*shared])
+            ++*shared;
+
+    if(path_len - *shared > UINT16_MAX || args_len > UINT16_MAX ||
+       types_len > UINT8_MAX)
+        return 0;
+    return sizeof(change_header_t) + path_len - *shared + types_len
+           + args_len;
+}
+
+void UndoHistoryImpl::encode(const char *msg, size_t len, size_t shared,
+                             char *dst) const
+{
+    const char *types = rtosc_argument_string(msg) + 1;
+    const char *path = rtosc_argument(msg, 0).s;
+    size_t path_len = strlen(path);
+    const char *args = path + pad4(path_len+1);
+
+    change_header_t hdr;
+    hdr.shared     = shared;
+    hdr.suffix_len = path_len - shared;
+    hdr.types_len  = strlen(types);
+    hdr.args_len   = len - (args - msg);
+    hdr.unused     = 0;
+    memcpy(dst, &hdr, sizeof(hdr));
+    dst += sizeof(hdr);
+    memcpy(dst, path + shared, hdr.suffix_len);
+    dst += hdr.suffix_len;
+    memcpy(dst, types, hdr.types_len);
+    dst += hdr.types_len;
+    memcpy(dst, args, hdr.args_len);
+}
+
+//The i'th event as a message, valid until the next call
+const char *UndoHistoryImpl::message(size_t i)
+{
+    const event_t &ev = at(i);
+    const char *src = ring.data() + ev.offset;
+    if(!(ev.flags & COMPRESSED))
+        return src;
+
+    change_header_t hdr;
+    memcpy(&hdr, src, sizeof(hdr));
+    src += sizeof(hdr);
+    size_t key_len = 0;
+    const char *key = hdr.shared ? keyPath(ev, &key_len) : nullptr;
+    assert(!hdr.shared || (key && key_len >= hdr.shared));
+
+    size_t path_len = hdr.shared + hdr.suffix_len;
+    size_t addr_size = pad4(sizeof(undo_change_addr));
+    size_t types_size = pad4(2 + hdr.types_len + 1);
+    size_t len = addr_size + types_size + pad4(path_len+1) + hdr.args_len;
+    if(decode_buf.size() < len)
+        decode_buf.resize(len);
+    char *dst = decode_buf.data();
+    memset(dst, 0, len - hdr.args_len);
+
+    memcpy(dst, undo_change_addr, sizeof(undo_change_addr));
+    dst += addr_size;
+    dst[0] = ',';
+    dst[1] = 's';
+    memcpy(dst + 2, src + hdr.suffix_len, hdr.types_len);
+    dst += types_size;
+    memcpy(dst, key, hdr.shared);
+    memcpy(dst + hdr.shared, src, hdr.suffix_len);
+    dst += pad4(path_len+1);
+    memcpy(dst, src + hdr.suffix_len + hdr.types_len, hdr.args_len);
+    return decode_buf.data();
+}
+
+bool UndoHistoryImpl::mergeEvent(int64_t now, const char *msg, uint32_t hash)
+{
+    //Only the latest event with the same address can be merged. It is found
+    //via the hash table instead of searching the history
+    size_t seq = last_of_hash[hash & (last_of_hash.size()-1)];
+    if(!seq-- || !valid(seq))
+        return false;
+    size_t idx = seq - dropped;
+    event_t &ev = at(idx);
+
+    //Events must not be merged across undo steps: Inside a transaction, only
+    //its own events are merged, outside, only single event steps
+    if(transaction_depth ? seq < transaction_seq || !valid(transaction_seq)
+                         : !isStepBegin(idx) || !isStepBegin(idx+1))
         return false;
-    for(int i=history_pos-1; i>=0; --i) {
-        if(difftime(now, history[i].first) > 2)
+
+    const char *old = message(idx);
+    if(ev.hash != hash || now - ev.time > UNDO_MERGE_TIME ||
+       strcmp(getUndoAddress(msg), getUndoAddress(old)))
+        return false;
+
+    //We can splice events together, merging them into one event
+    rtosc_arg_t args[3];
+    args[0] = rtosc_argument(msg, 0);
+    args[1] = rtosc_argument(old, 1);
+    args[2] = rtosc_argument(msg, 2);
+
+    //args[1] points into the old event, so build the result aside
+    const char *arg_str = rtosc_argument_string(msg);
+    size_t len = rtosc_amessage(NULL, 0, msg, arg_str, args);
+    if(merge_buf.size() < len)
+        merge_buf.resize(len);
+    rtosc_amessage(merge_buf.data(), len, msg, arg_str, args);
+
+    //The merged event must fit into the space of the old one
+    char *dst = ring.data() + ev.offset;
+    size_t shared;
+    if(ev.flags & COMPRESSED) {
+        if(encodedSize(merge_buf.data(), len, ev, &shared) > ev.size)
+            return false;
+        encode(merge_buf.data(), len, shared, dst);
+    } else {
+        if(len > ev.size)
+            return false;
+        memcpy(dst, merge_buf.data(), len);
+    }
+    ev.time = now;
+
+    //checkpoints after the event do not contain the new value
+    dropCheckpoints(dropped, seq + 1);
+    return true;
+}
+
+void UndoHistoryImpl::appendEvent(int64_t now, const char *msg, size_t len,
+                                  uint32_t hash)
+{
+    event_t ev;
+    ev.time = now;
+    ev.hash = hash;
+    ev.flags = 0;
+    ev.key_seq = dropped + count;
+    if(transaction_depth && valid(transaction_seq))
+        ev.key_seq = transaction_seq;
+    else
+        ev.flags |= STEP_BEGIN;
+
+    size_t shared = 0, size;
+    for(;;) {
+        size = encodedSize(msg, len, ev, &shared);
+        if(size)
+            ev.flags |= COMPRESSED;
+        else
+            size = len;
+        if(!reserve(size, &ev.offset))
+            return;
+        if(valid(ev.key_seq) || (ev.flags & STEP_BEGIN))
             break;
-        if(!strcmp(getUndoAddress(msg),
-                    getUndoAddress(history[i].second)))
-        {
-            //We can splice events together, merging them into one event
-            rtosc_arg_t args[3];
-            args[0] = rtosc_argument(msg, 0);
-            args[1] = rtosc_argument(history[i].second,1);
-            args[2] = rtosc_argument(msg, 2);
+        //the key has been dropped to make space, so start a new step
+        ev.key_seq = dropped + count;
+        ev.flags |= STEP_BEGIN;
+    }
+    if(ev.flags & COMPRESSED)
+        encode(msg, len, shared, ring.data() + ev.offset);
+    else
+        memcpy(ring.data() + ev.offset, msg, len);
+    ev.size = size;
 
-            rtosc_amessage(buf, N, msg, rtosc_argument_string(msg), args);
+    if(ev.flags & STEP_BEGIN)
+        transaction_seq = dropped + count;
+    at(count++) = ev;
+    history_pos++;
+    since_checkpoint++;
+    last_of_hash[hash & (last_of_hash.size()-1)] = dropped + count;
+}
 
-            delete [] history[i].second;
-            history[i].second = buf;
-            history[i].first = now;
+//Find space for a new event at the end of the ring, dropping old steps
+bool UndoHistoryImpl::reserve(size_t len, size_t *offset)
+{
+    if(len > ring.size())
+        return false;
+    for(;;) {
+        if(!count) {
+            *offset = 0;
             return true;
         }
+        if(count < events.size()) {
+            const event_t &oldest = at(0), &newest = at(count-1);
+            size_t head = oldest.offset;
+            size_t tail = newest.offset + newest.size;
+            if(newest.offset >= oldest.offset) {
+                //Used space is [head, tail), so append or wrap around
+                if(ring.size() - tail >= len) {
+                    *offset = tail;
+                    return true;
+                }
+                if(head >= len) {
+                    *offset = 0;
+                    return true;
+                }
+            } else if(head - tail >= len) {
+                //Used space wraps around, [tail, head) is free
+                *offset = tail;
+                return true;
+            }
+        }
+        //steps are dropped as a whole, since later events refer to the key
+        do
+            popFront();
+        while(count && !(at(0).flags & STEP_BEGIN));
     }
-    return false;
 }
 
-void UndoHistoryImpl::clear(void)
+void UndoHistoryImpl::popFront(void)
 {
-    for(auto elm : history)
-        delete [] elm.second;
-    history.clear();
-    history_pos = 0;
+    assert(count);
+    first = (first+1)%events.size();
+    count--;
+    dropped++;
+    if(history_pos)
+        history_pos--;
+    dropCheckpoints(dropped, dropped + count);
 }
 
+void UndoHistoryImpl::setBudget(size_t memory_budget)
+{
+    size_t max_events = memory_budget / UNDO_MIN_EVENT_SIZE + 1;
 
+    //keep the newest steps which fit into the new budget
+    size_t keep = 0, total = 0;
+    for(size_t n = 0; n < count && n < max_events; ) {
+        total += at(count-1-n).size;
+        if(total > memory_budget)
+            break;
+        if(at(count-1-n++).flags & STEP_BEGIN)
+            keep = n;
+    }
+
+    std::vector<char> new_ring(memory_budget);
+    std::vector<event_t> new_events(max_events);
+    size_t offset = 0;
+    for(size_t i = 0; i < keep; ++i) {
+        event_t ev = at(count-keep+i);
+        memcpy(new_ring.data() + offset, ring.data() + ev.offset, ev.size);
+        ev.offset = offset;
+        offset += ev.size;
+        new_events[i] = ev;
+    }
+
+    size_t lost = count - keep;
+    ring.swap(new_ring);
+    events.swap(new_events);
+    first        = 0;
+    count        = keep;
+    dropped     += lost;
+    history_pos  = history_pos > (long)lost ? history_pos - lost : 0;
+    dropCheckpoints(dropped, dropped + count);
+
+    size_t buckets = 1;
+    while(buckets < 2 * max_events)
+        buckets *= 2;
+    last_of_hash.assign(buckets, 0);
+    for(size_t i = 0; i < count; ++i)
+        last_of_hash[at(i).hash & (buckets-1)] = dropped + i + 1;
+}
+
+//Take a checkpoint at the current history position
+bool UndoHistoryImpl::checkpoint(void)
+{
+    if(!ports)
+        return false;
+    size_t seq = dropped + history_pos;
+    while(!checkpoints.empty() && checkpoints.back().seq >= seq)
+        checkpoints.pop_back();
+
+    if(snapshot_buf.size() < snapshot_size)
+        snapshot_buf.resize(snapshot_size);
+    size_t len = subtree_serialize(snapshot_buf.data(), snapshot_size,
+                                   object, ports);
+    if(!len)
+        return false; //does not fit into snapshot_size
+
+    checkpoint_t cp;
+    if(checkpoints.size() >= max_checkpoints) {
+        cp = std::move(checkpoints.front());
+        checkpoints.pop_front();
+    }
+    cp.seq   = seq;
+    cp.nmsgs = rtosc_bundle_elements(snapshot_buf.data(), len);
+    cp.data.assign(snapshot_buf.data(), snapshot_buf.data() + len);
+    if(max_checkpoints)
+        checkpoints.push_back(std::move(cp));
+    since_checkpoint = 0;
+    return true;
+}
+
+//Take a checkpoint if the interval has passed
+void UndoHistoryImpl::autoCheckpoint(void)
+{
+    if(ports && checkpoint_interval && !transaction_depth &&
+       since_checkpoint >= checkpoint_interval)
+        checkpoint();
+}
+
+//Drop all checkpoints outside of [min_seq, max_seq]
+void UndoHistoryImpl::dropCheckpoints(size_t min_seq, size_t max_seq)
+{
+    while(!checkpoints.empty() && checkpoints.front().seq < min_seq)
+        checkpoints.pop_front();
+    while(!checkpoints.empty() && checkpoints.back().seq > max_seq)
+        checkpoints.pop_back();
+}
+
+void UndoHistoryImpl::restore(const checkpoint_t &cp)
+{
+    //iterate the bundle manually, rtosc_bundle_fetch() would be quadratic
+    const char *data = cp.data.data();
+    size_t pos = 16; //"#bundle" and the time tag
+    for(size_t i = 0; i < cp.nmsgs; ++i) {
+        const uint8_t *len_p = (const uint8_t*)data + pos;
+        uint32_t len = (uint32_t)len_p[0] << 24 | (uint32_t)len_p[1] << 16 |
+                       (uint32_t)len_p[2] << 8 | len_p[3];
+        cb(data + pos + 4);
+        pos += 4 + len;
+    }
+}
 
 void UndoHistory::seekHistory(int distance)
 {
     //TODO print out the events that would need to take place to get to the
     //final destination
-    
-    //TODO limit the distance to be to applicable sizes
-    //ie ones that do not exceed the known history/future
-    long dest = impl->history_pos + distance;
-    if(dest < 0)
-        distance -= dest;
-    if(dest > (long) impl->history.size())
-        distance  = impl->history.size() - impl->history_pos;
-    if(!distance)
+
+    //Find the destination, moving by whole undo steps
+    long pos = impl->history_pos;
+    long dest = pos;
+    for(; distance < 0 && dest > 0; ++distance)
+        do
+            --dest;
+        while(dest > 0 && !impl->isStepBegin(dest));
+    for(; distance > 0 && dest < (long) impl->count; --distance)
+        do
+            ++dest;
+        while(!impl->isStepBegin(dest));
+    if(dest == pos)
         return;
-    
+
+    //A checkpoint before the destination can be cheaper than stepping
+    const UndoHistoryImpl::checkpoint_t *best = nullptr;
+    size_t dest_seq = impl->dropped + dest;
+    size_t cost = dest > pos ? dest - pos : pos - dest;
+    for(const auto &cp : impl->checkpoints) {
+        if(cp.seq > dest_seq)
+            break;
+        if(cp.nmsgs + dest_seq - cp.seq < cost) {
+            best = &cp;
+            cost = cp.nmsgs + dest_seq - cp.seq;
+        }
+    }
+    if(best) {
+        impl->restore(*best);
+        impl->history_pos = best->seq - impl->dropped;
+    }
+
     //TODO account for traveling back in time
-    if(distance<0)
-        while(distance++)
-            impl->rewind(impl->history[--impl->history_pos].second);
-    else
-        while(distance--)
-            impl->replay(impl->history[impl->history_pos++].second);
+    while(impl->history_pos > dest)
+        impl->rewind(impl->message(--impl->history_pos));
+    while(impl->history_pos < dest)
+        impl->replay(impl->message(impl->history_pos++));
 }
 
 unsigned UndoHistory::getPos(void) const
@@ -172,16 +639,183 @@ unsigned UndoHistory::getPos(void) const
 
 const char *UndoHistory::getHistory(int i) const
 {
-    return impl->history[i].second;
+    return impl->message(i);
 }
 
 size_t UndoHistory::size() const
 {
-    return impl->history.size();
+    return impl->count;
 }
 
 void UndoHistory::setCallback(std::function<void(const char*)> cb)
 {
     impl->cb = cb;
 }
+
+void UndoHistory::setMemoryBudget(size_t bytes)
+{
+    impl->setBudget(bytes);
+}
+
+size_t UndoHistory::getMemoryBudget(void) const
+{
+    return impl->ring.size();
+}
+
+void UndoHistory::beginTransaction(void)
+{
+    if(!impl->transaction_depth++)
+        impl->transaction_seq = (size_t)-1;
+}
+
+void UndoHistory::endTransaction(void)
+{
+    assert(impl->transaction_depth > 0);
+    if(impl->transaction_depth && !--impl->transaction_depth)
+        impl->autoCheckpoint();
+}
+
+void UndoHistory::setCheckpointSource(void *object, Ports *ports,
+                                      size_t snapshot_size)
+{
+    impl->object = object;
+    impl->ports = ports;
+    impl->snapshot_size = snapshot_size;
+    impl->checkpoints.clear();
+    impl->since_checkpoint = 0;
+}
+
+void UndoHistory::setCheckpointInterval(size_t interval, size_t max_checkpoints)
+{
+    impl->checkpoint_interval = interval;
+    impl->max_checkpoints = max_checkpoints;
+    while(impl->checkpoints.size() > max_checkpoints)
+        impl->checkpoints.pop_front();
+}
+
+bool UndoHistory::checkpoint(void)
+{
+    return impl->checkpoint();
+}
+
+size_t UndoHistory::numCheckpoints(void) const
+{
+    return impl->checkpoints.size();
+}
+
+/*
+ * Single producer single consumer ring of recorded events. Each record is
+ * a header followed by the message, padded to the header's alignment. If a
+ * record does not fit at the end of the ring, a wrap marker is written and
+ * the record starts at the beginning.
+ */
+struct record_header_t
+{
+    uint32_t size; //!< size of the whole record, or UNDO_WRAP
+    uint32_t unused;
+    int64_t  time;
+};
+
+#define UNDO_WRAP 0xffffffffu
+
+class UndoRecorderImpl
+{
+    public:
+        UndoRecorderImpl(UndoHistory &history_, size_t buffer_size)
+            :history(history_), buffer(pad(buffer_size ? buffer_size : 1)),
+             write_pos(0), read_pos(0), lost(0)
+        {}
+
+        static size_t pad(size_t len)
+        {
+            const size_t align = sizeof(record_header_t);
+            return (len + align - 1) / align * align;
+        }
+
+        UndoHistory &history;
+        std::vector<char> buffer;
+        //positions only increase, the offset in the buffer is pos % size
+        std::atomic<size_t> write_pos;
+        std::atomic<size_t> read_pos;
+        std::atomic<size_t> lost;
+};
+
+UndoRecorder::UndoRecorder(UndoHistory &history, size_t buffer_size)
+{
+    impl = new UndoRecorderImpl(history, buffer_size);
+}
+
+UndoRecorder::~UndoRecorder(void)
+{
+    delete impl;
+}
+
+bool UndoRecorder::record(const char *msg)
+{
+    const size_t size = impl->buffer.size();
+    const size_t len  = rtosc_message_length(msg, -1);
+    const size_t need = UndoRecorderImpl::pad(sizeof(record_header_t) + len);
+    size_t w = impl->write_pos.load(std::memory_order_relaxed);
+    const size_t r = impl->read_pos.load(std::memory_order_acquire);
+
+    //records are never split, so skip the rest of the buffer if needed
+    const size_t offset = w % size;
+    const size_t skip   = size - offset < need ? size - offset : 0;
+    if(len > UINT32_MAX || (w - r) + skip + need > size) {
+        impl->lost.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+
+    char *buf = impl->buffer.data();
+    record_header_t hdr;
+    if(skip) {
+        hdr.size = UNDO_WRAP;
+        memcpy(buf + offset, &hdr, sizeof(hdr.size));
+        w += skip;
+    }
+    hdr.size   = need;
+    hdr.unused = 0;
+    hdr.time   = monotonicTime();
+    memcpy(buf + w % size, &hdr, sizeof(hdr));
+    memcpy(buf + w % size + sizeof(hdr), msg, len);
+    impl->write_pos.store(w + need, std::memory_order_release);
+    return true;
+}
+
+size_t UndoRecorder::drain(void)
+{
+    const size_t size = impl->buffer.size();
+    size_t r = impl->read_pos.load(std::memory_order_relaxed);
+    const size_t w = impl->write_pos.load(std::memory_order_acquire);
+    const char *buf = impl->buffer.data();
+
+    //all records up to w are handled in one batch, and the space is
+    //released to the writer afterwards
+    size_t count = 0;
+    while(r != w) {
+        record_header_t hdr;
+        memcpy(&hdr.size, buf + r % size, sizeof(hdr.size));
+        if(hdr.size == UNDO_WRAP) {
+            r += size - r % size;
+            continue;
+        }
+        memcpy(&hdr, buf + r % size, sizeof(hdr));
+        impl->history.impl->record(hdr.time,
+                                   buf + r % size + sizeof(hdr), true);
+        r += hdr.size;
+        ++count;
+    }
+    impl->read_pos.store(r, std::memory_order_release);
+
+    //the drained events have already been applied, so the state only
+    //matches the history after the whole batch
+    if(count)
+        impl->history.impl->autoCheckpoint();
+    return count;
+}
+
+size_t UndoRecorder::lost(void) const
+{
+    return impl->lost.load(std::memory_order_relaxed);
+}
 };
@@ -1,3 +1,4 @@
+#include <assert.h>
 #include <string.h>
 #include "util.h"
 
@@ -6,3 +7,191 @@ char *fast_strcpy(char *dest, const char *src, size_t buffersize)
     *dest = 0;
     return strncat(dest, src, buffersize-1);
 }
+
+// integer type for the exact computations in fast_print_fixed()
+#ifdef __SIZEOF_INT128__
+typedef unsigned __int128 wide_uint;
+#else
+typedef uint64_t wide_uint;
+#endif
+static const int wide_uint_bits = sizeof(wide_uint) * 8;
+
+//! write the decimal digits of @p val in reverse order, return the count
+static size_t digits_reversed(char *rev, wide_uint val, size_t min_digits)
+{
+    size_t n = 0;
+    // use 64 bit divisions whenever possible, they are much cheaper
+    for(; (val >> 32) >> 32; val /= 10)
+        rev[n++] = '0' + (char)(val % 10);
+    for(uint64_t v = (uint64_t)val; v; v /= 10)
+        rev[n++] = '0' + (char)(v % 10);
+    for(; n < min_digits; )
+        rev[n++] = '0';
+    return n;
+}
+
+//! copy @p n reversed digits from @p rev to @p dest in correct order
+static char *put_digits(char *dest, const char *rev, size_t n)
+{
+    while(n)
+        *dest++ = rev[--n];
+    return dest;
+}
+
+size_t fast_print_int64(char *dest, size_t buffersize, int64_t val)
+{
+    char rev[20];
+    uint64_t absval = (val < 0) ? (0 - (uint64_t)val) : (uint64_t)val;
+    size_t n = digits_reversed(rev, absval, 1);
+    size_t len = n + (val < 0);
+
+    if(len < buffersize)
+    {
+        char *d = dest;
+        if(val < 0)
+            *d++ = '-';
+        d = put_digits(d, rev, n);
+        *d = 0;
+    }
+    else if(buffersize)
+    {
+        // truncate like snprintf
+        char tmp[21];
+        fast_print_int64(tmp, sizeof(tmp), val);
+        memcpy(dest, tmp, buffersize - 1);
+        dest[buffersize - 1] = 0;
+    }
+    return len;
+}
+
+size_t fast_print_fixed(char *dest, size_t buffersize,
+                        double val, int precision)
+{
+    uint64_t bits;
+    memcpy(&bits, &val, sizeof(bits));
+    int negative = (int)(bits >> 63);
+    int biased_exp = (int)((bits >> 52) & 0x7ff);
+    uint64_t mant = bits & ((UINT64_C(1) << 52) - 1);
+
+    if(biased_exp == 0x7ff || precision < 0)
+        return 0; // inf or nan
+    // val = mant * 2^exp
+    int exp;
+    if(biased_exp) {
+        mant |= (UINT64_C(1) << 52);
+        exp = biased_exp - 1075;
+    }
+    else
+        exp = -1074;
+    if(!mant)
+        exp = 0;
+    for(; exp < 0 && !(mant & 1); mant >>= 1, ++exp) ;
+
+    // compute intpart and fracpart such that
+    // round(val * 10^precision) = intpart * 10^precision + fracpart
+    wide_uint pow10 = 1;
+    for(int i = 0; i < precision; ++i)
+    {
+        if(pow10 > ((wide_uint)-1) / 10)
+            return 0;
+        pow10 *= 10;
+    }
+
+    uint64_t intpart;
+    wide_uint fracpart;
+    if(exp >= 0)
+    {
+        if(exp > 63 || (mant >> (63 - exp)))
+            return 0; // does not fit into 64 bit
+        intpart = mant << exp;
+        fracpart = 0;
+    }
+    else
+    {
+        if(mant > ((wide_uint)-1) / pow10)
+            return 0;
+        wide_uint num = mant * pow10;
+        int shift = -exp;
+        wide_uint rounded;
+        if(shift > wide_uint_bits)
+            rounded = 0; // num < 2^(shift-1), i.e. < 0.5
+        else if(shift == wide_uint_bits)
+        {
+            // round to nearest, ties to even (0 is even)
+            wide_uint half = (wide_uint)1 << (wide_uint_bits - 1);
+            rounded = (num > half) ? 1 : 0;
+        }
+        else
+        {
+            wide_uint half = (wide_uint)1 << (shift - 1);
+            wide_uint rem = num & ((half << 1) - 1);
+            rounded = num >> shift;
+            // round to nearest, ties to even
+            if(rem > half || (rem == half && (rounded & 1)))
+                ++rounded;
+        }
+        intpart = (uint64_t)(rounded / pow10);
+        fracpart = rounded % pow10;
+    }
+
+    char intrev[20];
+    size_t intlen = digits_reversed(intrev, intpart, 1);
+    size_t len = negative + intlen + 1 + (size_t)precision;
+    if(len >= buffersize)
+        return 0;
+
+    char *d = dest;
+    if(negative)
+        *d++ = '-';
+    d = put_digits(d, intrev, intlen);
+    *d++ = '.';
+    {
+        // precision is limited by the size of pow10, so this is enough
+        char fracrev[40];
+        d = put_digits(d, fracrev,
+                       digits_reversed(fracrev, fracpart, precision));
+    }
+    *d = 0;
+    return len;
+}
+
+size_t fast_print_hexfloat(char *dest, size_t buffersize, double val)
+{
+    static const char hexdigits[] = "0123456789abcdef";
+    uint64_t bits;
+    memcpy(&bits, &val, sizeof(bits));
+    int negative = (int)(bits >> 63);
+    int biased_exp = (int)((bits >> 52) & 0x7ff);
+    uint64_t mant = bits & ((UINT64_C(1) << 52) - 1);
+
+    if(biased_exp == 0x7ff || (!biased_exp && mant))
+        return 0; // inf, nan or subnormal
+
+    // "-0x1.fffffffffffffp-1022" is the longest possible result
+    char tmp[32];
+    char *d = tmp;
+    if(negative)
+        *d++ = '-';
+    *d++ = '0';
+    *d++ = 'x';
+    *d++ = biased_exp ? '1' : '0';
+    if(mant)
+    {
+        *d++ = '.';
+        for(int shift = 48; mant; shift -= 4)
+        {
+            *d++ = hexdigits[(mant >> shift) & 0xf];
+            mant &= (UINT64_C(1) << shift) - 1;
+        }
+    }
+    *d++ = 'p';
+    int exp = biased_exp ? (biased_exp - 1023) : 0;
+    *d++ = (exp < 0) ? '-' : '+';
+    d += fast_print_int64(d, tmp + sizeof(tmp) - d, exp < 0 ? -exp : exp);
+
+    size_t len = d - tmp;
+    if(len >= buffersize)
+        return 0;
+    memcpy(dest, tmp, len + 1);
+    return len;
+}
@@ -33,6 +33,7 @@
 #define UTIL_H
 
 #include <stdlib.h>
+#include <stdint.h>
 
 #ifdef __cplusplus
 extern "C" {
@@ -51,6 +52,48 @@ extern "C" {
  */
 char *fast_strcpy(char *dest, const char *src, size_t buffersize);
 
+/**
+ * Print an integer in decimal notation, like printf's "%" PRId64
+ * @param dest Destination memory location
+ * @param buffersize Maximal number of bytes that you can write to @p dest ,
+ *   including the terminating zero byte
+ * @param val The value to print
+ * @return The number of bytes that would have been written if @p buffersize
+ *   was large enough, excluding the terminating zero byte. Like snprintf,
+ *   the output is truncated if @p buffersize is too small.
+ */
+size_t fast_print_int64(char *dest, size_t buffersize, int64_t val);
+
+/**
+ * Print a floating point number like printf's "%#.*f"
+ *
+ * The result is exact, i.e. it is rounded like the C library does it.
+ * Values that can not be printed exactly with integer arithmetics (infinite,
+ * NaN, very large or precision too high) are not handled.
+ *
+ * @param dest Destination memory location
+ * @param buffersize Maximal number of bytes that you can write to @p dest ,
+ *   including the terminating zero byte
+ * @param val The value to print (floats are converted losslessly)
+ * @param precision Number of digits after the decimal point
+ * @return The number of bytes written, excluding the terminating zero byte,
+ *   or 0 if the value was not handled (@p dest is then left unchanged)
+ */
+size_t fast_print_fixed(char *dest, size_t buffersize,
+                        double val, int precision);
+
+/**
+ * Print a floating point number like printf's "%a", but without trailing
+ *   zeroes in the mantissa (like glibc does it)
+ *
+ * Infinite, NaN and subnormal values are not handled.
+ *
+ * @return The number of bytes written, excluding the terminating zero byte,
+ *   or 0 if the value was not handled (@p dest is then left unchanged)
+ * @see fast_print_fixed
+ */
+size_t fast_print_hexfloat(char *dest, size_t buffersize, double val);
+
 /*TODO: Add documentation?*/
 #ifdef _MSC_VER
 #define STACKALLOC(type, name, size) type *name = (type*)(_alloca((size)*sizeof(type)))
@@ -1,5 +1,7 @@
 #include <assert.h>
+#include <string.h>
 #include <rtosc/rtosc.h>
+#include <rtosc/arg-ext.h>
 #include <rtosc/arg-val-math.h>
 #include <rtosc/arg-val-cmp.h>
 #include "common.h"
@@ -114,6 +116,112 @@ void special_null_test()
     assert_char_eq(a.type, 'F', "(0)'F' (type)", __LINE__);
 }
 
+//! range with delta, start and @p num elements
+void make_range(rtosc_arg_val_t* range, char type, int32_t num,
+                double delta, double start)
+{
+    range[0].type = '-';
+    rtosc_av_rep_num_set(range, num);
+    rtosc_av_rep_has_delta_set(range, 1);
+    rtosc_arg_val_from_double(range + 1, type, delta);
+    rtosc_arg_val_from_double(range + 2, type, start);
+}
+
+//! compare rtosc_arg_val_range_expand with rtosc_arg_val_range_arg
+void test_range_expand(char type, double delta, double start, int32_t from)
+{
+    constexpr size_t num = 1000;
+    rtosc_arg_val_t range[3];
+    make_range(range, type, (int32_t)(from + num), delta, start);
+
+    double out[num]; // large enough for all types
+    size_t expanded = rtosc_arg_val_range_expand(range, from, num, out);
+
+    int mismatches = 0;
+    for(size_t k = 0; k < num; ++k)
+    {
+        rtosc_arg_val_t exp;
+        rtosc_arg_val_range_arg(range, from + (int)k, &exp);
+        switch(type)
+        {
+            case 'c':
+            case 'i':
+                mismatches += ((int32_t*)out)[k] != exp.val.i; break;
+            case 'h':
+                mismatches += ((int64_t*)out)[k] != exp.val.h; break;
+            case 'f':
+                mismatches += !!memcmp((float*)out + k, &exp.val.f, 4); break;
+            case 'd':
+                mismatches += !!memcmp(out + k, &exp.val.d, 8); break;
+        }
+    }
+
+    char str[32];
+    snprintf(str, 32, "expand range '%c'", type);
+    assert_int_eq(num, expanded, str, __LINE__);
+    assert_int_eq(0, mismatches, str, __LINE__);
+}
+
+void test_range_expand_special()
+{
+    // delta-less range
+    rtosc_arg_val_t range[2];
+    range[0].type = '-';
+    rtosc_av_rep_num_set(range, 3);
+    rtosc_av_rep_has_delta_set(range, 0);
+    rtosc_arg_val_from_double(range + 1, 'f', 0.5);
+    float out[3] = { 0.0f, 0.0f, 0.0f };
+    assert_int_eq(3, rtosc_arg_val_range_expand(range, 0, 3, out),
+                  "expand delta-less range", __LINE__);
+    assert_true(out[0] == 0.5f && out[1] == 0.5f && out[2] == 0.5f,
+                "expand delta-less range (values)", __LINE__);
+
+    // unsupported types
+    range[1].type = 'T';
+    range[1].val.T = 1;
+    assert_int_eq(0, rtosc_arg_val_range_expand(range, 0, 3, out),
+                  "expand range of unsupported type", __LINE__);
+}
+
+void test_run_length()
+{
+    rtosc_arg_val_t av[8], delta;
+    for(int i = 0; i < 8; ++i)
+        rtosc_arg_val_from_int(av + i, 'i', 3 * i);
+    rtosc_arg_val_from_int(&delta, 'i', 3);
+    assert_int_eq(8, rtosc_arg_val_run_length(av, 8, &delta),
+                  "run length with delta", __LINE__);
+    assert_int_eq(1, rtosc_arg_val_run_length(av, 8, NULL),
+                  "run length without delta (no run)", __LINE__);
+    assert_int_eq(0, rtosc_arg_val_run_length(av, 0, NULL),
+                  "run length of nothing", __LINE__);
+
+    av[5].val.i = 0;
+    assert_int_eq(5, rtosc_arg_val_run_length(av, 8, &delta),
+                  "run length with delta, broken", __LINE__);
+    av[5].type = 'h';
+    av[5].val.h = 15;
+    assert_int_eq(5, rtosc_arg_val_run_length(av, 8, &delta),
+                  "run length ends at type change", __LINE__);
+
+    for(int i = 0; i < 8; ++i)
+        rtosc_arg_val_from_double(av + i, 'd', (i < 6) ? 0.25 : 0.5);
+    assert_int_eq(6, rtosc_arg_val_run_length(av, 8, NULL),
+                  "run length of equal doubles", __LINE__);
+
+    for(int i = 0; i < 8; ++i)
+        rtosc_arg_val_from_int(av + i, 'T', i < 7);
+    assert_int_eq(7, rtosc_arg_val_run_length(av, 8, NULL),
+                  "run length of equal bools", __LINE__);
+
+    for(int i = 0; i < 8; ++i) {
+        av[i].type = 's';
+        av[i].val.s = (i < 4) ? "abc" : "def";
+    }
+    assert_int_eq(4, rtosc_arg_val_run_length(av, 8, NULL),
+                  "run length of equal strings", __LINE__);
+}
+
 /*
     all tests
 */
@@ -186,6 +294,17 @@ int main()
 
     // rtosc_arg_val_range_arg is being (indirectly)
     // tested in the pretty-format tests
+    test_range_expand('i', 3, -42, 0);
+    test_range_expand('i', -7, 0x7ffffff0, 5);
+    test_range_expand('c', 1, 'a', 0);
+    test_range_expand('h', 4000000000, -8000000000, 3);
+    test_range_expand('f', 0.1, -3.3, 0);
+    test_range_expand('f', 1.0/3, 7, 17);
+    test_range_expand('d', 0.1, -3.3, 0);
+    test_range_expand('d', 1e-7, 1e10, 1000);
+    test_range_expand_special();
+
+    test_run_length();
 
     return test_summary();
 }
@@ -0,0 +1,249 @@
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include <rtosc/rtosc.h>
+#include <rtosc/ports.h>
+#include <rtosc/port-sugar.h>
+#include <rtosc/thread-link.h>
+#include <rtosc/broadcast-coalescer.h>
+#include "common.h"
+
+using namespace rtosc;
+
+struct Filter
+{
+    float cutoff = 0;
+    int   mode = 0;
+    static Ports ports;
+};
+
+#define rObject Filter
+Ports Filter::ports = {
+    rParamF(cutoff, rLinear(0, 1), "cutoff"),
+    rParamI(mode, rLinear(0, 3), "mode"),
+};
+#undef rObject
+
+//! RtData which passes all broadcasts to a coalescer
+class CoalescingRtData : public RtData
+{
+        BroadcastCoalescer &coalescer;
+        char loc_buffer[128];
+    public:
+        CoalescingRtData(BroadcastCoalescer &c, void *object)
+            : coalescer(c)
+        {
+            memset(loc_buffer, 0, sizeof(loc_buffer));
+            loc = loc_buffer;
+            loc_size = sizeof(loc_buffer);
+            obj = object;
+        }
+        void broadcast(const char *msg) override { coalescer.broadcast(msg); }
+        using RtData::broadcast;
+};
+
+static char buffer[1024];
+
+static const char *message(const char *path, const char *args, ...)
+{
+    va_list va;
+    va_start(va, args);
+    rtosc_vmessage(buffer, sizeof(buffer), path, args, va);
+    va_end(va);
+    return buffer;
+}
+
+//! All messages in the link, bundles are unpacked
+static std::vector<std::string> read_all(ThreadLink &link, int *bundles = 0)
+{
+    std::vector<std::string> res;
+    while(link.hasNext())
+    {
+        const char *msg = link.read();
+        if(rtosc_bundle_p(msg))
+        {
+            if(bundles)
+                ++*bundles;
+            for(size_t i = 0; i < rtosc_bundle_elements(msg, -1); ++i)
+            {
+                const char *elm = rtosc_bundle_fetch(msg, i);
+                res.emplace_back(elm, rtosc_message_length(elm, -1));
+            }
+        }
+        else
+            res.emplace_back(msg, rtosc_message_length(msg, -1));
+    }
+    return res;
+}
+
+static std::string as_string(const char *msg)
+{
+    return std::string(msg, rtosc_message_length(msg, -1));
+}
+
+void test_latest_values()
+{
+    ThreadLink link(1024, 16);
+    BroadcastCoalescer coalescer(link);
+
+    for(int i = 0; i < 100; ++i)
+        coalescer.broadcast(message("/a", "i", i));
+    coalescer.broadcast(message("/b", "f", 1.5f));
+    coalescer.broadcast(message("/a", "s", "same path, other type"));
+    coalescer.broadcast(message("/a", "i", 5));
+    coalescer.broadcast(message("/c", "s", "short"));
+    coalescer.broadcast(message("/c", "s", "this is a longer string"));
+    assert_false(link.hasNext(), "nothing forwarded during the block",
+                 __LINE__);
+
+    coalescer.flush();
+    int bundles = 0;
+    std::vector<std::string> msgs = read_all(link, &bundles);
+    assert_int_eq(1, bundles, "one bundle per block", __LINE__);
+    assert_int_eq(4, msgs.size(), "one message per path and type", __LINE__);
+    if(msgs.size() == 4)
+    {
+        assert_true(msgs[0] == as_string(message("/a", "i", 5)),
+                    "latest value, order of first broadcast", __LINE__);
+        assert_true(msgs[1] == as_string(message("/b", "f", 1.5f)),
+                    "float value", __LINE__);
+        assert_true(msgs[2] ==
+                    as_string(message("/a", "s", "same path, other type")),
+                    "other types are kept", __LINE__);
+        assert_true(msgs[3] ==
+                    as_string(message("/c", "s", "this is a longer string")),
+                    "longer messages replace shorter ones", __LINE__);
+    }
+    assert_int_eq(105, coalescer.received(), "received", __LINE__);
+    assert_int_eq(4, coalescer.forwarded(), "forwarded", __LINE__);
+    assert_int_eq(101, coalescer.saved(), "saved", __LINE__);
+
+    // next block
+    coalescer.flush();
+    assert_false(link.hasNext(), "empty blocks send nothing", __LINE__);
+    coalescer.broadcast(message("/a", "i", 7));
+    coalescer.broadcast(message("/a", "i", 8));
+    coalescer.flush();
+    assert_true(link.hasNext() && !rtosc_bundle_p(link.read()) &&
+                as_string(link.peak()) == as_string(message("/a", "i", 8)),
+                "single messages are not bundled", __LINE__);
+}
+
+void test_changes_only()
+{
+    ThreadLink link(1024, 16);
+    BroadcastCoalescer coalescer(link);
+    coalescer.changes_only = true;
+
+    coalescer.broadcast(message("/a", "i", 1));
+    coalescer.broadcast(message("/b", "i", 1));
+    coalescer.flush();
+    assert_int_eq(2, read_all(link).size(), "first values forwarded",
+                  __LINE__);
+
+    coalescer.broadcast(message("/a", "i", 3));
+    coalescer.broadcast(message("/a", "i", 1)); // back to the old value
+    coalescer.broadcast(message("/b", "i", 2));
+    coalescer.flush();
+    std::vector<std::string> msgs = read_all(link);
+    assert_true(msgs.size() == 1 &&
+                msgs[0] == as_string(message("/b", "i", 2)),
+                "only changed values forwarded", __LINE__);
+}
+
+void test_full_link()
+{
+    ThreadLink link(256, 1);
+    BroadcastCoalescer coalescer(link);
+    coalescer.changes_only = true;
+    while(link.raw_write(message("/fill", "i", 0))) ;
+
+    coalescer.broadcast(message("/vol", "f", 0.5f));
+    coalescer.flush();
+    assert_int_eq(0, coalescer.forwarded(), "nothing forwarded into full link",
+                  __LINE__);
+    assert_int_eq(1, coalescer.dropped(), "message dropped", __LINE__);
+    read_all(link);
+
+    // the dropped value has never arrived, so it is not unchanged
+    coalescer.broadcast(message("/vol", "f", 0.5f));
+    coalescer.flush();
+    std::vector<std::string> msgs = read_all(link);
+    assert_true(msgs.size() == 1 &&
+                msgs[0] == as_string(message("/vol", "f", 0.5f)),
+                "dropped value forwarded again", __LINE__);
+    assert_int_eq(1, coalescer.forwarded(), "message forwarded", __LINE__);
+
+    // the same for bundles
+    while(link.raw_write(message("/fill", "i", 0))) ;
+    coalescer.broadcast(message("/a", "i", 1));
+    coalescer.broadcast(message("/b", "i", 1));
+    coalescer.flush();
+    assert_int_eq(3, coalescer.dropped(), "bundle dropped", __LINE__);
+    read_all(link);
+    coalescer.broadcast(message("/a", "i", 1));
+    coalescer.broadcast(message("/b", "i", 1));
+    coalescer.flush();
+    assert_int_eq(2, read_all(link).size(), "dropped bundle forwarded again",
+                  __LINE__);
+    assert_int_eq(0, coalescer.saved(), "drops are not saved", __LINE__);
+}
+
+void test_overflow()
+{
+    ThreadLink link(1024, 64);
+    // 4 paths per block, bundles of at most 64 bytes
+    BroadcastCoalescer coalescer(link, 4, 1024, 64);
+
+    char path[16];
+    for(int i = 0; i < 10; ++i) {
+        snprintf(path, sizeof(path), "/p%d", i);
+        coalescer.broadcast(message(path, "i", i));
+    }
+    coalescer.flush();
+    std::vector<std::string> msgs = read_all(link);
+    assert_int_eq(10, msgs.size(), "all paths forwarded", __LINE__);
+    int mismatches = 0;
+    for(int i = 0; i < 10 && i < (int)msgs.size(); ++i)
+        mismatches += rtosc_argument(msgs[i].data(), 0).i != i;
+    assert_int_eq(0, mismatches, "in order", __LINE__);
+    assert_true(coalescer.overflows() > 0, "overflows counted", __LINE__);
+    assert_true(coalescer.bundles() > 2, "bundle size is respected",
+                __LINE__);
+}
+
+void test_ports()
+{
+    ThreadLink link(1024, 16);
+    BroadcastCoalescer coalescer(link);
+    Filter filter;
+    CoalescingRtData d(coalescer, &filter);
+
+    for(int i = 0; i < 64; ++i)
+    {
+        Filter::ports.dispatch(message("cutoff", "f", i / 64.f), d, false);
+        Filter::ports.dispatch(message("mode", "i", i % 4), d, false);
+    }
+    coalescer.flush();
+    std::vector<std::string> msgs = read_all(link);
+    assert_int_eq(2, msgs.size(), "one broadcast per parameter", __LINE__);
+    if(msgs.size() == 2)
+    {
+        assert_flt_eq(63 / 64.f, rtosc_argument(msgs[0].data(), 0).f,
+                      "latest cutoff", __LINE__);
+        assert_int_eq(3, rtosc_argument(msgs[1].data(), 0).i,
+                      "latest mode", __LINE__);
+    }
+    assert_int_eq(126, coalescer.saved(), "broadcasts saved", __LINE__);
+}
+
+int main()
+{
+    test_latest_values();
+    test_changes_only();
+    test_full_link();
+    test_overflow();
+    test_ports();
+    return test_summary();
+}
@@ -3,6 +3,8 @@
 #include <rtosc/default-value.h>
 #include <rtosc/savefile.h>
 #include <rtosc/port-sugar.h>
+#include <rtosc/ports-runtime.h>
+#include <cstring>
 
 #include "common.h"
 
@@ -469,9 +471,44 @@ void savefiles()
 #undef MAKE_TESTFILE
 }
 
+static const uint8_t blob_data[] = {1, 2, 3, 4, 5};
+
+static const Ports blob_ports = {
+    {"blob:", rDoc("..."), NULL, [](const char*, RtData& d) {
+        d.reply(d.loc, "b", (int32_t)sizeof(blob_data), blob_data);
+    }}
+};
+
+//! both overloads of get_value_from_runtime() keep blobs valid
+void runtime_blobs()
+{
+    char loc[128] = "/blob";
+    rtosc_arg_val_t av;
+    const Port& port = blob_ports.ports.front();
+
+    std::vector<std::vector<char>> scratch;
+    size_t n = helpers::get_value_from_runtime(nullptr, port, sizeof(loc),
+                                               loc, "blob", 128, 1, &av,
+                                               &scratch);
+    assert_true(n == 1 && scratch.size() == 1 &&
+                av.val.b.data == (uint8_t*)scratch[0].data() &&
+                !memcmp(av.val.b.data, blob_data, sizeof(blob_data)),
+                "blob copied to scratch buffers", __LINE__);
+
+    rtosc_arena_t arena;
+    rtosc_arena_init(&arena, 64);
+    n = helpers::get_value_from_runtime(nullptr, port, sizeof(loc), loc,
+                                        "blob", 128, 1, &av, &arena);
+    assert_true(n == 1 && av.val.b.data != blob_data &&
+                !memcmp(av.val.b.data, blob_data, sizeof(blob_data)),
+                "blob copied to arena", __LINE__);
+    rtosc_arena_destroy(&arena);
+}
+
 int main()
 {
     port_sugar();
+    runtime_blobs();
 
     canonical_values();
     simple_default_values();
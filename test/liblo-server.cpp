@@ -36,6 +36,13 @@ void liblo_server::on_recv(const char *path, const char *types,
             std::cout << "   - exp. arg " << i-1 << ": " << (*exp_strs)[i] << std::endl;
     }
 #endif
+    if(keeping)
+    {
+        std::vector<char> buffer(lo_message_length(msg, path));
+        lo_message_serialise(msg, path, buffer.data(), nullptr);
+        keep(std::move(buffer));
+        return;
+    }
     if(waiting && exp_paths_n_args[0].size())
     {
         _replied_path = 0;
@@ -122,5 +129,15 @@ bool liblo_server::_wait_for_reply(std::vector<char>* buffer,
     return tries_left && timeout;
 }
 
+bool liblo_server::receive(int timeout_msecs)
+{
+    keeping = true;
+    // wait for the first message, then take all which have arrived
+    int n = lo_server_recv_noblock(srv, timeout_msecs);
+    while(n)
+        n = lo_server_recv_noblock(srv, 0);
+    keeping = false;
+    return true;
 }
 
+}
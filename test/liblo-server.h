@@ -30,6 +30,8 @@ public:
 
     void vinit(const char* target_url) override;
 
+    bool receive(int timeout_msecs) override;
+
     using server::server;
 };
 
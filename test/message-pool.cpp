@@ -0,0 +1,175 @@
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include <rtosc/rtosc.h>
+#include <rtosc/ports.h>
+#include <rtosc/port-sugar.h>
+#include <rtosc/message-pool.h>
+#include <rtosc/savefile.h>
+#include <rtosc/subtree-serialize.h>
+#include "common.h"
+
+using namespace rtosc;
+
+void test_size_classes()
+{
+    MessagePool pool({{1024, 1}, {64, 2}});
+    assert_int_eq(1024, pool.max_size(), "largest size", __LINE__);
+
+    MessagePool::buffer a = pool.acquire(10);
+    MessagePool::buffer b = pool.acquire(64);
+    assert_true(a && b, "small buffers acquired", __LINE__);
+    assert_int_eq(64, b.size(), "smallest fitting class used", __LINE__);
+    assert_int_eq(0, pool.spilled(), "nothing spilled yet", __LINE__);
+
+    MessagePool::buffer c = pool.acquire(10);
+    assert_int_eq(1024, c.size(), "larger class used when exhausted",
+                  __LINE__);
+    assert_int_eq(1, pool.spilled(), "spill counted", __LINE__);
+
+    MessagePool::buffer d = pool.acquire(10);
+    assert_false(!!d, "empty buffer when exhausted", __LINE__);
+    assert_false(!!pool.acquire(2000), "empty buffer when too large",
+                 __LINE__);
+    assert_int_eq(2, pool.failed(), "failures counted", __LINE__);
+    assert_int_eq(3, pool.in_use(), "buffers in use", __LINE__);
+
+    char *old = a.data();
+    a.release();
+    d = pool.acquire(10);
+    assert_ptr_eq(old, d.data(), "released buffer reused", __LINE__);
+
+    {
+        MessagePool::buffer moved = std::move(b);
+        assert_false(!!b, "moved-from buffer is empty", __LINE__);
+    }
+    assert_int_eq(2, pool.in_use(), "buffer released on destruction",
+                  __LINE__);
+    assert_int_eq(3, pool.high_water(), "high water mark", __LINE__);
+    assert_int_eq(4, pool.acquired(), "acquisitions counted", __LINE__);
+
+    pool.reset_stats();
+    assert_int_eq(0, pool.acquired() + pool.failed() + pool.spilled(),
+                  "stats reset", __LINE__);
+    assert_int_eq(2, pool.high_water(), "high water starts at in_use",
+                  __LINE__);
+}
+
+void test_message()
+{
+    MessagePool pool({{64, 1}});
+    MessagePool::buffer msg = pool.message("/volume", "f", 0.5f);
+    assert_true(msg && !strcmp(msg.data(), "/volume") &&
+                rtosc_argument(msg.data(), 0).f == 0.5f,
+                "message built in pool buffer", __LINE__);
+    msg.release();
+
+    std::string long_str(100, 'x');
+    assert_false(!!pool.message("/name", "s", long_str.c_str()),
+                 "message larger than all buffers", __LINE__);
+}
+
+static std::string large_string(2000, 'a');
+static std::vector<uint8_t> large_blob(20000, 42);
+static std::string loaded_text;
+
+static Ports ports = {
+    {"blob:", 0, 0, [](const char *, RtData &d) {
+        d.reply(d.loc, "b", (int32_t)large_blob.size(), large_blob.data());
+    }},
+    {"huge:", 0, 0, [](const char *, RtData &d) {
+        d.broadcast(d.loc, "b", 100000, large_blob.data());
+    }},
+    {"name::s", 0, 0, [](const char *msg, RtData &d) {
+        if(!rtosc_narguments(msg))
+            d.reply(d.loc, "s", large_string.c_str());
+    }},
+    {"small:", 0, 0, [](const char *, RtData &d) {
+        d.reply(d.loc, "i", 42);
+    }},
+    {"text:s", rProp(internal), 0, [](const char *msg, RtData &) {
+        loaded_text = rtosc_argument(msg, 0).s;
+    }},
+};
+
+struct ReplyCapture : public RtData
+{
+    std::string last;
+    MessagePool *pool = nullptr;
+    void reply(const char *msg) override
+    {
+        last.assign(msg, rtosc_message_length(msg, -1));
+    }
+    MessagePool *message_pool(void) override { return pool; }
+};
+
+void test_large_replies()
+{
+    MessagePool pool;
+    char loc[128];
+    char msg[64];
+    ReplyCapture d;
+    d.loc = loc;
+    d.loc_size = sizeof(loc);
+    d.pool = &pool;
+
+    rtosc_message(msg, sizeof(msg), "blob", "");
+    ports.dispatch(msg, d, true);
+    assert_true(!d.last.empty() &&
+                rtosc_argument(d.last.data(), 0).b.len == 20000,
+                "blob larger than 8192 bytes replied", __LINE__);
+    assert_int_eq(0, pool.in_use(), "buffer released after reply",
+                  __LINE__);
+
+    d.last.clear();
+    rtosc_message(msg, sizeof(msg), "huge", "");
+    ports.dispatch(msg, d, true);
+    assert_true(d.last.empty(), "no reply larger than the pool", __LINE__);
+    assert_int_eq(1, pool.failed(), "oversized reply counted", __LINE__);
+
+    //small replies are built on the stack
+    pool.reset_stats();
+    rtosc_message(msg, sizeof(msg), "small", "");
+    ports.dispatch(msg, d, true);
+    assert_true(rtosc_argument(d.last.data(), 0).i == 42,
+                "small reply", __LINE__);
+    assert_int_eq(0, pool.acquired(), "no pool buffer for small replies",
+                  __LINE__);
+
+    //without a pool, only replies which fit the stack are possible
+    d.pool = nullptr;
+    d.last.clear();
+    rtosc_message(msg, sizeof(msg), "blob", "");
+    ports.dispatch(msg, d, true);
+    assert_true(d.last.empty(), "large reply without pool dropped",
+                __LINE__);
+
+    //serializing uses the default pool for each captured value
+    std::vector<char> bundle(32768);
+    size_t len = subtree_serialize(bundle.data(), bundle.size(), nullptr,
+                                   &ports);
+    assert_true(len && rtosc_bundle_elements(bundle.data(), len) == 3 &&
+                !strcmp(rtosc_argument(rtosc_bundle_fetch(bundle.data(), 1),
+                                       0).s, large_string.c_str()),
+                "blob and long string serialized", __LINE__);
+}
+
+void test_savefile()
+{
+    std::string text(10000, 't');
+    std::string savefile = "/text \"" + text + "\"";
+    int num = dispatch_printed_messages(savefile.c_str(), ports, nullptr);
+    assert_int_eq(1, num, "message loaded", __LINE__);
+    assert_true(loaded_text == text,
+                "savefile message larger than the stack buffer", __LINE__);
+}
+
+int main()
+{
+    test_size_classes();
+    test_message();
+    test_large_replies();
+    test_savefile();
+    return test_summary();
+}
@@ -0,0 +1,96 @@
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+
+#include <rtosc/rtosc.h>
+#include <rtosc/ports.h>
+#include <rtosc/port-sugar.h>
+#include <rtosc/miditable.h>
+#include "common.h"
+
+using namespace rtosc;
+
+static void dummy_method(msg_t, RtData&) {}
+
+Ports ports = {
+    {"volume::f", rLinear(-40, 12), 0, dummy_method},
+    {"cutoff::f", rLog(20, 20000), 0, dummy_method},
+    {"program::i", "", 0, dummy_method},
+};
+
+static float last_value = 0;
+static int events = 0;
+
+static void count_event(const char *msg)
+{
+    ++events;
+    if(rtosc_type(msg, 0) == 'f')
+        last_value = rtosc_argument(msg, 0).f;
+}
+
+void conversion()
+{
+    MidiTable table(ports);
+    table.addElm(0, 1, "volume");
+    table.addElm(0, 2, "cutoff");
+
+    const char *meta[] = {ports["volume"]->metadata,
+                          ports["cutoff"]->metadata};
+    const MidiAddr *addr[] = {table.get(0, 1), table.get(0, 2)};
+    assert_non_null(addr[0], "Get Linear Entry", __LINE__);
+    assert_non_null(addr[1], "Get Logarithmic Entry", __LINE__);
+    if(!addr[0] || !addr[1])
+        return;
+
+    const uint8_t vals[] = {0, 1, 33, 64, 100, 127};
+    int mismatches = 0;
+    for(int i = 0; i < 2; ++i)
+        for(uint8_t val : vals) {
+            float exp = MidiTable::translate(val, meta[i]);
+            float got = MidiTable::convert(val, *addr[i]);
+            if(fabsf(exp - got) > 1e-3f * fabsf(exp) + 1e-5f) {
+                printf("# %s %d: %f != %f\n", addr[i]->path, val, exp, got);
+                ++mismatches;
+            }
+        }
+    assert_int_eq(0, mismatches, "Convert Like Translate", __LINE__);
+
+    table.event_cb = count_event;
+    table.process(0, 1, 127);
+    assert_int_eq(1, events, "Process Mapped Controller", __LINE__);
+    assert_flt_eq(12.0f, last_value, "Process Converts Value", __LINE__);
+    table.process(0, 3, 127);
+    assert_int_eq(1, events, "Unmapped Controller Is Ignored", __LINE__);
+}
+
+void lookup()
+{
+    MidiTable table(ports);
+    table.addElm(0, 5, "volume");
+    table.addElm(3, 5, "program");
+    assert_true(table.has(0, 5) && table.has(3, 5), "Has Entries", __LINE__);
+    assert_false(table.has(1, 5), "Has No Other Entries", __LINE__);
+    assert_null(table.get(200, 5), "Invalid Channel", __LINE__);
+
+    //entries can be edited in place
+    table.get(0, 5)->ctl = 6;
+    assert_null(table.get(0, 5), "Edited Entry Is Moved", __LINE__);
+    assert_true(table.has(0, 6), "Edited Entry Is Found", __LINE__);
+    const MidiAddr *moved = table.get(0, 6);
+    assert_true(moved && !strcmp(moved->path, "volume"),
+                "Get Edited Entry", __LINE__);
+
+    table.clear_entry("program");
+    assert_false(table.has(3, 5), "Cleared Entry Is Gone", __LINE__);
+    table.addElm(3, 5, "cutoff");
+    const MidiAddr *added = table.get(3, 5);
+    assert_true(added && !strcmp(added->path, "cutoff"),
+                "Entry Is Added Again", __LINE__);
+}
+
+int main()
+{
+    conversion();
+    lookup();
+    return test_summary();
+}
@@ -0,0 +1,105 @@
+//Test to verify performance of bulk range operations is good enough
+
+#include <ctime>
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+#include <rtosc/rtosc.h>
+#include <rtosc/arg-ext.h>
+#include <rtosc/arg-val-math.h>
+#include <rtosc/pretty-format.h>
+#include "common.h"
+
+constexpr int32_t range_size = 100000;
+constexpr int repetitions = 100;
+
+void print_results(const char* what, clock_t t_on, clock_t t_off, double count)
+{
+    double seconds = (t_off - t_on) * 1.0 / CLOCKS_PER_SEC;
+    printf("# %s: %8.2f seconds for the test\n", what, seconds);
+    printf("# %s: %8.2f ns per value\n", what, seconds*1e9/count);
+}
+
+void expand_ranges()
+{
+    rtosc_arg_val_t range[3];
+    range[0].type = '-';
+    rtosc_av_rep_num_set(range, range_size);
+    rtosc_av_rep_has_delta_set(range, 1);
+    rtosc_arg_val_from_double(range + 1, 'f', 1.0 / 128);
+    rtosc_arg_val_from_double(range + 2, 'f', -0.5);
+
+    std::vector<float> single(range_size), bulk(range_size);
+
+    /*
+        one value after the other, like rtosc_arg_val_itr does it
+     */
+    clock_t t_on = clock();
+    for(int r = 0; r < repetitions; ++r)
+    for(int32_t i = 0; i < range_size; ++i)
+    {
+        rtosc_arg_val_t tmp;
+        rtosc_arg_val_range_arg(range, i, &tmp);
+        single[i] = tmp.val.f;
+    }
+    clock_t t_off = clock();
+    print_results("rtosc_arg_val_range_arg", t_on, t_off,
+                  (double)range_size * repetitions);
+
+    /*
+        all values at once
+     */
+    t_on = clock();
+    for(int r = 0; r < repetitions; ++r)
+        rtosc_arg_val_range_expand(range, 0, range_size, bulk.data());
+    t_off = clock();
+    print_results("rtosc_arg_val_range_expand", t_on, t_off,
+                  (double)range_size * repetitions);
+
+    assert_true(!memcmp(single.data(), bulk.data(), range_size * sizeof(float)),
+                "bulk range expansion matches single expansion", __LINE__);
+}
+
+void compress_ranges()
+{
+    constexpr int num_arg_vals = 20000;
+    std::vector<rtosc_arg_val_t> noise(num_arg_vals), ramp(num_arg_vals);
+    uint32_t state = 42;
+    for(int i = 0; i < num_arg_vals; ++i)
+    {
+        state ^= state << 13;
+        state ^= state >> 17;
+        state ^= state << 5;
+        // no runs in here, every arg val starts a (failing) search
+        rtosc_arg_val_from_int(&noise[i], 'i', (int)(state % 1000) + i * 1000);
+        // one single run
+        rtosc_arg_val_from_int(&ramp[i], 'i', 3 * i);
+    }
+
+    std::vector<char> buffer(num_arg_vals * 16);
+    // default print options, which compress ranges
+    clock_t t_on = clock();
+    size_t wrt = rtosc_print_arg_vals(noise.data(), num_arg_vals,
+                                      buffer.data(), buffer.size(), NULL, 0);
+    clock_t t_off = clock();
+    print_results("printing without runs", t_on, t_off, num_arg_vals);
+    assert_true(wrt > (size_t)num_arg_vals * 4,
+                "values without runs are not being compressed", __LINE__);
+
+    t_on = clock();
+    wrt = rtosc_print_arg_vals(ramp.data(), num_arg_vals,
+                               buffer.data(), buffer.size(), NULL, 0);
+    t_off = clock();
+    print_results("printing one run", t_on, t_off, num_arg_vals);
+    assert_str_eq("0 3 ... 59997", buffer.data(),
+                  "values with one run are being compressed", __LINE__);
+}
+
+int main()
+{
+    expand_ranges();
+    compress_ranges();
+
+    return test_summary();
+}
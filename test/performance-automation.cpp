@@ -0,0 +1,188 @@
+//Test to verify evaluating many automation slots per block is fast enough
+
+#include <ctime>
+#include <cstdio>
+#include <cstring>
+
+#include <rtosc/rtosc.h>
+#include <rtosc/ports.h>
+#include <rtosc/port-sugar.h>
+#include <rtosc/automations.h>
+#include "common.h"
+
+using namespace rtosc;
+
+#define NUM_SLOTS 128
+constexpr int per_slot = 4;
+constexpr int num_blocks = 5000;
+
+struct Voice
+{
+    float foo;
+    int bar;
+    float baz;
+    int qux;
+    static Ports ports;
+};
+
+struct Synth
+{
+    Voice voice[NUM_SLOTS];
+    static Ports ports;
+};
+
+#define rObject Voice
+Ports Voice::ports = {
+    rParamF(foo, rLinear(-1, 10), "no documentation"),
+    rParamI(bar, rLinear(0, 127), "no documentation"),
+    rParamF(baz, rLinear(0, 1), "no documentation"),
+    rParamI(qux, rLinear(-64, 63), "no documentation"),
+};
+#undef rObject
+
+#define rObject Synth
+Ports Synth::ports = {
+    rRecurs(voice, NUM_SLOTS, "voices")
+};
+#undef rObject
+
+static int backend_calls = 0;
+
+//! RtData which drops all replies, so only the routing is measured
+class Silent : public RtData
+{
+    void reply(const char *, const char *, ...) override {}
+    void broadcast(const char *, const char *, ...) override {}
+};
+
+static void dispatch(Synth *synth, const char *msg)
+{
+    char loc[128];
+    Silent d;
+    d.loc = loc;
+    d.loc_size = sizeof(loc);
+    d.obj = synth;
+    Synth::ports.dispatch(msg, d, true);
+}
+
+static void setup(AutomationMgr& mgr, Synth *synth)
+{
+    static const char *params[per_slot] = {"foo", "bar", "baz", "qux"};
+    mgr.set_ports(Synth::ports);
+    mgr.set_instance(synth);
+    mgr.backend = [synth](const char *msg) {
+        ++backend_calls;
+        if(!rtosc_bundle_p(msg)) {
+            dispatch(synth, msg);
+            return;
+        }
+        //walk the elements, rtosc_bundle_fetch() would be quadratic
+        const uint8_t *elm = (const uint8_t*)msg + 16;
+        while(uint32_t len = elm[0]<<24 | elm[1]<<16 | elm[2]<<8 | elm[3]) {
+            dispatch(synth, (const char*)elm + 4);
+            elm += 4 + len;
+        }
+    };
+    char path[64];
+    for(int i = 0; i < NUM_SLOTS; ++i)
+        for(int j = 0; j < per_slot; ++j) {
+            snprintf(path, sizeof(path), "/voice%d/%s", i, params[j]);
+            mgr.createBinding(i, path, false);
+        }
+}
+
+static void print_results(const char* what, clock_t t_on, clock_t t_off)
+{
+    double seconds = (t_off - t_on) * 1.0 / CLOCKS_PER_SEC;
+    printf("# %s: %8.2f seconds for the test\n", what, seconds);
+    printf("# %s: %8.2f ns per automation\n", what,
+           seconds*1e9/(num_blocks*NUM_SLOTS*per_slot));
+    printf("# %s: %8.2f million updates per second\n", what,
+           num_blocks*NUM_SLOTS*per_slot/seconds/1e6);
+    printf("# %s: %8d backend calls\n", what, backend_calls);
+}
+
+static float slot_value(int block, int slot)
+{
+    return ((block + slot) % 100) / 100.0f;
+}
+
+static void run(bool batched, bool direct, const char *what, Synth *synth)
+{
+    AutomationMgr mgr(NUM_SLOTS, per_slot, 16);
+    char loc[128];
+    Silent d;
+    d.loc = loc;
+    d.loc_size = sizeof(loc);
+    setup(mgr, synth);
+    if(direct) {
+        mgr.resolveRoutes();
+        mgr.set_rtdata(&d);
+    }
+
+    backend_calls = 0;
+    clock_t t_on = clock();
+    for(int b = 0; b < num_blocks; ++b)
+    {
+        for(int i = 0; i < NUM_SLOTS; ++i)
+            if(batched)
+                mgr.setSlotDeferred(i, slot_value(b, i));
+            else
+                mgr.setSlot(i, slot_value(b, i));
+        if(batched)
+            mgr.processBlock();
+    }
+    clock_t t_off = clock();
+    print_results(what, t_on, t_off);
+}
+
+static bool same_values(const Synth *a, const Synth *b)
+{
+    for(int i = 0; i < NUM_SLOTS; ++i)
+    {
+        const Voice &va = a->voice[i], &vb = b->voice[i];
+        if(va.foo != vb.foo || va.bar != vb.bar ||
+           va.baz != vb.baz || va.qux != vb.qux)
+            return false;
+    }
+    return true;
+}
+
+int main()
+{
+    Synth *single = new Synth(), *batched = new Synth(),
+          *direct = new Synth(), *direct_batched = new Synth();
+
+    /*
+        one message per automation, dispatched through the port tree
+     */
+    run(false, false, "setSlot (reference)", single);
+
+    /*
+        one bundle per block, dispatched through the port tree
+     */
+    run(true, false, "processBlock", batched);
+    assert_int_eq(num_blocks, backend_calls, "one bundle per block",
+                  __LINE__);
+    assert_true(same_values(single, batched),
+                "batched evaluation sets the same values", __LINE__);
+
+    /*
+        ports called directly
+     */
+    run(false, true, "setSlot, direct", direct);
+    assert_int_eq(0, backend_calls, "ports are called directly", __LINE__);
+    assert_true(same_values(single, direct),
+                "direct calls set the same values", __LINE__);
+
+    run(true, true, "processBlock, direct", direct_batched);
+    assert_int_eq(0, backend_calls, "ports are called directly", __LINE__);
+    assert_true(same_values(single, direct_batched),
+                "batched direct calls set the same values", __LINE__);
+
+    delete single;
+    delete batched;
+    delete direct;
+    delete direct_batched;
+    return test_summary();
+}
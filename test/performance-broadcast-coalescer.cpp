@@ -0,0 +1,98 @@
+//Test to verify coalescing broadcasts is cheaper than forwarding all of them
+
+#include <ctime>
+#include <cstdio>
+
+#include <rtosc/rtosc.h>
+#include <rtosc/thread-link.h>
+#include <rtosc/broadcast-coalescer.h>
+#include "common.h"
+
+using namespace rtosc;
+
+constexpr int num_params = 256;
+constexpr int updates_per_block = 16; //!< for each parameter
+constexpr int num_blocks = 1000;
+constexpr int num_broadcasts = num_params * updates_per_block * num_blocks;
+
+static void print_results(const char* what, clock_t t_on, clock_t t_off,
+                          size_t forwarded)
+{
+    double seconds = (t_off - t_on) * 1.0 / CLOCKS_PER_SEC;
+    printf("# %s: %8.2f seconds for the test\n", what, seconds);
+    printf("# %s: %8.2f ns per broadcast\n", what,
+           seconds*1e9/num_broadcasts);
+    printf("# %s: %8zu messages forwarded\n", what, forwarded);
+}
+
+//! Read all messages like a UI thread would
+static size_t drain(ThreadLink &link)
+{
+    size_t messages = 0;
+    while(link.hasNext()) {
+        const char *msg = link.read();
+        messages += rtosc_bundle_p(msg) ? rtosc_bundle_elements(msg, -1) : 1;
+    }
+    return messages;
+}
+
+int main()
+{
+    char paths[num_params][32];
+    for(int i = 0; i < num_params; ++i)
+        snprintf(paths[i], sizeof(paths[i]), "/part%d/filter%d/cutoff",
+                 i / 8, i % 8);
+    char msg[64];
+
+    /*
+        reference: forward each broadcast
+     */
+    ThreadLink direct(64, num_params * updates_per_block * 2);
+    size_t direct_forwarded = 0;
+    clock_t t_on = clock();
+    for(int b = 0; b < num_blocks; ++b)
+    {
+        for(int u = 0; u < updates_per_block; ++u)
+            for(int p = 0; p < num_params; ++p) {
+                rtosc_message(msg, sizeof(msg), paths[p], "f",
+                              (b * updates_per_block + u) / 1e4f);
+                direct.raw_write(msg);
+            }
+        direct_forwarded += drain(direct);
+    }
+    clock_t t_off = clock();
+    print_results("forward all (reference)", t_on, t_off, direct_forwarded);
+
+    /*
+        coalesced
+     */
+    ThreadLink link(8192, 64);
+    BroadcastCoalescer coalescer(link, num_params, 16384, 8192);
+    size_t forwarded = 0;
+    t_on = clock();
+    for(int b = 0; b < num_blocks; ++b)
+    {
+        for(int u = 0; u < updates_per_block; ++u)
+            for(int p = 0; p < num_params; ++p) {
+                rtosc_message(msg, sizeof(msg), paths[p], "f",
+                              (b * updates_per_block + u) / 1e4f);
+                coalescer.broadcast(msg);
+            }
+        coalescer.flush();
+        forwarded += drain(link);
+    }
+    t_off = clock();
+    print_results("coalesced", t_on, t_off, forwarded);
+    printf("# coalesced: %8zu messages saved, %zu bundles\n",
+           coalescer.saved(), coalescer.bundles());
+
+    assert_int_eq(num_broadcasts, direct_forwarded,
+                  "all broadcasts forwarded without coalescing", __LINE__);
+    assert_int_eq(num_params * num_blocks, forwarded,
+                  "one message per path and block", __LINE__);
+    assert_int_eq(num_broadcasts - forwarded, coalescer.saved(),
+                  "saved messages counted", __LINE__);
+    assert_int_eq(0, coalescer.overflows(), "no overflows", __LINE__);
+
+    return test_summary();
+}
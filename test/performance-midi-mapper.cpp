@@ -0,0 +1,100 @@
+//Test to verify handling MIDI CCs is fast enough for many mappings
+
+#include <ctime>
+#include <cstdio>
+#include <cstdint>
+
+#include <rtosc/miditable.h>
+#include "common.h"
+
+using namespace rtosc;
+
+constexpr int num_mappings = 1000;
+constexpr int num_nrpns = 200;
+constexpr int num_events = 1000000;
+
+static int midi_id(int par, int chan, bool nrpn)
+{
+    //like in MidiMapperRT::handleCC()
+    return (nrpn<<18) + (((chan-1)&0x0f)<<14) + par;
+}
+
+// simple deterministic random generator (xorshift)
+static uint32_t next_random(uint32_t& state)
+{
+    state ^= state << 13;
+    state ^= state >> 17;
+    state ^= state << 5;
+    return state;
+}
+
+static int handled_values = 0;
+
+void fill(MidiMapperStorage& storage)
+{
+    storage.mapping = MidiMapperStorage::TinyVector<
+                          std::tuple<int, bool, int>>(num_mappings);
+    storage.callbacks = MidiMapperStorage::TinyVector<
+                            MidiMapperStorage::callback_t>(num_mappings);
+    storage.values = MidiMapperStorage::TinyVector<int>(num_mappings);
+    for(int i = 0; i < num_mappings; ++i)
+    {
+        // all CCs of the first channels, then NRPNs
+        int id = i < num_mappings - num_nrpns
+            ? midi_id(i % 128, 1 + i / 128, false)
+            : midi_id(i * 7, 1, true);
+        storage.mapping[i] = std::make_tuple(id, true, i);
+        storage.callbacks[i] = [](int16_t x, MidiMapperStorage::write_cb) {
+            handled_values += x != 0;
+        };
+        storage.values[i] = 0;
+    }
+}
+
+int run(MidiMapperStorage& storage, const char* what)
+{
+    uint32_t state = 42;
+    int handled = 0;
+    auto write = [](const char*) {};
+    clock_t t_on = clock();
+    for(int i = 0; i < num_events; ++i)
+    {
+        uint32_t r = next_random(state);
+        // 1/4 of the events are unmapped CCs
+        int id = (r & 3) ? std::get<0>(storage.mapping[r % num_mappings])
+                         : midi_id(r % 128, 16, false);
+        handled += storage.handleCC(id, 1 + (r >> 25), write);
+    }
+    clock_t t_off = clock();
+    double seconds = (t_off - t_on) * 1.0 / CLOCKS_PER_SEC;
+    printf("# %s: %8.2f seconds for the test\n", what, seconds);
+    printf("# %s: %8.2f ns per event\n", what, seconds*1e9/num_events);
+    return handled;
+}
+
+int main()
+{
+    MidiMapperStorage searching, indexed;
+    fill(searching);
+    fill(indexed);
+    indexed.buildLookup();
+
+    int handled_searching = run(searching, "linear search (reference)");
+    int handled_indexed = run(indexed, "lookup table");
+
+    assert_int_eq(handled_searching, handled_indexed,
+                  "lookup table finds the same mappings", __LINE__);
+    assert_true(handled_indexed > num_events / 2,
+                "most events are handled", __LINE__);
+
+    // each mapping must be found at its own index
+    int mismatches = 0;
+    for(int i = 0; i < num_mappings; ++i)
+        mismatches += indexed.findMapping(std::get<0>(indexed.mapping[i]))
+                      != i;
+    mismatches += indexed.findMapping(midi_id(5, 16, false)) != -1;
+    mismatches += indexed.findMapping(midi_id(1, 2, true)) != -1;
+    assert_int_eq(0, mismatches, "lookup table is correct", __LINE__);
+
+    return test_summary();
+}
@@ -0,0 +1,144 @@
+//Test to verify MidiTable::process() is fast enough for many mappings
+
+#include <ctime>
+#include <cstdio>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+#include <rtosc/rtosc.h>
+#include <rtosc/ports.h>
+#include <rtosc/port-sugar.h>
+#include <rtosc/miditable.h>
+#include "common.h"
+
+using namespace rtosc;
+
+constexpr int num_events = 1000000;
+
+static void dummy_method(msg_t, RtData&) {}
+
+//float ports with linear and logarithmic scales, like in older hosts
+Ports ports = {
+    {"volume#64::f", rLinear(-40, 12), 0, dummy_method},
+    {"cutoff#62::f", rLog(20, 20000), 0, dummy_method},
+    {"enable::T:F", "", 0, dummy_method},
+    {"program::i", "", 0, dummy_method},
+};
+
+// simple deterministic random generator (xorshift)
+static uint32_t next_random(uint32_t& state)
+{
+    state ^= state << 13;
+    state ^= state >> 17;
+    state ^= state << 5;
+    return state;
+}
+
+static float last_value = 0;
+static int events = 0;
+
+static void count_event(const char *msg)
+{
+    ++events;
+    if(rtosc_type(msg, 0) == 'f')
+        last_value = rtosc_argument(msg, 0).f;
+}
+
+static void print_results(const char* what, clock_t t_on, clock_t t_off)
+{
+    double seconds = (t_off - t_on) * 1.0 / CLOCKS_PER_SEC;
+    printf("# %s: %8.2f seconds for the test\n", what, seconds);
+    printf("# %s: %8.2f ns per event\n", what, seconds*1e9/num_events);
+}
+
+int main()
+{
+    MidiTable table(ports);
+    table.event_cb = count_event;
+    char path[32];
+    for(int i = 0; i < 64; ++i) {
+        snprintf(path, sizeof(path), "volume%d", i);
+        table.addElm(i % 16, i / 16, path);
+    }
+    for(int i = 0; i < 62; ++i) {
+        snprintf(path, sizeof(path), "cutoff%d", i);
+        table.addElm(i % 16, 4 + i / 16, path);
+    }
+    table.addElm(15, 127, "enable");
+    table.addElm(15, 126, "program");
+
+    /*
+        reference: what process() did before, searching the table and
+        parsing the metadata for each value
+     */
+    std::vector<const MidiAddr*> entries;
+    for(int ch = 0; ch < 16; ++ch)
+        for(int ctl = 0; ctl < 128; ++ctl)
+            if(const MidiAddr *addr = table.get(ch, ctl))
+                entries.push_back(addr);
+
+    uint32_t state = 42;
+    double sum_translated = 0;
+    char buffer[1024];
+    clock_t t_on = clock();
+    for(int i = 0; i < num_events; ++i)
+    {
+        uint32_t r = next_random(state);
+        uint8_t ch = r % 16, ctl = (r >> 4) % 8, val = (r >> 8) % 128;
+        const MidiAddr *addr = nullptr;
+        for(const MidiAddr *e : entries)
+            if(e->ch == ch && e->ctl == ctl) {
+                addr = e;
+                break;
+            }
+        if(addr && addr->type == 'f') {
+            float v = MidiTable::translate(val, addr->conversion);
+            rtosc_message(buffer, sizeof(buffer), addr->path, "f", v);
+            sum_translated += v;
+        }
+    }
+    clock_t t_off = clock();
+    print_results("search and translate (reference)", t_on, t_off);
+
+    /*
+        process()
+     */
+    state = 42;
+    events = 0;
+    double sum_processed = 0;
+    t_on = clock();
+    for(int i = 0; i < num_events; ++i)
+    {
+        uint32_t r = next_random(state);
+        int before = events;
+        table.process(r % 16, (r >> 4) % 8, (r >> 8) % 128);
+        if(events != before)
+            sum_processed += last_value;
+    }
+    t_off = clock();
+    print_results("process", t_on, t_off);
+
+    assert_true(events > num_events / 2, "most events are mapped", __LINE__);
+    assert_true(sum_processed == sum_translated,
+                "precompiled conversion matches translate()", __LINE__);
+
+    // all values of all mappings
+    int mismatches = 0;
+    for(int ch = 0; ch < 16; ++ch)
+        for(int ctl = 0; ctl < 8; ++ctl) {
+            const MidiAddr *addr = table.get(ch, ctl);
+            if(addr)
+                for(int val = 0; val < 128; ++val)
+                    mismatches += MidiTable::convert(val, *addr) !=
+                        MidiTable::translate(val, addr->conversion);
+        }
+    assert_int_eq(0, mismatches, "all conversions match translate()",
+                  __LINE__);
+
+    table.clear_entry("volume3");
+    assert_false(table.has(3, 0), "cleared entries are not found", __LINE__);
+    assert_true(table.has(4, 0), "other entries are found", __LINE__);
+
+    return test_summary();
+}
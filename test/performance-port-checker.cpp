@@ -0,0 +1,99 @@
+//Test to verify the in-process port checker is fast enough for large trees
+
+#include <ctime>
+#include <cstdio>
+#include <string>
+#include <deque>
+
+#include <rtosc/rtosc.h>
+#include <rtosc/ports.h>
+#include <rtosc/port-sugar.h>
+#include <rtosc/port-checker.h>
+#include "common.h"
+
+using namespace rtosc;
+
+//100 groups of 100 subgroups of 10 parameters
+constexpr int num_groups = 100;
+constexpr int num_subgroups = 100;
+constexpr int num_ports = num_groups * num_subgroups * 10;
+
+static void param_cb(const char *msg, RtData &d)
+{
+    if(!*rtosc_argument_string(msg))
+        d.reply(d.loc, "i", 0);
+    else
+        d.broadcast(d.loc, "i", rtosc_argument(msg, 0).i);
+}
+
+#define PARAM(name) {#name "::i", rProp(parameter) rDefault(0), NULL, param_cb}
+static Ports leaf = {
+    PARAM(p0), PARAM(p1), PARAM(p2), PARAM(p3), PARAM(p4),
+    PARAM(p5), PARAM(p6), PARAM(p7), PARAM(p8), PARAM(p9)
+};
+#undef PARAM
+//! Ports which are filled at runtime
+struct DynamicPorts : public Ports
+{
+    DynamicPorts() : Ports({}) {}
+    using Ports::refreshMagic;
+};
+static DynamicPorts subgroup, root;
+static std::deque<std::string> names; //storage for the port names
+
+static void add_children(DynamicPorts &ports, const char *prefix, int n,
+                         Ports *children)
+{
+    for(int i = 0; i < n; ++i)
+    {
+        names.push_back(prefix + std::to_string(i) + "/");
+        ports.ports.push_back({names.back().c_str(), "", children,
+            [children](const char *msg, RtData &d) {
+                SNIP
+                children->dispatch(msg, d);
+            }});
+    }
+    ports.refreshMagic();
+}
+
+static void print_results(const char* what, clock_t t_on, clock_t t_off)
+{
+    double seconds = (t_off - t_on) * 1.0 / CLOCKS_PER_SEC;
+    printf("# %s: %8.2f seconds for the test\n", what, seconds);
+    printf("# %s: %8.0f ports checked per second\n", what,
+           num_ports / seconds);
+}
+
+int main()
+{
+    add_children(subgroup, "s", num_subgroups, &leaf);
+    add_children(root, "g", num_groups, &subgroup);
+    inprocess_app app(root);
+
+    /*
+        serial checks
+     */
+    inprocess_server sender(app), other(app);
+    port_checker serial(&sender, &other);
+    clock_t t_on = clock();
+    serial("inprocess");
+    clock_t t_off = clock();
+    print_results("serial", t_on, t_off);
+    assert_int_eq(0, serial.issues().size(), "no issues found", __LINE__);
+    assert_int_eq(0, serial.skipped().size(), "no ports skipped", __LINE__);
+
+    /*
+        pipelined checks over 4 connections
+     */
+    inprocess_server s1(app), o1(app), s2(app), o2(app), s3(app), o3(app),
+                     s4(app), o4(app);
+    port_checker pipelined(&s1, &o1);
+    pipelined.set_pipelined(16, {{&s2, &o2}, {&s3, &o3}, {&s4, &o4}});
+    t_on = clock();
+    pipelined("inprocess");
+    t_off = clock();
+    print_results("pipelined", t_on, t_off);
+    assert_int_eq(0, pipelined.issues().size(), "no issues found", __LINE__);
+
+    return test_summary();
+}
@@ -0,0 +1,261 @@
+//Test to verify printing and scanning performance of the pretty format is
+//good enough
+
+#include <ctime>
+#include <cstdio>
+#include <cassert>
+#include <cstring>
+#include <cinttypes>
+#include <climits>
+#include <string>
+#include <vector>
+#include <algorithm>
+
+#include <rtosc/rtosc.h>
+#include <rtosc/pretty-format.h>
+#include "common.h"
+
+constexpr int num_arg_vals = 1000000;
+constexpr int args_per_line = 16;
+
+// simple deterministic random generator (xorshift)
+static uint32_t next_random(uint32_t& state)
+{
+    state ^= state << 13;
+    state ^= state >> 17;
+    state ^= state << 5;
+    return state;
+}
+
+// mixture of types like in a typical savefile: mostly floats and ints
+std::vector<rtosc_arg_val_t> make_mixed_arg_vals()
+{
+    std::vector<rtosc_arg_val_t> avs(num_arg_vals);
+    uint32_t state = 42;
+    for(rtosc_arg_val_t& av : avs)
+    {
+        uint32_t r = next_random(state);
+        switch(r % 8)
+        {
+            case 0: case 1: case 2: case 3:
+                av.type = 'f';
+                av.val.f = (float)(r % 100000) / 137.f - 300.f;
+                break;
+            case 4: case 5:
+                av.type = 'i';
+                av.val.i = (int32_t)(r % 256) - 64;
+                break;
+            case 6:
+                av.type = 'd';
+                av.val.d = (double)r / 3.0;
+                break;
+            default:
+                av.type = (r & 256) ? 'T' : 'F';
+                av.val.T = (r & 256) ? 1 : 0;
+        }
+    }
+    return avs;
+}
+
+void print_results(const char* what, clock_t t_on, clock_t t_off,
+                   int count = num_arg_vals, const char* unit = "arg val")
+{
+    double seconds = (t_off - t_on) * 1.0 / CLOCKS_PER_SEC;
+    double ns_per_unit = seconds*1e9/count;
+
+    printf("# %s: %8.2f seconds for the test\n", what, seconds);
+    printf("# %s: %8.2f ns per %s\n", what, ns_per_unit, unit);
+}
+
+// lines like in a large savefile, with all commonly saved types
+std::string make_savefile(int lines)
+{
+    std::string res;
+    uint32_t state = 1234;
+    char line[256];
+    for(int i = 0; i < lines; ++i)
+    {
+        uint32_t r = next_random(state);
+        float f = (float)(r % 1000) / 100.f;
+        switch(r % 7)
+        {
+            case 0: case 1:
+                snprintf(line, sizeof(line), "/part%d/kit0/Pvolume %.2f (%a)\n",
+                         i % 16, f, f);
+                break;
+            case 2:
+                snprintf(line, sizeof(line), "/part%d/Pkeyshift %d\n",
+                         i % 16, (int)(r % 128));
+                break;
+            case 3:
+                snprintf(line, sizeof(line), "/part%d/Penabled %s\n",
+                         i % 16, (r & 64) ? "true" : "false");
+                break;
+            case 4:
+                snprintf(line, sizeof(line),
+                         "/part%d/Pname \"Instrument %u\"\n", i % 16, r);
+                break;
+            case 5:
+                snprintf(line, sizeof(line),
+                         "/part%d/Pfilter [%u %u %u %u]\n", i % 16,
+                         r % 128, (r >> 8) % 128, (r >> 16) % 128, r >> 25);
+                break;
+            default:
+                snprintf(line, sizeof(line),
+                         "/part%d/Presonance [%u %u 3x64 0 1 2 3]\n", i % 16,
+                         r % 128, (r >> 8) % 128);
+        }
+        res += line;
+    }
+    return res;
+}
+
+void scan_savefile()
+{
+    constexpr int lines = 200000;
+    const std::string savefile = make_savefile(lines);
+    constexpr size_t bufsize = 8192;
+
+    /*
+        two passes: count, then scan
+     */
+    int msgs_two_pass = 0;
+    size_t args_two_pass = 0;
+    {
+        char address[bufsize];
+        char strbuf[bufsize];
+        rtosc_arg_val_t args[256];
+        clock_t t_on = clock();
+        for(const char* msg = savefile.c_str(); *msg; )
+        {
+            int nargs = rtosc_count_printed_arg_vals_of_msg(msg);
+            if(nargs == INT_MIN)
+                break;
+            assert(nargs >= 0 && nargs <= 256);
+            msg += rtosc_scan_message(msg, address, bufsize, args, nargs,
+                                      strbuf, bufsize);
+            ++msgs_two_pass;
+            args_two_pass += nargs;
+        }
+        clock_t t_off = clock();
+        print_results("two pass scanning", t_on, t_off, lines, "line");
+    }
+
+    /*
+        one pass, with an arena being reset per message
+     */
+    int msgs_one_pass = 0;
+    size_t args_one_pass = 0;
+    {
+        rtosc_arena_t arena;
+        rtosc_arena_init(&arena, bufsize);
+        clock_t t_on = clock();
+        for(const char* msg = savefile.c_str(); *msg; )
+        {
+            const char* address;
+            rtosc_arg_val_t* args;
+            size_t nargs;
+            rtosc_arena_reset(&arena);
+            int rd = rtosc_scan_message_arena(msg, &address, &args, &nargs,
+                                              &arena);
+            if(rd == INT_MIN)
+                break;
+            assert(rd > 0);
+            msg += rd;
+            ++msgs_one_pass;
+            args_one_pass += nargs;
+        }
+        clock_t t_off = clock();
+        print_results("one pass scanning", t_on, t_off, lines, "line");
+        rtosc_arena_destroy(&arena);
+    }
+
+    assert_int_eq(lines, msgs_two_pass, "two pass scan reads all lines",
+                  __LINE__);
+    assert_int_eq(lines, msgs_one_pass, "one pass scan reads all lines",
+                  __LINE__);
+    assert_true(args_one_pass == args_two_pass,
+                "one pass scan reads all arg vals", __LINE__);
+}
+
+int main()
+{
+    std::vector<rtosc_arg_val_t> avs = make_mixed_arg_vals();
+    char buffer[4096];
+    size_t total = 0;
+
+    /*
+        reference: what the printer would cost with plain snprintf
+     */
+    clock_t t_on = clock();
+    for(const rtosc_arg_val_t& av : avs)
+    {
+        switch(av.type)
+        {
+            case 'f':
+                total += snprintf(buffer, sizeof(buffer), "%#.2f (%a)",
+                                  av.val.f, av.val.f);
+                break;
+            case 'd':
+                total += snprintf(buffer, sizeof(buffer), "%#.2lfd (%la)",
+                                  av.val.d, av.val.d);
+                break;
+            case 'i':
+                total += snprintf(buffer, sizeof(buffer), "%" PRId32,
+                                  av.val.i);
+                break;
+            default:
+                total += snprintf(buffer, sizeof(buffer), "%s",
+                                  av.val.T ? "true" : "false");
+        }
+    }
+    clock_t t_off = clock();
+    print_results("snprintf (reference)", t_on, t_off);
+
+    /*
+        rtosc_print_arg_vals on lines of 16 arg vals
+     */
+    size_t total_printed = 0;
+    t_on = clock();
+    for(int i = 0; i < num_arg_vals; i += args_per_line)
+    {
+        int n = std::min(args_per_line, num_arg_vals - i);
+        // leave space for the warning in rtosc_print_arg_vals
+        buffer[0] = ' ';
+        total_printed += rtosc_print_arg_vals(avs.data() + i, n,
+                                              buffer + 1, sizeof(buffer) - 1,
+                                              NULL, 0);
+    }
+    t_off = clock();
+    print_results("rtosc_print_arg_vals", t_on, t_off);
+    printf("# %zu bytes printed\n", total_printed);
+
+    assert_true(total_printed > total,
+                "rtosc_print_arg_vals printed all values", __LINE__);
+
+    /*
+        printing must match the old, snprintf based result
+     */
+    int mismatches = 0;
+    for(int i = 0; i < 10000; ++i)
+    {
+        const rtosc_arg_val_t& av = avs[i];
+        if(av.type != 'f' && av.type != 'd')
+            continue;
+        char exp[128];
+        if(av.type == 'f')
+            snprintf(exp, sizeof(exp), "%#.2f (%a)", av.val.f, av.val.f);
+        else
+            snprintf(exp, sizeof(exp), "%#.2lfd (%la)", av.val.d, av.val.d);
+        int cols_used = 0;
+        rtosc_print_arg_val(&av, buffer, sizeof(buffer), NULL,
+                            &cols_used, NULL);
+        mismatches += !!strcmp(exp, buffer);
+    }
+    assert_int_eq(0, mismatches, "fast float printing matches snprintf",
+                  __LINE__);
+
+    scan_savefile();
+
+    return test_summary();
+}
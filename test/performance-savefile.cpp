@@ -0,0 +1,146 @@
+//Test to verify time and memory usage of savefile loading is good enough
+
+#include <ctime>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <set>
+#if defined(__GLIBC__)
+#include <malloc.h>
+#endif
+
+#include <rtosc/rtosc.h>
+#include <rtosc/ports.h>
+#include <rtosc/port-sugar.h>
+#include <rtosc/savefile.h>
+#include "common.h"
+
+using namespace rtosc;
+
+#define NUM_VOICES 4000
+
+struct Voice
+{
+    float volume = 0.5f;
+    int keyshift = 0;
+    char name[32] = "";
+    static Ports ports;
+};
+
+struct Synth
+{
+    Voice voice[NUM_VOICES];
+    static Ports ports;
+};
+
+#define rObject Voice
+Ports Voice::ports = {
+    rParamF(volume, rDefault(0.5), "volume"),
+    rParamI(keyshift, rDefault(0), "keyshift"),
+    rString(name, 32, rDefault(""), "name")
+};
+#undef rObject
+
+#define rObject Synth
+Ports Synth::ports = {
+    rRecurs(voice, NUM_VOICES, "voices")
+};
+#undef rObject
+
+//! bytes currently allocated from the heap, or 0 if unknown
+static size_t heap_in_use()
+{
+#if defined(__GLIBC__) && (__GLIBC__ > 2 || __GLIBC_MINOR__ >= 33)
+    return mallinfo2().uordblks;
+#else
+    return 0;
+#endif
+}
+
+//! dispatcher that measures the heap usage when all messages are scanned
+class measuring_dispatcher_t : public savefile_dispatcher_t
+{
+    int on_dispatch(size_t, char*, size_t, size_t nargs,
+                    rtosc_arg_val_t*) override
+    {
+        size_t cur = heap_in_use();
+        if(cur > peak)
+            peak = cur;
+        ++messages;
+        return default_response(nargs);
+    }
+public:
+    size_t peak = 0;
+    int messages = 0;
+};
+
+void print_results(const char* what, clock_t t_on, clock_t t_off, int count)
+{
+    double seconds = (t_off - t_on) * 1.0 / CLOCKS_PER_SEC;
+    printf("# %s: %8.2f seconds for the test\n", what, seconds);
+    printf("# %s: %8.2f us per message\n", what, seconds*1e6/count);
+}
+
+int main()
+{
+    Synth* synth = new Synth;
+    for(int i = 0; i < NUM_VOICES; ++i)
+    {
+        Voice& v = synth->voice[i];
+        v.volume = (float)i / NUM_VOICES;
+        v.keyshift = i % 24 - 12;
+        snprintf(v.name, 32, "Voice number %d", i);
+    }
+
+    /*
+        save
+     */
+    std::set<std::string> already_written;
+    clock_t t_on = clock();
+    std::string savefile = get_changed_values(Synth::ports, synth,
+                                              already_written, {});
+    clock_t t_off = clock();
+    // all values that differ from the defaults
+    int exp_messages = 0;
+    for(int i = 0; i < NUM_VOICES; ++i)
+        exp_messages += (synth->voice[i].volume != 0.5f)
+                      + (synth->voice[i].keyshift != 0) + 1;
+    print_results("saving", t_on, t_off, exp_messages);
+    printf("# savefile size: %zu bytes\n", savefile.size());
+
+    /*
+        load
+     */
+    Synth* loaded = new Synth;
+    measuring_dispatcher_t dispatcher;
+    size_t heap_before = heap_in_use();
+    t_on = clock();
+    int num = dispatch_printed_messages(savefile.c_str(), Synth::ports, loaded,
+                                        &dispatcher);
+    t_off = clock();
+    print_results("loading", t_on, t_off, num);
+    if(heap_before)
+    {
+        size_t peak = dispatcher.peak - heap_before;
+        printf("# loading: %zu bytes heap peak, %.1f bytes per message\n",
+               peak, (double)peak / num);
+    }
+
+    assert_int_eq(exp_messages, num, "all messages loaded", __LINE__);
+    assert_int_eq(exp_messages, dispatcher.messages,
+                  "all messages dispatched", __LINE__);
+    int mismatches = 0;
+    for(int i = 0; i < NUM_VOICES; ++i)
+    {
+        const Voice& exp = synth->voice[i], &act = loaded->voice[i];
+        mismatches += exp.volume != act.volume ||
+                      exp.keyshift != act.keyshift ||
+                      strcmp(exp.name, act.name);
+    }
+    assert_int_eq(0, mismatches, "all values restored", __LINE__);
+
+    delete loaded;
+    delete synth;
+    return test_summary();
+}
@@ -0,0 +1,129 @@
+//Test to verify the latency between processes via shared memory is low
+
+#include <chrono>
+#include <cstdio>
+#include <string>
+#include <sched.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <rtosc/rtosc.h>
+#include <rtosc/shared-thread-link.h>
+#include <rtosc/transport.h>
+#include "common.h"
+
+using namespace rtosc;
+
+constexpr int num_round_trips = 20000;
+
+//the time is mostly spent in the other process, so measure wall time
+typedef std::chrono::steady_clock clock_type;
+
+enum class mode
+{
+    wait,   //!< both sides wait and notify
+    poll,   //!< both sides poll, like a realtime thread would
+    udp     //!< reference: UDP sockets
+};
+
+static const std::string to_engine = "/rtosc-performance-to-engine-" +
+                                     std::to_string(getpid());
+static const std::string to_ui = "/rtosc-performance-to-ui-" +
+                                 std::to_string(getpid());
+
+//! Wait for the next message, polling yields the CPU (which a realtime
+//! thread would do until the next audio block)
+static bool next(SharedThreadLink &link, mode m)
+{
+    if(m == mode::wait)
+        return link.wait(1000);
+    while(!link.hasNext())
+        sched_yield();
+    return true;
+}
+
+//! The "engine" process, which answers each message
+static void engine(mode m, connection &con)
+{
+    if(m == mode::udp)
+    {
+        auto answer = [&con](const char *msg, size_t len) {
+            con.send(msg, len);
+        };
+        for(int i = 0; i < num_round_trips; ++i)
+            if(!con.receive(answer, 1000))
+                _exit(1);
+        _exit(0);
+    }
+
+    SharedThreadLink in(to_engine.c_str()), out(to_ui.c_str());
+    for(int i = 0; i < num_round_trips; ++i)
+    {
+        if(!next(in, m))
+            _exit(1);
+        out.raw_write(in.read());
+        if(m == mode::wait)
+            out.notify();
+    }
+    _exit(0);
+}
+
+static int run(mode m, const char *what)
+{
+    SharedThreadLink out(to_engine.c_str(), 64, 64),
+                     in(to_ui.c_str(), 64, 64);
+    connection con, engine_con;
+    if(m == mode::udp)
+    {
+        con = connection::udp(0);
+        engine_con = connection::udp(0, "127.0.0.1", con.local_port());
+        con.connect_udp("127.0.0.1", engine_con.local_port());
+    }
+
+    pid_t pid = fork();
+    if(!pid)
+        engine(m, engine_con);
+
+    auto ignore = [](const char *, size_t) {};
+    int round_trips = 0;
+
+    char msg[64];
+    clock_type::time_point t_on = clock_type::now();
+    for(int i = 0; i < num_round_trips; ++i)
+    {
+        size_t len = rtosc_message(msg, sizeof(msg), "/ping", "i", i);
+        if(m == mode::udp)
+        {
+            con.send(msg, len);
+            if(!con.receive(ignore, 1000))
+                break;
+        }
+        else
+        {
+            out.raw_write(msg);
+            if(m == mode::wait)
+                out.notify();
+            if(!next(in, m) || rtosc_argument(in.read(), 0).i != i)
+                break;
+        }
+        ++round_trips;
+    }
+    double seconds = std::chrono::duration<double>(clock_type::now()
+                                                   - t_on).count();
+    int status;
+    waitpid(pid, &status, 0);
+    printf("# %s: %8.2f us per round trip\n", what,
+           seconds * 1e6 / num_round_trips);
+    return round_trips;
+}
+
+int main()
+{
+    assert_int_eq(num_round_trips, run(mode::wait, "shared memory, wait"),
+                  "all round trips done", __LINE__);
+    assert_int_eq(num_round_trips, run(mode::poll, "shared memory, poll"),
+                  "all round trips done", __LINE__);
+    assert_int_eq(num_round_trips, run(mode::udp, "UDP (reference)"),
+                  "all round trips done", __LINE__);
+    return test_summary();
+}
@@ -0,0 +1,130 @@
+//Test to verify finding the subscribers of a message is cheap enough to be
+//done for each broadcast
+
+#include <ctime>
+#include <cstdio>
+#include <vector>
+
+#include <rtosc/rtosc.h>
+#include <rtosc/subscriptions.h>
+#include "common.h"
+
+using namespace rtosc;
+
+constexpr int num_clients = 100;
+constexpr int num_parts = 16;
+constexpr int voices_per_part = 4; //!< 64 voices in total
+constexpr int num_messages = 10000; //!< one second of broadcasts
+constexpr int num_runs = 20;
+
+static void print_results(const char* what, clock_t t_on, clock_t t_off,
+                          size_t deliveries)
+{
+    double seconds = (t_off - t_on) * 1.0 / CLOCKS_PER_SEC;
+    double per_message = seconds / num_runs / num_messages;
+    printf("# %s: %8.2f seconds for the test\n", what, seconds);
+    printf("# %s: %8.2f us per message\n", what, per_message * 1e6);
+    printf("# %s: %8.4f %% CPU at %d messages per second\n", what,
+           per_message * num_messages * 100, num_messages);
+    printf("# %s: %8.2f deliveries per message\n", what,
+           deliveries * 1.0 / num_runs / num_messages);
+}
+
+int main()
+{
+    //every client watches one part, some also watch global patterns
+    std::vector<std::string> patterns;
+    std::vector<int> clients;
+    char buffer[64];
+    for(int c = 0; c < num_clients; ++c)
+    {
+        int part = c % num_parts;
+        switch(c % 5)
+        {
+            case 0: snprintf(buffer, sizeof(buffer), "/part%d/", part); break;
+            case 1: snprintf(buffer, sizeof(buffer), "/part%d/voice%d/freq",
+                             part, c % voices_per_part); break;
+            case 2: snprintf(buffer, sizeof(buffer), "/part%d/voice#2/",
+                             part); break;
+            case 3: snprintf(buffer, sizeof(buffer), "/part%d/volume:f",
+                             part); break;
+            case 4: snprintf(buffer, sizeof(buffer), "/part{%d,%d}/volume",
+                             part, (part + 1) % num_parts); break;
+        }
+        patterns.emplace_back(buffer);
+        clients.push_back(c);
+    }
+    patterns.emplace_back("/*/volume");
+    clients.push_back(0);
+
+    SubscriptionRegistry registry;
+    for(size_t i = 0; i < patterns.size(); ++i)
+        registry.subscribe(clients[i], patterns[i].c_str());
+
+    std::vector<std::string> messages;
+    for(int i = 0; i < num_messages; ++i)
+    {
+        int voice = i % (num_parts * voices_per_part);
+        int part = voice / voices_per_part;
+        char path[32];
+        if(i % 4)
+            snprintf(path, sizeof(path), "/part%d/voice%d/freq", part,
+                     voice % voices_per_part);
+        else
+            snprintf(path, sizeof(path), "/part%d/volume", part);
+        size_t len = rtosc_message(buffer, sizeof(buffer), path, "f", 440.f);
+        messages.emplace_back(buffer, len);
+    }
+
+    /*
+        reference: send each message to all clients
+     */
+    size_t all_deliveries = 0;
+    clock_t t_on = clock();
+    for(int r = 0; r < num_runs; ++r)
+        for(const std::string &msg : messages)
+            for(int c = 0; c < num_clients; ++c)
+                all_deliveries += msg[0] == '/';
+    clock_t t_off = clock();
+    print_results("send to all (reference)", t_on, t_off, all_deliveries);
+
+    /*
+        reference: rtosc_match() for each pattern
+     */
+    size_t naive_deliveries = 0;
+    std::vector<int> naive_seen(num_clients, -1);
+    t_on = clock();
+    for(int r = 0; r < num_runs; ++r)
+        for(size_t m = 0; m < messages.size(); ++m)
+        {
+            int id = r * num_messages + m;
+            for(size_t i = 0; i < patterns.size(); ++i)
+                if(naive_seen[clients[i]] != id &&
+                   rtosc_match(patterns[i].c_str(), messages[m].data(),
+                               nullptr)) {
+                    naive_seen[clients[i]] = id;
+                    ++naive_deliveries;
+                }
+        }
+    t_off = clock();
+    print_results("rtosc_match per pattern (reference)", t_on, t_off,
+                  naive_deliveries);
+
+    /*
+        registry
+     */
+    size_t deliveries = 0;
+    t_on = clock();
+    for(int r = 0; r < num_runs; ++r)
+        for(const std::string &msg : messages)
+            registry.match(msg.data(), [&deliveries](int) { ++deliveries; });
+    t_off = clock();
+    print_results("registry", t_on, t_off, deliveries);
+
+    assert_int_eq(naive_deliveries, deliveries,
+                  "same deliveries as rtosc_match", __LINE__);
+    assert_true(deliveries * 10 < all_deliveries,
+                "less than a tenth of the messages sent", __LINE__);
+
+    return test_summary();
+}
@@ -0,0 +1,171 @@
+//Test to verify restoring large snapshots is fast enough
+
+#include <ctime>
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+#include <rtosc/rtosc.h>
+#include <rtosc/ports.h>
+#include <rtosc/port-sugar.h>
+#include <rtosc/subtree-serialize.h>
+#include "common.h"
+
+using namespace rtosc;
+
+#define NUM_VOICES 2500
+constexpr int per_voice = 4;
+constexpr int num_params = NUM_VOICES * per_voice;
+constexpr int num_restores = 50;
+
+struct Voice
+{
+    float volume;
+    int detune;
+    bool enabled;
+    float pan;
+    static Ports ports;
+};
+
+struct Synth
+{
+    Voice voice[NUM_VOICES];
+    static Ports ports;
+};
+
+#define rObject Voice
+Ports Voice::ports = {
+    rParamF(volume, rLinear(0, 1), "volume"),
+    rParamI(detune, rLinear(-64, 63), "detune"),
+    rToggle(enabled, "enabled"),
+    rParamF(pan, rLinear(-1, 1), "pan"),
+};
+#undef rObject
+
+#define rObject Synth
+Ports Synth::ports = {
+    rRecurs(voice, NUM_VOICES, "voices")
+};
+#undef rObject
+
+//! RtData which drops all replies, so only the restoring is measured
+class Silent : public RtData
+{
+    void reply(const char *, const char *, ...) override {}
+    void broadcast(const char *, const char *, ...) override {}
+};
+
+static void fill(Synth *s, int seed)
+{
+    for(int i = 0; i < NUM_VOICES; ++i)
+    {
+        Voice &v = s->voice[i];
+        v.volume  = ((i + seed) % 100) / 100.0f;
+        v.detune  = (i + seed) % 128 - 64;
+        v.enabled = (i + seed) % 2;
+        v.pan     = ((i * 7 + seed) % 200) / 100.0f - 1;
+    }
+}
+
+static bool same_values(const Synth *a, const Synth *b)
+{
+    for(int i = 0; i < NUM_VOICES; ++i)
+    {
+        const Voice &va = a->voice[i], &vb = b->voice[i];
+        if(va.volume != vb.volume || va.detune != vb.detune ||
+           va.enabled != vb.enabled || va.pan != vb.pan)
+            return false;
+    }
+    return true;
+}
+
+static void print_results(const char* what, clock_t t_on, clock_t t_off,
+                          int count)
+{
+    double seconds = (t_off - t_on) * 1.0 / CLOCKS_PER_SEC;
+    printf("# %s: %8.2f seconds for the test\n", what, seconds);
+    printf("# %s: %8.3f ms per snapshot\n", what, seconds*1e3/count);
+    printf("# %s: %8.2f ns per parameter\n", what,
+           seconds*1e9/count/num_params);
+}
+
+int main()
+{
+    Synth *source = new Synth(), *target = new Synth();
+    fill(source, 1);
+    std::vector<char> snapshot(num_params * 64);
+    char loc[128];
+    Silent d;
+    d.loc = loc;
+    d.loc_size = sizeof(loc);
+
+    /*
+        snapshot
+     */
+    clock_t t_on = clock();
+    size_t ref_len = subtree_serialize(snapshot.data(), snapshot.size(),
+                                       source, &Synth::ports);
+    clock_t t_off = clock();
+    print_results("subtree_serialize (reference)", t_on, t_off, 1);
+
+    SubtreeSerializer ser(Synth::ports);
+    t_on = clock();
+    for(int i = 0; i < num_restores; ++i)
+    {
+        ser.begin(snapshot.data(), snapshot.size(), source);
+        ser.resume();
+    }
+    t_off = clock();
+    print_results("SubtreeSerializer", t_on, t_off, num_restores);
+    assert_int_eq(SubtreeSerializer::done, ser.status(),
+                  "snapshot is complete", __LINE__);
+    assert_int_eq(ref_len, ser.length(), "same snapshot size", __LINE__);
+    assert_int_eq(num_params, rtosc_bundle_elements(snapshot.data(),
+                                                    ser.length()),
+                  "one message per parameter", __LINE__);
+
+    /*
+        reference: fetch and dispatch each element, like
+        subtree_deserialize() did before
+     */
+    fill(target, 2);
+    t_on = clock();
+    for(int i = 0; i < num_params; ++i)
+    {
+        d.obj = target;
+        Synth::ports.dispatch(rtosc_bundle_fetch(snapshot.data(), i)+1, d);
+    }
+    t_off = clock();
+    print_results("fetch and dispatch (reference)", t_on, t_off, 1);
+    assert_true(same_values(source, target), "reference restores all values",
+                __LINE__);
+
+    /*
+        subtree_deserialize()
+     */
+    fill(target, 3);
+    t_on = clock();
+    for(int i = 0; i < num_restores; ++i)
+        subtree_deserialize(snapshot.data(), ser.length(), target,
+                            &Synth::ports, d);
+    t_off = clock();
+    print_results("subtree_deserialize", t_on, t_off, num_restores);
+    assert_true(same_values(source, target),
+                "subtree_deserialize restores all values", __LINE__);
+
+    /*
+        restore() through the route table
+     */
+    fill(target, 4);
+    t_on = clock();
+    for(int i = 0; i < num_restores; ++i)
+        ser.restore(snapshot.data(), ser.length(), target, d);
+    t_off = clock();
+    print_results("restore", t_on, t_off, num_restores);
+    assert_true(same_values(source, target), "restore() restores all values",
+                __LINE__);
+
+    delete source;
+    delete target;
+    return test_summary();
+}
@@ -0,0 +1,131 @@
+//Test to verify the socket transports have enough throughput and low latency
+
+#include <chrono>
+#include <cstdio>
+#include <string>
+#include <vector>
+#include <unistd.h>
+
+#include <rtosc/rtosc.h>
+#include <rtosc/thread-link.h>
+#include <rtosc/transport.h>
+#include "common.h"
+
+using namespace rtosc;
+
+constexpr int num_messages = 200000;
+constexpr int batch_size = 64; //!< must divide num_messages
+constexpr int num_round_trips = 10000;
+
+//the time is mostly spent waiting for the kernel, so measure wall time
+typedef std::chrono::steady_clock clock_type;
+
+static double seconds_since(clock_type::time_point t_on)
+{
+    return std::chrono::duration<double>(clock_type::now() - t_on).count();
+}
+
+//! Send messages in batches from @p a to @p b, which passes them to a link
+static int throughput(connection &a, connection &b, const char *what)
+{
+    std::vector<std::string> messages;
+    char buffer[64];
+    for(int i = 0; i < batch_size; ++i)
+        messages.emplace_back(buffer, rtosc_message(buffer, sizeof(buffer),
+                                                    "/synth/voice/volume",
+                                                    "f", i / 64.f));
+    std::vector<const char*> data;
+    std::vector<size_t> lengths;
+    for(const std::string &m : messages) {
+        data.push_back(m.data());
+        lengths.push_back(m.size());
+    }
+
+    ThreadLink link(64, 4 * batch_size);
+    int received = 0;
+    clock_type::time_point t_on = clock_type::now();
+    for(int sent = 0; sent < num_messages; sent += batch_size)
+    {
+        a.send(data.data(), lengths.data(), batch_size);
+        for(int now = 0; now < batch_size; ) {
+            size_t got = b.receive(link, 1000);
+            if(!got)
+                break;
+            now += got;
+        }
+        while(link.hasNext()) {
+            link.read();
+            ++received;
+        }
+    }
+    double seconds = seconds_since(t_on);
+    printf("# %s: %8.2f seconds for %d messages\n", what, seconds,
+           num_messages);
+    printf("# %s: %8.2f million messages per second\n", what,
+           received / seconds / 1e6);
+    return received;
+}
+
+//! Send single messages back and forth
+static int latency(connection &a, connection &b, const char *what)
+{
+    char msg[64];
+    size_t len = rtosc_message(msg, sizeof(msg), "/ping", "i", 0);
+    int round_trips = 0;
+    auto ignore = [](const char *, size_t) {};
+    clock_type::time_point t_on = clock_type::now();
+    for(int i = 0; i < num_round_trips; ++i)
+    {
+        a.send(msg, len);
+        if(!b.receive(ignore, 1000))
+            break;
+        b.send(msg, len);
+        if(!a.receive(ignore, 1000))
+            break;
+        ++round_trips;
+    }
+    double seconds = seconds_since(t_on);
+    printf("# %s: %8.2f us per round trip\n", what,
+           seconds * 1e6 / num_round_trips);
+    return round_trips;
+}
+
+static void run(connection &a, connection &b, const char *what)
+{
+    assert_int_eq(num_messages, throughput(a, b, what),
+                  "all messages received", __LINE__);
+    assert_int_eq(num_round_trips, latency(a, b, what),
+                  "all round trips done", __LINE__);
+}
+
+int main()
+{
+    listener tcp = listener::tcp();
+    for(framing f : {framing::slip, framing::length_prefix})
+    {
+        const char *what = f == framing::slip ? "TCP, SLIP"
+                                              : "TCP, length prefix";
+        connection a = connection::tcp("127.0.0.1", tcp.port(), f);
+        connection b = tcp.accept(f, 1000);
+        run(a, b, what);
+    }
+
+    std::string path = "/tmp/rtosc-performance-transport-" +
+                       std::to_string(getpid());
+    listener local = listener::unix_socket(path.c_str());
+    for(framing f : {framing::slip, framing::length_prefix})
+    {
+        const char *what = f == framing::slip ? "UNIX, SLIP"
+                                              : "UNIX, length prefix";
+        connection a = connection::unix_socket(path.c_str(), f);
+        connection b = local.accept(f, 1000);
+        run(a, b, what);
+    }
+
+    connection a = connection::udp(0);
+    connection b = connection::udp(0, "127.0.0.1", a.local_port());
+    a.connect_udp("127.0.0.1", b.local_port());
+    run(a, b, "UDP");
+
+    return test_summary();
+}
@@ -0,0 +1,77 @@
+//Test to verify the cost of recording undo events on the realtime thread is
+//small enough
+
+#include <ctime>
+#include <cstdio>
+#include <vector>
+
+#include <rtosc/rtosc.h>
+#include <rtosc/undo-history.h>
+#include "common.h"
+
+using namespace rtosc;
+
+constexpr int num_events = 1000000;
+constexpr int num_paths = 100;
+// events recorded between two drains, like per audio buffer
+constexpr int batch_size = 64;
+
+void print_results(const char* what, clock_t elapsed, int count)
+{
+    double seconds = elapsed * 1.0 / CLOCKS_PER_SEC;
+    printf("# %s: %8.2f seconds for the test\n", what, seconds);
+    printf("# %s: %8.2f ns per event\n", what, seconds*1e9/count);
+}
+
+int main()
+{
+    // undo events of parameter changes, like from rCAPPLY
+    std::vector<std::vector<char>> msgs(num_paths, std::vector<char>(128));
+    for(int i = 0; i < num_paths; ++i)
+    {
+        char path[32];
+        snprintf(path, sizeof(path), "/part%d/Pvolume", i);
+        rtosc_message(msgs[i].data(), 128, "/undo_change", "sii",
+                      path, i, i+1);
+    }
+
+    /*
+        reference: recording directly into the history
+     */
+    {
+        UndoHistory hist;
+        clock_t t_on = clock();
+        for(int i = 0; i < num_events; ++i)
+            hist.recordEvent(msgs[i % num_paths].data());
+        clock_t t_off = clock();
+        print_results("recordEvent (reference)", t_off - t_on, num_events);
+    }
+
+    /*
+        recording on the realtime thread, draining on another one
+     */
+    UndoHistory hist;
+    UndoRecorder rec(hist, 64*1024);
+    clock_t t_record = 0, t_drain = 0;
+    size_t drained = 0;
+    for(int i = 0; i < num_events; i += batch_size)
+    {
+        clock_t t_on = clock();
+        for(int j = i; j < i + batch_size && j < num_events; ++j)
+            rec.record(msgs[j % num_paths].data());
+        clock_t t_mid = clock();
+        drained += rec.drain();
+        clock_t t_off = clock();
+        t_record += t_mid - t_on;
+        t_drain += t_off - t_mid;
+    }
+    print_results("UndoRecorder::record", t_record, num_events);
+    print_results("UndoRecorder::drain", t_drain, num_events);
+
+    assert_int_eq(0, rec.lost(), "no events are lost", __LINE__);
+    assert_true(drained == num_events, "all events are drained", __LINE__);
+    assert_int_eq(num_paths, hist.size(), "events are merged when draining",
+                  __LINE__);
+
+    return test_summary();
+}
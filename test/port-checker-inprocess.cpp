@@ -0,0 +1,223 @@
+#include <cstdio>
+#include <cstring>
+#include <rtosc/ports.h>
+#include <rtosc/port-sugar.h>
+#include <rtosc/port-checker.h>
+
+#include "common.h"
+
+//! @file port-checker-inprocess.cpp
+//! Tests port checker with the in-process backend, using the ports of
+//! port-checker-testapp.cpp
+
+using issue = rtosc::issue;
+
+struct app_t
+{
+    int rdefault_without_rparameter = 0;
+    int roption_without_ics = 0;
+    int double_rdefault = 0;
+    int double_rpreset = 0;
+    int rpreset_without_rdefaultdepends = 0;
+    int rpreset_not_in_roptions = 0;
+    int perfect_param_1 = 0;
+    int duplicate_mapping = 0;
+    int no_rdefault = 0;
+    int bundle_size[16];
+    int perfect_param_2[16];
+    int perfect_param_3 = 0;
+    int invalid_rdefault;
+    int duplicate_param;
+    bool enabling_toggle = true;
+    int toggle_enabled_param = 0;
+};
+
+// same ports as in port-checker-testapp.cpp
+#define rObject app_t
+static const rtosc::Ports app_ports = {
+/*
+    // known issue: leads to infinite recursion from path-search
+    {"trailing_slash_without_subports/", 0, 0, null_fn},
+*/
+    {"echo:ss", 0, 0, [](const char* msg, rtosc::RtData& d) {
+        const char* type = rtosc_argument(msg, 0).s;
+        const char* url = rtosc_argument(msg, 1).s;
+        d.reply("/echo", "ss", type, url);
+    }},
+    {"duplicate_mapping::i:S", rOptions(same, same), NULL,
+        rParamICb(duplicate_mapping)},
+    {"rdefault_without_rparameter_A::i", rDefault(0), NULL,
+        rParamICb(rdefault_without_rparameter)},
+    {"invalid_rdefault::i", rProp(parameter) rDefault($$$), NULL,
+        rParamICb(invalid_rdefault)},
+    {"rdefault_without_rparameter_B::i",
+        rDefaultDepends(no_rdefault) rPresets(0,1,2), NULL,
+        rParamICb(rdefault_without_rparameter)},
+    {"no_query::i", rProp(parameter) rDefault(0), nullptr,
+        [](const char*, rtosc::RtData&) {} },
+    {"no_reply_A::i", rProp(parameter) rDefault(0), NULL,
+        [](const char* msg, rtosc::RtData& d) {
+            const char *args = rtosc_argument_string(msg);
+            if(!*args) { d.reply(d.loc, "i", 0); }
+        }
+    },
+    {"no_reply_B::i", rProp(parameter) rDefault(0), NULL,
+        [](const char* msg, rtosc::RtData& d) {
+            const char *args = rtosc_argument_string(msg);
+            if(!*args) {
+                d.reply(d.loc, "i", 0);
+            } else {
+                int var = rtosc_argument(msg, 0).i;
+                d.reply("/undo_change", "s" "i" "i", d.loc,
+                        (var==0) ? 1 : 0, var);
+                // reply is missing here
+            }
+        }
+    },
+    {"no_broadcast::i", rProp(parameter) rDefault(0), NULL,
+        [](const char* msg, rtosc::RtData& d) {
+            const char *args = rtosc_argument_string(msg);
+            if(!*args) {
+                d.reply(d.loc, "i", 0);
+            } else {
+                int var = rtosc_argument(msg, 0).i;
+                d.reply("/undo_change", "s" "i" "i", d.loc,
+                        (var==0) ? 1 : 0, var);
+                d.reply(d.loc, "i", var); // this should be d.broadcast...
+            }
+        }
+    },
+    {"enumeration_without_ics::i:c", rProp(enumerated) rProp(parameter) rDefault(0),
+        nullptr, rOptionCb(roption_without_ics)
+    },
+    {"roptions_without_ics::i:c", rOptions(a,b,c) rProp(parameter) rDefault(0),
+        nullptr, rOptionCb(roption_without_ics)
+    },
+    rParamI(no_rdefault, ""),
+    rParamI(double_rdefault, rDefault(0) rDefault(0), ""),
+    rParamI(double_rpreset, rDefaultDepends(no_rdefault),
+            rPreset(0, 1), rPreset(1, 0), rPreset(0, 1), ""),
+    rParamI(rpreset_without_rdefaultdepends, rPreset(0, 1), ""),
+    rArrayI(bundle_size, 16, rDefault([15x2]), ""),
+    rOption(rpreset_not_in_roptions,
+            rDefaultDepends(no_rdefault), rOptions(one, two, three),
+            rPresetsAt(2, one, does_not_exist, one), rDefault(two), ""),
+
+    rParamI(duplicate_param, rNoDefaults, ""),
+    rParamI(duplicate_param, rNoDefaults, ""),
+
+    rOption(perfect_param_1, rOptions(one, two, three),
+            rDefaultDepends(no_rdefault),
+            rPresetsAt(2, one, three, one), rDefault(two), ""),
+    rArrayI(perfect_param_2, 16, rDefault([1 2 3...]), ""),
+    rParamI(perfect_param_3, rNoDefaults, ""), // no rDefault, but that's OK here
+    // correct enabled-condition
+    rEnabledCondition(not_enabled, false),
+    // invalid enabled-condition: returns float
+    {"not_enabled_bad:", rProp(internal), NULL,
+        [](const char* , rtosc::RtData& d){d.reply(d.loc, "f", 42.f); }},
+    // bad parameter, but does not occur since it is disabled:
+    {"invisible_param::i", rEnabledByCondition(not_enabled), NULL,
+     [](const char* , rtosc::RtData& ){}},
+    {"enabled_port_not_existing::i", rEnabledByCondition(not_existing), NULL,
+     [](const char* , rtosc::RtData& ){}},
+    {"enabled_port_bad_reply::i", rEnabledByCondition(not_enabled_bad), NULL,
+     [](const char* , rtosc::RtData& ){}},
+    // the check of enabling_toggle changes it, but this must not affect
+    // whether toggle_enabled_param is checked
+    rToggle(enabling_toggle, rDefault(true), ""),
+    rParamI(toggle_enabled_param, rEnabledBy(enabling_toggle), rNoDefaults, "")
+};
+#undef rObject
+
+std::multimap<issue, std::string> get_exp()
+{
+    // test expectations
+    // note: must be conforming to port-checker-testapp.cpp
+    // note: if you add new ports, please try to only let each new port
+    //       occur in at most one category
+
+    std::multimap<issue, std::string> exp;
+
+/*  known issue, see port-checker-testapp.cpp
+    exp.emplace(issue::trailing_slash_without_subports,
+                "/trailing_slash_without_subports/");*/
+    exp.emplace(issue::duplicate_parameter, "/duplicate_param");
+
+    exp.emplace(issue::parameter_not_queryable, "/no_query::i");
+    exp.emplace(issue::parameter_not_replied, "/no_reply_A::i");
+    exp.emplace(issue::parameter_not_replied, "/no_reply_B::i");
+    exp.emplace(issue::parameter_not_broadcast, "/no_broadcast::i");
+
+    exp.emplace(issue::enumeration_port_not_si, "/enumeration_without_ics::i:c");
+    exp.emplace(issue::roptions_port_not_si, "/roptions_without_ics::i:c");
+    exp.emplace(issue::duplicate_mapping, "/duplicate_mapping::i:S");
+    exp.emplace(issue::enabled_port_not_replied,
+                "/enabled_port_not_existing::i");
+    exp.emplace(issue::enabled_port_bad_reply, "/enabled_port_bad_reply::i");
+
+    exp.emplace(issue::rdefault_missing, "/no_rdefault::i");
+    exp.emplace(issue::rdefault_multiple, "/double_rdefault::i");
+    exp.emplace(issue::rpreset_multiple, "/double_rpreset::i");
+    exp.emplace(issue::rpreset_without_rdefaultdepends, "/rpreset_without_rdefaultdepends::i");
+    exp.emplace(issue::rdefault_without_rparameter,
+                "/rdefault_without_rparameter_A::i");
+    exp.emplace(issue::rdefault_without_rparameter,
+                "/rdefault_without_rparameter_B::i");
+    exp.emplace(issue::invalid_default_format, "/invalid_rdefault::i");
+    exp.emplace(issue::bundle_size_not_matching_rdefault,
+                "/bundle_size#16::i");
+    exp.emplace(issue::rdefault_not_infinite, "/bundle_size#16::i");
+    exp.emplace(issue::default_cannot_canonicalize,
+                "/rpreset_not_in_roptions::i:c:S");
+
+    return exp;
+}
+
+static void check(const char* what, rtosc::port_checker& checker)
+{
+    using issue_map = std::multimap<issue, std::string>;
+    checker("inprocess");
+    char buf[128];
+
+    snprintf(buf, sizeof(buf), "%s: port checker sanity", what);
+    assert_true(checker.sanity_checks(), buf, __LINE__);
+    snprintf(buf, sizeof(buf), "%s: all issues have test ports", what);
+    assert_true(checker.coverage(), buf, __LINE__);
+
+    issue_map exp = get_exp();
+    const issue_map& res = checker.issues();
+    snprintf(buf, sizeof(buf), "%s: expected number of issues", what);
+    assert_int_eq(exp.size(), res.size(), buf, __LINE__);
+    snprintf(buf, sizeof(buf), "%s: issues are as expected", what);
+    assert_true(exp == res, buf, __LINE__);
+
+    std::set<std::string> exp_skipped;
+    exp_skipped.insert("/invisible_param::i");
+    snprintf(buf, sizeof(buf), "%s: skipped ports are as expected", what);
+    assert_true(exp_skipped == checker.skipped(), buf, __LINE__);
+}
+
+int main()
+{
+    // each check changes the values, so each gets a fresh app
+    {
+        app_t app;
+        rtosc::inprocess_app inprocess(app_ports, &app);
+        rtosc::inprocess_server sender(inprocess), other(inprocess);
+        rtosc::port_checker checker(&sender, &other);
+        check("serial", checker);
+    }
+
+    {
+        app_t app;
+        rtosc::inprocess_app inprocess(app_ports, &app);
+        rtosc::inprocess_server sender(inprocess), other(inprocess),
+                                sender2(inprocess), other2(inprocess);
+        rtosc::port_checker checker(&sender, &other);
+        checker.set_pipelined(4, {{&sender2, &other2}});
+        check("pipelined", checker);
+    }
+
+    return test_summary();
+}
@@ -1,6 +1,8 @@
 #include <cstdlib>
 #include <cstring>
 #include <iostream>
+#include <memory>
+#include <vector>
 #include <getopt.h>
 
 #include <rtosc/port-checker.h>
@@ -18,11 +20,17 @@ void usage(const char* progname)
               << "or just ppppp (which means osc.udp://127.0.0.1:ppppp/)"
               << std::endl << std::endl;
     std::cout << "Options: --timeout <time in msecs>" << std::endl;
+    std::cout << "         --window <parameter checks in flight per connection>"
+              << std::endl;
+    std::cout << "         --connections <number of connections>"
+              << std::endl;
 }
 
 struct port_checker_options
 {
     int timeout_msecs = 50;
+    int window = 0; //!< 0 means serial checks
+    int connections = 1;
 };
 
 int run_port_checker(const char* url,
@@ -32,6 +40,22 @@ int run_port_checker(const char* url,
     try {
         rtosc::liblo_server sender(checker_opts.timeout_msecs), other(checker_opts.timeout_msecs);
         rtosc::port_checker checker(&sender, &other);
+        std::vector<std::unique_ptr<rtosc::liblo_server>> more_servers;
+        if(checker_opts.window)
+        {
+            std::vector<std::pair<rtosc::port_checker::server*,
+                                  rtosc::port_checker::server*>> connections;
+            for(int i = 1; i < checker_opts.connections; ++i)
+            {
+                more_servers.emplace_back(
+                    new rtosc::liblo_server(checker_opts.timeout_msecs));
+                more_servers.emplace_back(
+                    new rtosc::liblo_server(checker_opts.timeout_msecs));
+                connections.emplace_back(more_servers[more_servers.size()-2].get(),
+                                         more_servers.back().get());
+            }
+            checker.set_pipelined(checker_opts.window, connections);
+        }
         checker(url);
 
         if(!checker.print_sanity_checks())
@@ -74,6 +98,8 @@ int main(int argc, char** argv)
         // options with single char equivalents
         { "help", 0, nullptr, 'h' },
         { "timeout", 1, nullptr, 't' },
+        { "window", 1, nullptr, 'w' },
+        { "connections", 1, nullptr, 'c' },
         { nullptr, 0, nullptr, 0 }
     };
     opterr = 0;
@@ -86,7 +112,7 @@ int main(int argc, char** argv)
     // parse options
     while(1)
     {
-        opt = getopt_long(argc, argv, "ht:", opts, &option_index);
+        opt = getopt_long(argc, argv, "ht:w:c:", opts, &option_index);
         if(opt == -1)
             break;
 
@@ -101,6 +127,18 @@ int main(int argc, char** argv)
                     mk_err("Timeout must be a parameter >0");
                 }
                 break;
+            case 'w':
+                checker_opts.window = atoi(optarg);
+                if(checker_opts.window <= 0) {
+                    mk_err("Window must be a parameter >0");
+                }
+                break;
+            case 'c':
+                checker_opts.connections = atoi(optarg);
+                if(checker_opts.connections <= 0) {
+                    mk_err("Connections must be a parameter >0");
+                }
+                break;
             case '?':
                 mk_err("Bad option or parameter (use --help)");
         }
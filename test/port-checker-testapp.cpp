@@ -120,6 +120,8 @@ public:
     int perfect_param_3 = 0;
     int invalid_rdefault;
     int duplicate_param;
+    bool enabling_toggle = true;
+    int toggle_enabled_param = 0;
 
     void add_url(const char* url);
     void run();
@@ -220,7 +222,11 @@ static const rtosc::Ports test_ports = {
     {"enabled_port_not_existing::i", rEnabledByCondition(not_existing), NULL,
      [](const char* , rtosc::RtData& ){}},
     {"enabled_port_bad_reply::i", rEnabledByCondition(not_enabled_bad), NULL,
-     [](const char* , rtosc::RtData& ){}}
+     [](const char* , rtosc::RtData& ){}},
+    // the check of enabling_toggle changes it, but this must not affect
+    // whether toggle_enabled_param is checked
+    rToggle(enabling_toggle, rDefault(true), ""),
+    rParamI(toggle_enabled_param, rEnabledBy(enabling_toggle), rNoDefaults, "")
 };
 #undef rObject
 
@@ -1,3 +1,4 @@
+#include <chrono>
 #include <cstdlib>
 #include <cstring>
 #include <iostream>
@@ -81,7 +82,9 @@ int main(int argc, char** argv)
         int timeout_msecs = 50;
         rtosc::liblo_server sender(timeout_msecs), other(timeout_msecs);
         rtosc::port_checker checker(&sender, &other);
+        auto t_on_serial = std::chrono::steady_clock::now();
         checker(argv[1]);
+        auto t_serial = std::chrono::steady_clock::now() - t_on_serial;
 
         assert_true(checker.sanity_checks(), "Port checker sanity", __LINE__);
         // we keep it clean, but if you ever need help:
@@ -102,6 +105,26 @@ int main(int argc, char** argv)
         exp_skipped.insert("/invisible_param::i");
         assert_true(exp_skipped == checker.skipped(), "Skipped ports are as "
                                                       "expected", __LINE__);
+
+        // pipelined checks over 3 connections must find the same issues
+        rtosc::liblo_server sender1(timeout_msecs), other1(timeout_msecs),
+                            sender2(timeout_msecs), other2(timeout_msecs),
+                            sender3(timeout_msecs), other3(timeout_msecs);
+        rtosc::port_checker pipelined(&sender1, &other1);
+        pipelined.set_pipelined(16, {{&sender2, &other2},
+                                     {&sender3, &other3}});
+        auto t_on = std::chrono::steady_clock::now();
+        pipelined(argv[1]);
+        auto t_pipelined = std::chrono::steady_clock::now() - t_on;
+        assert_true(res == pipelined.issues(),
+                    "Pipelined checks find the same issues", __LINE__);
+        assert_true(exp_skipped == pipelined.skipped(),
+                    "Pipelined checks skip the same ports", __LINE__);
+        std::cout << "# serial: "
+                  << std::chrono::duration<double>(t_serial).count()
+                  << "s, pipelined: "
+                  << std::chrono::duration<double>(t_pipelined).count()
+                  << "s" << std::endl;
     }
     catch(const std::exception& e) {
         std::cerr << "**Error caught**: " << e.what() << std::endl;
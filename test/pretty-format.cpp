@@ -26,11 +26,48 @@
 #include <rtosc/rtosc.h>
 #include <rtosc/arg-ext.h>
 #include <rtosc/pretty-format.h>
+#include <climits>
+#include <string>
 #include "common.h"
 
 rtosc_arg_val_t scanned[32];
 #define BUF_LEN 256
 
+/**
+ * @brief check that the single pass scanner yields the same arg vals as
+ *   the two pass scanner did (they must be in the global "scanned" array)
+ */
+void check_single_pass(const char* arg_val_str, int num,
+                       const char* tc_base, int line)
+{
+    rtosc_arena_t arena;
+    rtosc_arena_init(&arena, 64);
+
+    std::string msg = "/address ";
+    msg += arg_val_str;
+    const char* address;
+    rtosc_arg_val_t* args;
+    size_t nargs;
+    int rd = rtosc_scan_message_arena(msg.c_str(), &address, &args, &nargs,
+                                      &arena);
+
+    std::string tc = std::string("single pass scan \"") + tc_base + "\"";
+    assert_int_eq(msg.length(), rd, (tc + " (read the whole string)").c_str(),
+                  line);
+    assert_str_eq("/address", address, (tc + " (address)").c_str(), line);
+    assert_int_eq(num, nargs, (tc + " (number of arg vals)").c_str(), line);
+
+    // compare the lossless printed results (rtosc_arg_vals_eq can not
+    // compare all kinds of ranges)
+    char exp_print[512] = " ", single_pass_print[512] = " ";
+    rtosc_print_arg_vals(scanned, num, exp_print + 1, 511, NULL, 0);
+    rtosc_print_arg_vals(args, nargs, single_pass_print + 1, 511, NULL, 0);
+    assert_str_eq(exp_print + 1, single_pass_print + 1,
+                  (tc + " (same as two pass scan)").c_str(), line);
+
+    rtosc_arena_destroy(&arena);
+}
+
 /**
  * @brief check_alt like check, but specify an alternative expectation
  * @see check()
@@ -64,6 +101,8 @@ void check_alt(const char* arg_val_str, const rtosc_print_options* opt,
             tc_len - strlen(tc_full));
     assert_int_eq(strlen(arg_val_str), rd, tc_full, line);
 
+    check_single_pass(arg_val_str, num, tc_base, line);
+
     size_t len = 128;
     char* printed = new char[len];
     memset(printed, 0x7f, len); /* init with rubbish */
@@ -158,6 +197,8 @@ void scan_and_print_single()
     check_alt("1234567890.098700d", &prec6,
               "a double that would not fit into a float", __LINE__,
               "1234567890.098700d (0x1.26580b486511ap+30)");
+    check("1234567890.098700d (0x1.26580b486511ap+30)", &prec6,
+          "a double with lossless part", __LINE__);
 
     /*
         floats
@@ -349,6 +390,10 @@ void ranges()
     check_alt("[ 1 ... 3 ]", &uncompressed,
               "range with delta 1 in an array", __LINE__,
               "[1 2 3]");
+    check_alt("[1 2] 1 ... 3", &uncompressed,
+              "range after an array", __LINE__,
+              "[1 2] 1 2\n"
+              "    3");
     check_alt("[3...0]", &uncompressed,
               "range with delta -1 in an array", __LINE__,
               "[3 2 1 0]");
@@ -487,6 +532,20 @@ void fail_at_arg(const char* arg_val_str, int exp_fail, int line)
     int num = rtosc_count_printed_arg_vals(arg_val_str);
     snprintf(tc_full, BUF_LEN, "find 1st invalid arg in \"%s\"", arg_val_str);
     assert_int_eq(exp_fail, -num, tc_full, line);
+
+    rtosc_arena_t arena;
+    rtosc_arena_init(&arena, 64);
+    std::string msg = "/address ";
+    msg += arg_val_str;
+    const char* address;
+    rtosc_arg_val_t* args;
+    size_t nargs;
+    int rd = rtosc_scan_message_arena(msg.c_str(), &address, &args, &nargs,
+                                      &arena);
+    snprintf(tc_full, BUF_LEN, "find 1st invalid arg in \"%s\" in one pass",
+             arg_val_str);
+    assert_int_eq(exp_fail, -rd, tc_full, line);
+    rtosc_arena_destroy(&arena);
 }
 
 void messages()
@@ -529,6 +588,46 @@ void messages()
                   __LINE__);
     delete[] printed;
 
+    {
+        rtosc_arena_t arena;
+        rtosc_arena_init(&arena, 16);
+        const char* address;
+        rtosc_arg_val_t* args;
+        size_t nargs;
+        rd = rtosc_scan_message_arena(input, &address, &args, &nargs, &arena);
+        assert_int_eq(strlen(input), rd,
+                      "read a message in one pass", __LINE__);
+        assert_str_eq("/noteOn", address,
+                      "scan address in one pass", __LINE__);
+        assert_int_eq(3, nargs, "scan args in one pass", __LINE__);
+        assert_int_eq(-1, rtosc_scan_message_arena("noteOn 0", &address,
+                                                   &args, &nargs, &arena),
+                      "one pass: return -1 for missing slash", __LINE__);
+        assert_int_eq(INT_MIN,
+                      rtosc_scan_message_arena(" \n% comment\n  ", &address,
+                                               &args, &nargs, &arena),
+                      "one pass: return INT_MIN for whitespace", __LINE__);
+
+        // reuse the arena for a message with many args
+        rtosc_arena_reset(&arena);
+        std::string many = "/many";
+        for(int i = 0; i < 100; ++i)
+            many += " \"str\" " + std::to_string(i) + ".5";
+        rd = rtosc_scan_message_arena(many.c_str(), &address,
+                                      &args, &nargs, &arena);
+        assert_int_eq(many.length(), rd,
+                      "read a message with many args in one pass", __LINE__);
+        assert_int_eq(200, nargs,
+                      "scan many args in one pass", __LINE__);
+        assert_flt_eq(99.5f, args[199].val.f,
+                      "one pass: last of many args is correct", __LINE__);
+        // the syntax check accepts this, but the scanner must not abort
+        assert_true(rtosc_scan_message_arena("/a 2x1 ... 5", &address, &args,
+                                             &nargs, &arena) < 0,
+                    "one pass: return error for an invalid range", __LINE__);
+        rtosc_arena_destroy(&arena);
+    }
+
     // scan message that has no parameters
     // => a following argument is not considered as an argument of
     //    the first message
@@ -675,6 +774,8 @@ void scan_invalid()
     // this has been disallowed (intercepting ranges):
     // was the intention "... 11 12 13 14 15" or "... 11 13 15" ?
     fail_at_arg("1 3 ... 11 ... 15", 5 , __LINE__);
+    // the range after an array must not take the array's last element
+    fail_at_arg("[1 ... 5] 1 ... 5 1.5.5", 8, __LINE__);
 
     BAD("2x");
 
@@ -690,8 +791,39 @@ void scan_invalid()
 #undef BAD
 }
 
+//! print an int64 and a double into buffers which are too small
+void print_truncated()
+{
+    auto lossy = make_print_options(false, 3, " ", 80, false);
+    rtosc_arg_val_t av;
+    char buf[16];
+    int errors = 0;
+
+    // "1234567h" and "1.500d", with the suffix or more not fitting
+    struct { char type; size_t bs; } cases[] = {
+        {'h', 7}, {'h', 8}, {'d', 6}
+    };
+    for(const auto& c : cases)
+    {
+        av.type = c.type;
+        if(c.type == 'd')
+            av.val.d = 1.5;
+        else
+            av.val.h = 1234567;
+        int cols = 0;
+        memset(buf, 'x', sizeof(buf));
+        size_t len = rtosc_print_arg_val(&av, buf, c.bs, &lossy, &cols,
+                                         NULL);
+        errors += (len != (c.type == 'd' ? 6u : 8u)) + (buf[c.bs] != 'x') +
+                  (strlen(buf) >= c.bs);
+    }
+    assert_int_eq(0, errors, "int64 and double suffixes are truncated",
+                  __LINE__);
+}
+
 int main()
 {
+    print_truncated();
     scan_and_print_single();
     scan_and_print_mulitple();
     arrays();
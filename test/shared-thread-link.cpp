@@ -0,0 +1,114 @@
+#include "common.h"
+#include <string>
+#include <stdexcept>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <rtosc/shared-thread-link.h>
+
+using namespace rtosc;
+
+static std::string link_name(const char *what)
+{
+    return std::string("/rtosc-test-") + what + "-" +
+           std::to_string(getpid());
+}
+
+void test_two_mappings()
+{
+    std::string name = link_name("mappings");
+    SharedThreadLink writer(name.c_str(), 64, 4);
+    SharedThreadLink reader(name.c_str());
+
+    assert_int_eq(writer.buffer_size(), reader.buffer_size(),
+                  "sizes are taken from the shared memory", __LINE__);
+    assert_false(reader.hasNext(), "initially empty", __LINE__);
+
+    // wrap around a few times
+    int mismatches = 0;
+    for(int i = 0; i < 20; ++i)
+    {
+        writer.write("/some/path", "i", i);
+        writer.write("/some/path", "i", -i);
+        mismatches += !reader.hasNext() ||
+                      rtosc_argument(reader.read(), 0).i != i;
+        mismatches += !reader.hasNext() ||
+                      rtosc_argument(reader.read(), 0).i != -i;
+    }
+    assert_int_eq(0, mismatches, "messages are passed", __LINE__);
+    assert_false(reader.hasNext(), "all messages read", __LINE__);
+
+    assert_false(reader.wait(10), "wait times out", __LINE__);
+    writer.write("/foo", "");
+    writer.notify();
+    assert_true(reader.wait(10), "wait returns after a write", __LINE__);
+    assert_str_eq("/foo", reader.read(), "message after wait", __LINE__);
+}
+
+void test_open_errors()
+{
+    std::string name = link_name("errors");
+    bool thrown = false;
+    try {
+        SharedThreadLink reader(name.c_str());
+    } catch(const std::runtime_error&) {
+        thrown = true;
+    }
+    assert_true(thrown, "opening a missing link throws", __LINE__);
+
+    {
+        SharedThreadLink writer(name.c_str(), 64, 4);
+    }
+    thrown = false;
+    try {
+        SharedThreadLink reader(name.c_str());
+    } catch(const std::runtime_error&) {
+        thrown = true;
+    }
+    assert_true(thrown, "the creator removes the link", __LINE__);
+}
+
+void test_processes()
+{
+    std::string to_child = link_name("to-child"),
+                to_parent = link_name("to-parent");
+    SharedThreadLink request(to_child.c_str(), 64, 16);
+    SharedThreadLink reply(to_parent.c_str(), 64, 16);
+
+    pid_t pid = fork();
+    if(!pid)
+    {
+        // child: answer each request with the doubled value
+        SharedThreadLink in(to_child.c_str()), out(to_parent.c_str());
+        for(int i = 0; i < 100; ++i)
+        {
+            if(!in.wait(1000))
+                _exit(1);
+            out.write("/reply", "i", 2 * rtosc_argument(in.read(), 0).i);
+            out.notify();
+        }
+        _exit(0);
+    }
+
+    int mismatches = 0;
+    for(int i = 0; i < 100; ++i)
+    {
+        request.write("/request", "i", i);
+        request.notify();
+        mismatches += !reply.wait(1000) ||
+                      rtosc_argument(reply.read(), 0).i != 2 * i;
+    }
+    int status;
+    waitpid(pid, &status, 0);
+    assert_int_eq(0, mismatches, "replies from the other process", __LINE__);
+    assert_true(WIFEXITED(status) && !WEXITSTATUS(status),
+                "other process succeeded", __LINE__);
+}
+
+int main()
+{
+    test_two_mappings();
+    test_open_errors();
+    test_processes();
+    return test_summary();
+}
@@ -0,0 +1,203 @@
+#include <cstring>
+#include <vector>
+
+#include <rtosc/rtosc.h>
+#include <rtosc/ports.h>
+#include <rtosc/port-sugar.h>
+#include <rtosc/state-snapshot.h>
+#include "common.h"
+
+using namespace rtosc;
+
+struct Voice
+{
+    float   volume;
+    int     detune;
+    unsigned char velocity;
+    bool    enabled;
+    int     wave;
+    float   harmonics[4];
+    char    name[16];
+    static Ports ports;
+};
+
+//bitfields can not be probed, so their ports are not in a snapshot
+struct Flags
+{
+    unsigned mute : 1;
+    unsigned mode : 3;
+    static Ports ports;
+};
+
+struct Synth
+{
+    Voice voice[2];
+    double tempo;
+    Flags flags;
+    static Ports ports;
+};
+
+#define rObject Flags
+Ports Flags::ports = {
+    rToggle(mute, "mute"),
+    rOption(mode, rOptions(a, b, c), "mode"),
+};
+#undef rObject
+
+#undef  rSTORAGE
+#define rSTORAGE rStorageProbe
+
+#define rObject Voice
+Ports Voice::ports = {
+    rParamF(volume, rLinear(0, 1), "volume"),
+    rParamI(detune, rLinear(-64, 63), "detune"),
+    rParam(velocity, "velocity"),
+    rToggle(enabled, "enabled"),
+    rOption(wave, rOptions(sine, saw, square), "waveform"),
+    rArrayF(harmonics, 4, "harmonics"),
+    rString(name, 16, "not a parameter"),
+};
+#undef rObject
+
+#define rObject Synth
+Ports Synth::ports = {
+    rRecurs(voice, 2, "voices"),
+    rParamF(tempo, "tempo"),
+    rRecur(flags, "flags"),
+};
+#undef rObject
+
+#undef  rSTORAGE
+#define rSTORAGE(var, kind)
+
+static void fill(Synth &s, int seed)
+{
+    for(int i = 0; i < 2; ++i) {
+        Voice &v = s.voice[i];
+        v.volume   = seed * 0.1f + i;
+        v.detune   = seed * 10 - i;
+        v.velocity = seed * 20 + i;
+        v.enabled  = seed % 2;
+        v.wave     = seed % 3;
+        for(int j = 0; j < 4; ++j)
+            v.harmonics[j] = seed + j * 0.5f;
+        snprintf(v.name, sizeof(v.name), "seed %d", seed);
+    }
+    s.tempo = 100 + seed;
+}
+
+static bool same(const Synth &a, const Synth &b)
+{
+    for(int i = 0; i < 2; ++i) {
+        const Voice &va = a.voice[i], &vb = b.voice[i];
+        if(va.volume != vb.volume || va.detune != vb.detune ||
+           va.velocity != vb.velocity || va.enabled != vb.enabled ||
+           va.wave != vb.wave || memcmp(va.harmonics, vb.harmonics,
+                                        sizeof(va.harmonics)))
+            return false;
+    }
+    return a.tempo == b.tempo;
+}
+
+void test_layout()
+{
+    Synth s;
+    StateSnapshot snap(Synth::ports, &s);
+    assert_int_eq(2*9+1, snap.size(), "all parameters, but no strings",
+                  __LINE__);
+    assert_int_eq(2*(4+4+1+1+4+16)+8, snap.image_size(),
+                  "image is compact", __LINE__);
+    assert_str_eq("/voice0/volume", snap.path(0), "first path", __LINE__);
+    assert_str_eq("/voice1/harmonics3", snap.path(17), "array path",
+                  __LINE__);
+    assert_str_eq("/tempo", snap.path(18), "last path", __LINE__);
+    assert_null(snap.path(19), "no path after the last", __LINE__);
+
+    //bitfields work with the ports, but without probing
+    char loc[128] = "/flags/mute";
+    RtData d;
+    d.loc = loc;
+    d.loc_size = sizeof(loc);
+    d.obj = &s;
+    s.flags.mute = 0;
+    char msg[64];
+    rtosc_message(msg, sizeof(msg), "flags/mute", "T");
+    Synth::ports.dispatch(msg, d);
+    assert_int_eq(1, s.flags.mute, "bitfield toggle is set", __LINE__);
+}
+
+void test_capture_apply_swap()
+{
+    Synth s, ref_a, ref_b;
+    fill(s, 1);
+    fill(ref_a, 1);
+    fill(ref_b, 2);
+    StateSnapshot snap(Synth::ports, &s);
+    std::vector<char> a(snap.image_size()), b(snap.image_size());
+
+    snap.capture(a.data());
+    fill(s, 2);
+    snap.capture(b.data());
+    snap.apply(a.data());
+    assert_true(same(s, ref_a), "image is applied", __LINE__);
+    assert_str_eq("seed 2", s.voice[0].name, "strings are untouched",
+                  __LINE__);
+
+    snap.swap(b.data());
+    assert_true(same(s, ref_b), "swapped in", __LINE__);
+    snap.swap(b.data());
+    assert_true(same(s, ref_a), "swapped back", __LINE__);
+
+    //spread over several blocks
+    for(size_t i = 0; i < snap.size(); i += 4)
+        snap.apply(b.data(), i, 4);
+    assert_true(same(s, ref_b), "applied in ranges", __LINE__);
+    snap.apply(a.data(), snap.size() - 1, 100);
+    assert_flt_eq(101, s.tempo, "range is clamped", __LINE__);
+    assert_flt_eq(2.5f, s.voice[1].harmonics[1], "others are unchanged",
+                  __LINE__);
+}
+
+void test_morph()
+{
+    Synth s, ref_b;
+    fill(s, 1);
+    fill(ref_b, 2);
+    StateSnapshot snap(Synth::ports, &s);
+    std::vector<char> a(snap.image_size()), b(snap.image_size());
+    snap.capture(a.data());
+    fill(s, 2);
+    snap.capture(b.data());
+
+    snap.morph(a.data(), b.data(), 0.25f);
+    assert_flt_eq(0.125f, s.voice[0].volume, "float is interpolated",
+                  __LINE__);
+    assert_int_eq(13, s.voice[0].detune, "int is interpolated", __LINE__);
+    assert_int_eq(26, s.voice[1].velocity, "char is interpolated", __LINE__);
+    assert_flt_eq(101.25, s.tempo, "double is interpolated", __LINE__);
+    assert_true(s.voice[0].enabled, "toggle switches at the middle",
+                __LINE__);
+    assert_int_eq(1, s.voice[0].wave, "option switches at the middle",
+                  __LINE__);
+    snap.morph(a.data(), b.data(), 0.75f);
+    assert_false(s.voice[0].enabled, "toggle has switched", __LINE__);
+    assert_int_eq(2, s.voice[0].wave, "option has switched", __LINE__);
+
+    //crossfade over 4 blocks
+    fill(s, 1);
+    snap.crossfade(a.data(), b.data(), 4);
+    int blocks = 1;
+    while(snap.process_block())
+        ++blocks;
+    assert_int_eq(4, blocks, "crossfade takes 4 blocks", __LINE__);
+    assert_true(same(s, ref_b), "crossfade ends at the target", __LINE__);
+    assert_false(snap.process_block(), "crossfade has finished", __LINE__);
+}
+
+int main()
+{
+    test_layout();
+    test_capture_apply_swap();
+    test_morph();
+    return test_summary();
+}
@@ -0,0 +1,138 @@
+#include <algorithm>
+#include <string>
+#include <vector>
+
+#include <rtosc/rtosc.h>
+#include <rtosc/subscriptions.h>
+#include "common.h"
+
+using namespace rtosc;
+
+struct subscription_t
+{
+    int client;
+    const char *pattern;
+};
+
+static const subscription_t subscriptions[] = {
+    {0, "/"},
+    {1, "/part0/"},
+    {2, "/part0/volume"},
+    {3, "/part1/voice#8/"},
+    {4, "/part{0,2}/volume"},
+    {5, "/*/volume"},
+    {6, "/part0/volume:f"},
+    {7, "/part0/volume:i"},
+    {8, "/part"},
+    {9, "/part0/voice3/freq"},
+    {9, "/part1/"}, // second pattern of a client
+    {10, "/part1/voice#8/freq:f:i"},
+    {11, "/part{0,1}/voice{3,7}/"},
+    {12, "/part{1,3}/voice#4/freq"},
+};
+
+//! Clients with a pattern that rtosc_match() accepts for @p msg
+static std::vector<int> expected(const char *msg, size_t num_subscriptions)
+{
+    std::vector<int> res;
+    for(size_t i = 0; i < num_subscriptions; ++i)
+        if(rtosc_match(subscriptions[i].pattern, msg, nullptr) &&
+           std::find(res.begin(), res.end(), subscriptions[i].client) ==
+               res.end())
+            res.push_back(subscriptions[i].client);
+    std::sort(res.begin(), res.end());
+    return res;
+}
+
+static std::vector<std::string> messages(void)
+{
+    const char *paths[] = {
+        "/part0/volume", "/part1/volume", "/part2/volume", "/part3/volume",
+        "/part0/voice3/freq", "/part1/voice3/freq", "/part1/voice9/freq",
+        "/part1/voice7/", "/part", "/part0", "/master/volume", "/volume",
+        "/part0/volumes", "/part1/voice7/freq/fine"
+    };
+    std::vector<std::string> res;
+    char buffer[128];
+    for(const char *path : paths) {
+        size_t len = rtosc_message(buffer, sizeof(buffer), path, "f", 0.5f);
+        res.emplace_back(buffer, len);
+        len = rtosc_message(buffer, sizeof(buffer), path, "i", 1);
+        res.emplace_back(buffer, len);
+        len = rtosc_message(buffer, sizeof(buffer), path, "");
+        res.emplace_back(buffer, len);
+    }
+    return res;
+}
+
+//! Compare the registry against rtosc_match() for all messages
+static int mismatches(SubscriptionRegistry &registry, size_t num_subscriptions)
+{
+    int res = 0;
+    std::vector<int> clients;
+    for(const std::string &msg : messages())
+    {
+        registry.match(msg.data(), clients);
+        std::sort(clients.begin(), clients.end());
+        if(clients != expected(msg.data(), num_subscriptions)) {
+            printf("# mismatch for %s\n", msg.data());
+            ++res;
+        }
+    }
+    return res;
+}
+
+void test_same_as_rtosc_match()
+{
+    SubscriptionRegistry registry;
+    const size_t num = sizeof(subscriptions)/sizeof(subscriptions[0]);
+    int total_mismatches = 0;
+    // with all subsets 0..i, so different tries are used
+    for(size_t i = 0; i < num; ++i)
+    {
+        registry.subscribe(subscriptions[i].client, subscriptions[i].pattern);
+        total_mismatches += mismatches(registry, i + 1);
+    }
+    assert_int_eq(0, total_mismatches, "same results as rtosc_match()",
+                  __LINE__);
+    assert_int_eq(num, registry.size(), "all subscriptions kept", __LINE__);
+}
+
+void test_changes()
+{
+    SubscriptionRegistry registry;
+    std::vector<int> clients;
+    char msg[64];
+    rtosc_message(msg, sizeof(msg), "/part0/volume", "f", 0.5f);
+
+    assert_int_eq(0, registry.match(msg, clients), "no subscribers",
+                  __LINE__);
+    assert_false(registry.subscribe(1, "part0/"), "invalid pattern",
+                 __LINE__);
+    registry.subscribe(1, "/part0/");
+    registry.subscribe(1, "/part0/volume");
+    registry.subscribe(1, "/part0/volume"); // again
+    registry.subscribe(2, "/part0/volume");
+    assert_int_eq(3, registry.size(), "duplicates ignored", __LINE__);
+    assert_int_eq(2, registry.match(msg, clients),
+                  "each client only once", __LINE__);
+
+    assert_true(registry.unsubscribe(2, "/part0/volume"), "unsubscribe",
+                __LINE__);
+    assert_false(registry.unsubscribe(2, "/part0/volume"),
+                 "unsubscribe twice", __LINE__);
+    assert_true(registry.match(msg, clients) == 1 && clients[0] == 1,
+                "unsubscribed client removed", __LINE__);
+
+    registry.unsubscribe_all(1);
+    assert_int_eq(0, registry.size(), "all subscriptions removed", __LINE__);
+    assert_int_eq(0, registry.match(msg, clients), "no subscribers left",
+                  __LINE__);
+}
+
+int main()
+{
+    test_same_as_rtosc_match();
+    test_changes();
+    return test_summary();
+}
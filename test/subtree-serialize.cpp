@@ -0,0 +1,237 @@
+#include <cstring>
+#include <chrono>
+
+#include <rtosc/rtosc.h>
+#include <rtosc/ports.h>
+#include <rtosc/port-sugar.h>
+#include <rtosc/subtree-serialize.h>
+#include "common.h"
+
+using namespace rtosc;
+
+struct Voice
+{
+    float volume;
+    int   detune;
+    char  name[256];
+    static Ports ports;
+};
+
+struct Synth
+{
+    Voice voice[4];
+    char  last_cmd[16];
+    static Ports ports;
+};
+
+#define rObject Voice
+Ports Voice::ports = {
+    rParamF(volume, "volume"),
+    rParamI(detune, "detune"),
+    rString(name, 256, "name"),
+};
+#undef rObject
+
+#define rObject Synth
+Ports Synth::ports = {
+    rRecurs(voice, 4, "voices"),
+    rString(last_cmd, 16, rProp(internal), "not part of a snapshot"),
+};
+#undef rObject
+
+static void fill(Synth &s, int seed)
+{
+    memset(&s, 0, sizeof(s));
+    for(int i = 0; i < 4; ++i) {
+        s.voice[i].volume = seed * 0.25f + i;
+        s.voice[i].detune = seed - i;
+        snprintf(s.voice[i].name, 32, "voice %d/%d", i, seed);
+    }
+    strcpy(s.last_cmd, "cmd");
+}
+
+static bool same(const Synth &a, const Synth &b)
+{
+    for(int i = 0; i < 4; ++i)
+        if(a.voice[i].volume != b.voice[i].volume ||
+           a.voice[i].detune != b.voice[i].detune ||
+           strcmp(a.voice[i].name, b.voice[i].name))
+            return false;
+    return true;
+}
+
+static void restore(char *buf, size_t len, Synth &s)
+{
+    char loc[128];
+    RtData d;
+    d.loc = loc;
+    d.loc_size = sizeof(loc);
+    memset(loc, 0, sizeof(loc));
+    subtree_deserialize(buf, len, &s, &Synth::ports, d);
+}
+
+char ref[8192], out[8192];
+
+void test_same_as_subtree_serialize()
+{
+    Synth s;
+    fill(s, 1);
+    SubtreeSerializer ser(Synth::ports);
+    assert_int_eq(12, ser.size(), "all leaf ports except internal ones",
+                  __LINE__);
+    assert_int_eq(SubtreeSerializer::idle, ser.status(),
+                  "no snapshot before begin()", __LINE__);
+
+    size_t ref_len = subtree_serialize(ref, sizeof(ref), &s, &Synth::ports);
+    ser.begin(out, sizeof(out), &s);
+    assert_int_eq(SubtreeSerializer::done, ser.resume(),
+                  "snapshot in one step", __LINE__);
+    assert_hex_eq(ref, out, ref_len, ser.length(),
+                  "same bundle as subtree_serialize()", __LINE__);
+
+    Synth t;
+    fill(t, 2);
+    restore(out, ser.length(), t);
+    assert_true(same(s, t), "snapshot can be restored", __LINE__);
+}
+
+void test_resume()
+{
+    Synth s;
+    fill(s, 3);
+    SubtreeSerializer ser(Synth::ports);
+    ser.begin(out, sizeof(out), &s);
+    int steps = 0;
+    while(ser.resume(5) == SubtreeSerializer::pending) {
+        ++steps;
+        assert_int_eq(5*steps, ser.position(), "5 ports per step", __LINE__);
+        assert_int_eq(5*steps, rtosc_bundle_elements(out, ser.length()),
+                      "partial snapshot is a valid bundle", __LINE__);
+    }
+    assert_int_eq(2, steps, "resumed over 3 steps", __LINE__);
+    assert_int_eq(SubtreeSerializer::done, ser.resume(5),
+                  "resume() after done", __LINE__);
+
+    size_t ref_len = subtree_serialize(ref, sizeof(ref), &s, &Synth::ports);
+    assert_hex_eq(ref, out, ref_len, ser.length(),
+                  "resumed snapshot is complete", __LINE__);
+
+    //zero budget captures one port per call
+    ser.begin(out, sizeof(out), &s);
+    ser.resume_for(std::chrono::nanoseconds(0));
+    assert_int_eq(1, ser.position(), "at least one port per call", __LINE__);
+    while(ser.resume_for(std::chrono::microseconds(100)) ==
+          SubtreeSerializer::pending)
+        ;
+    assert_hex_eq(ref, out, ref_len, ser.length(),
+                  "time budgeted snapshot is complete", __LINE__);
+}
+
+void test_truncation()
+{
+    Synth s;
+    fill(s, 4);
+    //values beyond 128 bytes are not dropped
+    memset(s.voice[2].name, 'x', 200);
+    SubtreeSerializer ser(Synth::ports);
+    ser.begin(out, sizeof(out), &s);
+    assert_int_eq(SubtreeSerializer::done, ser.resume(),
+                  "large values are captured", __LINE__);
+    assert_null(ser.truncated_path(), "nothing truncated", __LINE__);
+    Synth t;
+    fill(t, 5);
+    restore(out, ser.length(), t);
+    assert_true(same(s, t), "large values are restored", __LINE__);
+
+    //a buffer which fits two voices
+    size_t partial = 0;
+    for(int i = 0; i < 6; ++i)
+        partial += 4 + rtosc_message_length(rtosc_bundle_fetch(out, i), -1);
+    ser.begin(out, 16 + partial, &s);
+    assert_int_eq(SubtreeSerializer::truncated, ser.resume(),
+                  "snapshot does not fit", __LINE__);
+    assert_str_eq("/voice2/volume", ser.truncated_path(),
+                  "first value which does not fit", __LINE__);
+    assert_int_eq(6, rtosc_bundle_elements(out, ser.length()),
+                  "values before are kept", __LINE__);
+    assert_int_eq(SubtreeSerializer::truncated, ser.resume(),
+                  "truncation is sticky", __LINE__);
+
+    ser.begin(out, 8, &s);
+    assert_int_eq(SubtreeSerializer::truncated, ser.status(),
+                  "no space for the bundle header", __LINE__);
+}
+
+void test_restore()
+{
+    Synth s, t;
+    fill(s, 6);
+    fill(t, 7);
+    SubtreeSerializer ser(Synth::ports);
+    ser.begin(out, sizeof(out), &s);
+    ser.resume();
+
+    char loc[128];
+    RtData d;
+    d.loc = loc;
+    d.loc_size = sizeof(loc);
+    memset(loc, 0, sizeof(loc));
+    ser.restore(out, ser.length(), &t, d);
+    assert_true(same(s, t), "snapshot is restored", __LINE__);
+    assert_str_eq("/voice3/name", loc, "location of the last port", __LINE__);
+    assert_ptr_eq(&t, d.obj, "object is reset", __LINE__);
+
+    //routes follow the object
+    Synth u;
+    fill(u, 8);
+    ser.restore(out, ser.length(), &u, d);
+    assert_true(same(s, u), "snapshot is restored to another object",
+                __LINE__);
+
+    //messages out of order or not from the serializer
+    size_t len = rtosc_bundle(ref, sizeof(ref), 0, 3,
+            rtosc_bundle_fetch(out, 4),  //voice1/detune
+            rtosc_bundle_fetch(out, 1),  //voice0/detune
+            rtosc_bundle_fetch(out, 11)); //voice3/name
+    fill(u, 9);
+    ser.restore(ref, len, &u, d);
+    assert_int_eq(s.voice[1].detune, u.voice[1].detune,
+                  "restored in order", __LINE__);
+    assert_int_eq(s.voice[0].detune, u.voice[0].detune,
+                  "restored out of order", __LINE__);
+    assert_str_eq(s.voice[3].name, u.voice[3].name,
+                  "restored after out of order", __LINE__);
+    assert_flt_eq(9*0.25f, u.voice[0].volume, "others are unchanged",
+                  __LINE__);
+}
+
+void test_compile()
+{
+    Synth s, t;
+    fill(s, 10);
+    fill(t, 11);
+    SubtreeSerializer ser(Synth::ports);
+    ser.compile(&s);
+    size_t ref_len = subtree_serialize(ref, sizeof(ref), &s, &Synth::ports);
+    ser.begin(out, sizeof(out), &s);
+    ser.resume();
+    assert_hex_eq(ref, out, ref_len, ser.length(),
+                  "snapshot through compiled routes", __LINE__);
+
+    //routes of another object are resolved again
+    ref_len = subtree_serialize(ref, sizeof(ref), &t, &Synth::ports);
+    ser.begin(out, sizeof(out), &t);
+    ser.resume();
+    assert_hex_eq(ref, out, ref_len, ser.length(),
+                  "snapshot of another object", __LINE__);
+}
+
+int main()
+{
+    test_same_as_subtree_serialize();
+    test_resume();
+    test_truncation();
+    test_restore();
+    test_compile();
+    return test_summary();
+}
@@ -1,3 +1,4 @@
+#include <cmath>
 #include <rtosc/ports.h>
 #include <rtosc/automations.h>
 #include <rtosc/port-sugar.h>
@@ -266,10 +267,344 @@ void test_curve_lerp(void)
     assert_flt_eq(-1, d.foo, "Minimum is correct", __LINE__);
 }
 
+void test_batched(void)
+{
+    suite("test_batched");
+    rtosc::AutomationMgr mgr(4, 2, 16);
+    Dummy d = {0,0};
+    int calls = 0;
+    mgr.set_ports(p);
+    mgr.set_instance(&d);
+    mgr.backend = [&d, &calls](const char *msg) {
+        rtosc::RtData rd;
+        char loc[128];
+        rd.loc = loc;
+        rd.loc_size = sizeof(loc);
+        rd.obj = &d;
+        ++calls;
+        if(!rtosc_bundle_p(msg))
+            p.dispatch(msg, rd, true);
+        else for(unsigned i=0; i<rtosc_bundle_elements(msg, -1); ++i)
+            p.dispatch(rtosc_bundle_fetch(msg, i), rd, true);};
+
+    mgr.createBinding(0, "/foo", false);
+    mgr.createBinding(1, "/bar", false);
+    mgr.createBinding(1, "/foo", false);
+
+    mgr.setSlotDeferred(0, 1);
+    mgr.setSlotDeferred(1, 0.5);
+    assert_flt_eq(0, d.foo, "Deferred slots are not evaluated", __LINE__);
+    mgr.processBlock();
+    assert_int_eq(1, calls, "One bundle is sent per block", __LINE__);
+    assert_flt_eq(4.5, d.foo, "Slots are evaluated in order", __LINE__);
+    assert_flt_eq(50.1, d.bar, "All automations of a slot are evaluated",
+                  __LINE__);
+    mgr.processBlock();
+    assert_int_eq(1, calls, "Nothing is sent without changes", __LINE__);
+
+    //the batched evaluation must match setSlot()
+    mgr.simpleSlope(1, 1, 30.0, 2.0);
+    int mismatches = 0;
+    for(int i=-2; i<=12; ++i) {
+        mgr.setSlot(1, i/10.0f);
+        Dummy exp = d;
+        d = {0,0};
+        mgr.setSlotDeferred(1, i/10.0f);
+        mgr.processBlock();
+        mismatches += exp.foo != d.foo || exp.bar != d.bar;
+    }
+    assert_int_eq(0, mismatches, "Batched evaluation matches setSlot()",
+                  __LINE__);
+    assert_flt_eq(1.2f, mgr.getSlot(1), "Deferred slot values are stored",
+                  __LINE__);
+
+    mgr.clearSlot(0);
+    d = {0,0};
+    calls = 0;
+    mgr.setSlotDeferred(0, 1);
+    mgr.processBlock();
+    assert_int_eq(0, calls, "Cleared slots are not evaluated", __LINE__);
+}
+
 void test_curve_piecewise(void)
 {
+    suite("test_curve_piecewise");
+    rtosc::AutomationMgr mgr(4, 2, 16);
+    Dummy d = {0,0};
+    mgr.set_ports(p);
+    mgr.set_instance(&d);
+    mgr.backend = [&d](const char *msg) {
+        rtosc::RtData rd;
+        char loc[128];
+        rd.loc = loc;
+        rd.loc_size = sizeof(loc);
+        rd.obj = &d; p.dispatch(msg, rd, true);};
+
+    mgr.createBinding(0, "/foo", false);
+
+    printf("\n#Setting up monotonic curve\n");
+    const float rising[] = {0, -1, 0.25, 0, 0.5, 8, 1, 9};
+    mgr.setCurve(0, 0, 1, rising, 4);
+    assert_int_eq(4, mgr.slots[0].automations[0].map.upoints,
+                  "All points are used", __LINE__);
+    mgr.setSlot(0, 0);
+    assert_flt_eq(-1, d.foo, "Curve starts at first point", __LINE__);
+    mgr.setSlot(0, 0.25);
+    assert_flt_eq(0, d.foo, "Curve goes through points", __LINE__);
+    mgr.setSlot(0, 0.375);
+    assert_flt_eq(4, d.foo, "Segments are linear", __LINE__);
+    mgr.setSlot(0, 1);
+    assert_flt_eq(9, d.foo, "Curve ends at last point", __LINE__);
+
+    mgr.setCurve(0, 0, 2, rising, 4);
+    bool monotonic = true, bounded = true;
+    float last = -1;
+    for(int i=0; i<=1000; ++i) {
+        mgr.setSlot(0, i/1000.0);
+        monotonic &= d.foo >= last;
+        bounded   &= d.foo >= -1 && d.foo <= 9;
+        last = d.foo;
+    }
+    assert_true(monotonic, "Smoothed monotonic curve is monotonic", __LINE__);
+    assert_true(bounded, "Smoothed curve does not overshoot", __LINE__);
+    mgr.setSlot(0, 0.5);
+    assert_flt_eq(8, d.foo, "Smoothed curve goes through points", __LINE__);
+
+    printf("\n#Setting up non-monotonic curve\n");
+    const float peak[] = {0, -1, 0.5, 12, 0.75, 3, 1, 5};
+    mgr.setCurve(0, 0, 1, peak, 4);
+    mgr.setSlot(0, 0.25);
+    assert_true(fabsf(d.foo - 5.5) < 1e-5, "Curve rises", __LINE__);
+    mgr.setSlot(0, 0.5);
+    assert_flt_eq(10, d.foo, "Curve is clamped to maximum", __LINE__);
+    mgr.setSlot(0, 0.75);
+    assert_flt_eq(3, d.foo, "Curve falls", __LINE__);
+    mgr.setSlot(0, 0.875);
+    assert_flt_eq(4, d.foo, "Curve rises again", __LINE__);
+
+    mgr.setCurve(0, 0, 2, peak, 4);
+    float lowest = 10;
+    for(int i=500; i<=1000; ++i) {
+        mgr.setSlot(0, i/1000.0);
+        lowest = d.foo < lowest ? d.foo : lowest;
+    }
+    assert_flt_eq(3, lowest, "Smoothed curve keeps local minimum", __LINE__);
+
+    //the batched evaluation uses the same tables
+    int mismatches = 0;
+    for(int i=0; i<=100; ++i) {
+        mgr.setSlot(0, i/100.0);
+        float exp = d.foo;
+        mgr.setSlotDeferred(0, i/100.0);
+        mgr.processBlock();
+        mismatches += exp != d.foo;
+    }
+    assert_int_eq(0, mismatches, "Batched evaluation matches setSlot()",
+                  __LINE__);
+
+    printf("\n#Changing gain does not reset curves\n");
+    mgr.setSlotSubGain(0, 0, 50);
+    mgr.updateMapping(0, 0);
+    mgr.setSlot(0, 0.75);
+    assert_flt_eq(3, d.foo, "Curve is kept", __LINE__);
+    mgr.simpleSlope(0, 0, 2.0, +3);
+    mgr.setSlot(0, 1.0);
+    assert_flt_eq(4.0, d.foo, "Slope replaces curve", __LINE__);
+}
+
+void test_direct_ports(void)
+{
+    suite("test_direct_ports");
     rtosc::AutomationMgr mgr(4, 2, 16);
+    Dummy d = {0,0}, d2 = {0,0};
+    int calls = 0;
+    char loc[128];
+    rtosc::RtData rd;
+    rd.loc = loc;
+    rd.loc_size = sizeof(loc);
     mgr.set_ports(p);
+    mgr.set_instance(&d);
+    mgr.set_rtdata(&rd);
+    mgr.backend = [&calls](const char *) {++calls;};
+
+    mgr.createBinding(0, "/foo", false);
+    mgr.createBinding(0, "/bar", false);
+    mgr.setSlot(0, 0.5);
+    assert_int_eq(2, calls, "Backend is used until routes are resolved",
+                  __LINE__);
+    calls = 0;
+    mgr.resolveRoutes();
+    mgr.setSlot(0, 1.0);
+    assert_flt_eq(10, d.foo, "Port is called directly", __LINE__);
+    assert_flt_eq(100.2, d.bar, "All ports are called directly", __LINE__);
+    assert_str_eq("/bar", loc, "Port location is passed", __LINE__);
+    mgr.setSlotDeferred(0, 0.0);
+    mgr.processBlock();
+    assert_flt_eq(-1, d.foo, "Batched evaluation calls ports", __LINE__);
+    assert_flt_eq(0, d.bar, "Batched evaluation calls all ports", __LINE__);
+    assert_int_eq(0, calls, "Backend is not used", __LINE__);
+
+    mgr.set_instance(&d2);
+    mgr.setSlot(0, 1.0);
+    assert_flt_eq(10, d2.foo, "New instance is used", __LINE__);
+    assert_flt_eq(-1, d.foo, "Old instance is not used", __LINE__);
+
+    //resolve on one side, install on the realtime side
+    rtosc::AutomationRoute route;
+    assert_true(mgr.resolveRoute("/foo", route), "Route is found", __LINE__);
+    mgr.setSlotSubPath(0, 1, "/foo");
+    mgr.setSlot(0, 0.5);
+    assert_int_eq(1, calls, "Changed path is not called directly",
+                  __LINE__);
+    mgr.setSlotSubRoute(0, 1, route);
+    mgr.setSlot(0, 1.0);
+    assert_int_eq(1, calls, "Installed route is used", __LINE__);
+    mgr.setSlotSubRoute(0, 0, route);
+    assert_str_eq("/foo", mgr.slots[0].automations[0].param_path,
+                  "Route for another path is ignored", __LINE__);
+    mgr.setSlot(0, 1.0);
+    assert_int_eq(1, calls, "Route for another path is ignored", __LINE__);
+
+    mgr.set_rtdata(NULL);
+    mgr.setSlot(0, 0.5);
+    assert_int_eq(3, calls, "Backend is used without RtData", __LINE__);
+}
+
+void test_smoothing(void)
+{
+    suite("test_smoothing");
+    rtosc::AutomationMgr mgr(4, 2, 16);
+    Dummy d = {0,0};
+    int msgs = 0;
+    mgr.set_ports(p);
+    mgr.set_instance(&d);
+    mgr.backend = [&d, &msgs](const char *msg) {
+        rtosc::RtData rd;
+        char loc[128];
+        rd.loc = loc;
+        rd.loc_size = sizeof(loc);
+        rd.obj = &d;
+        if(!rtosc_bundle_p(msg))
+            ++msgs, p.dispatch(msg, rd, true);
+        else for(unsigned i=0; i<rtosc_bundle_elements(msg, -1); ++i)
+            ++msgs, p.dispatch(rtosc_bundle_fetch(msg, i), rd, true);};
+
+    mgr.createBinding(0, "/foo", false);
+    mgr.createBinding(0, "/bar", false);
+
+    printf("\n#Setting up slew limit\n");
+    //full range of foo (-1..10) in 10 blocks
+    mgr.setSlotSubSmoothing(0, 0, 2, 10);
+    mgr.setSlot(0, 0);
+    assert_int_eq(1, msgs, "Only unsmoothed values are sent", __LINE__);
+    assert_flt_eq(0, d.bar, "Unsmoothed values are sent", __LINE__);
+    mgr.processBlock();
+    assert_flt_eq(-1, d.foo, "First value is not smoothed", __LINE__);
+    assert_int_eq(2, msgs, "Unsmoothed values are not sent again",
+                  __LINE__);
+
+    msgs = 0;
+    mgr.setSlot(0, 1);
+    mgr.processBlock();
+    assert_true(fabsf(d.foo - 0.1) < 1e-5, "Value is slew limited", __LINE__);
+    for(int i=0; i<20; ++i)
+        mgr.processBlock();
+    assert_flt_eq(10, d.foo, "Value is reached", __LINE__);
+    assert_int_eq(11, msgs, "One message per block until value is reached",
+                  __LINE__);
+
+    printf("\n#Setting up time constant\n");
+    mgr.setSlotSubSmoothing(0, 0, 1, 4);
+    msgs = 0;
+    mgr.setSlotDeferred(0, 0);
+    bool falling = true;
+    float last = 10;
+    for(int i=0; i<200; ++i) {
+        mgr.processBlock();
+        falling &= d.foo <= last;
+        last = d.foo;
+    }
+    assert_true(falling, "Value approaches target", __LINE__);
+    assert_flt_eq(-1, d.foo, "Value is reached", __LINE__);
+    assert_flt_eq(0, d.bar, "Unsmoothed values are still sent", __LINE__);
+    assert_true(msgs > 10 && msgs < 100, "Small changes are not sent",
+                __LINE__);
+
+    msgs = 0;
+    mgr.setSlotSubSmoothing(0, 0, 0, 0);
+    mgr.setSlot(0, 1);
+    assert_flt_eq(10, d.foo, "Smoothing can be disabled", __LINE__);
+    mgr.processBlock();
+    assert_int_eq(2, msgs, "Nothing is left to smooth", __LINE__);
+}
+
+void test_high_resolution(void)
+{
+    suite("test_high_resolution");
+    rtosc::AutomationMgr mgr(4, 2, 16);
+    Dummy d = {0,0};
+    int msgs = 0;
+    mgr.set_ports(p);
+    mgr.set_instance(&d);
+    mgr.backend = [&d, &msgs](const char *msg) {
+        rtosc::RtData rd;
+        char loc[128];
+        rd.loc = loc;
+        rd.loc_size = sizeof(loc);
+        rd.obj = &d;
+        if(!rtosc_bundle_p(msg))
+            ++msgs, p.dispatch(msg, rd, true);
+        else for(unsigned i=0; i<rtosc_bundle_elements(msg, -1); ++i)
+            ++msgs, p.dispatch(rtosc_bundle_fetch(msg, i), rd, true);};
+
+    mgr.createBinding(0, "/foo", false);
+    mgr.createBinding(1, "/bar", false);
+    mgr.slots[0].midi_cc   = 2*128 + 7;
+    mgr.slots[1].midi_nrpn = (1<<7) + 2;
+
+    assert_true(mgr.handleMidi14(2, 7, 16383), "14 bit CC is bound",
+                __LINE__);
+    assert_flt_eq(10, d.foo, "14 bit maximum", __LINE__);
+    mgr.handleMidi32(2, 7, 0x80000000u);
+    assert_true(fabsf(d.foo - 4.5) < 1e-5, "32 bit center", __LINE__);
+    assert_true(mgr.handleMidi14(0, (1<<7) + 2, 0, true), "NRPN is bound",
+                __LINE__);
+    assert_flt_eq(0, d.bar, "14 bit NRPN minimum", __LINE__);
+    assert_false(mgr.handleMidi14(2, 8, 0), "Other CCs are not bound",
+                 __LINE__);
+
+    printf("\n#Sending coarse and fine NRPN values\n");
+    mgr.handleMidi(0, C_nrpnhi, 1);
+    mgr.handleMidi(0, C_nrpnlo, 2);
+    mgr.handleMidi(0, C_dataentryhi, 0);
+    mgr.handleMidi(0, C_dataentrylo, 0);
+    msgs = 0;
+    mgr.handleMidi(0, C_dataentryhi, 127);
+    mgr.handleMidi(0, C_dataentrylo, 127);
+    assert_int_eq(2, msgs, "Each part causes an update", __LINE__);
+    assert_flt_eq(100.2, d.bar, "NRPN value is set", __LINE__);
+
+    mgr.coalesce = true;
+    msgs = 0;
+    mgr.handleMidi(0, C_dataentryhi, 0);
+    mgr.handleMidi(0, C_dataentrylo, 0);
+    assert_int_eq(0, msgs, "Coalesced values wait for the block", __LINE__);
+    mgr.processBlock();
+    assert_int_eq(1, msgs, "Coalesced parts cause one update", __LINE__);
+    assert_flt_eq(0, d.bar, "Coalesced NRPN value is set", __LINE__);
+
+    printf("\n#Learning an NRPN at its midpoint\n");
+    mgr.coalesce = false;
+    mgr.handleMidi(0, C_nrpnhi, 3);
+    mgr.handleMidi(0, C_nrpnlo, 4);
+    mgr.handleMidi(0, C_dataentryhi, 64);
+    mgr.createBinding(2, "/bar", true);
+    assert_false(mgr.handleMidi(0, C_dataentrylo, 0), "NRPN is not bound yet",
+                 __LINE__);
+    assert_int_eq((3<<7) + 4, mgr.slots[2].midi_nrpn, "NRPN is learned",
+                  __LINE__);
+    assert_true(fabsf(d.bar - 100.2f*8192/16383) < 1e-3,
+                "Learned NRPN starts from the 14 bit value", __LINE__);
 }
 
 void test_learn_many(void)
@@ -293,5 +628,10 @@ int main()
     test_midi_learn();
     test_macro_learn();
     test_learn_many();
+    test_batched();
+    test_curve_piecewise();
+    test_direct_ports();
+    test_smoothing();
+    test_high_resolution();
     return test_summary();
 }
@@ -1,3 +1,4 @@
+#include <ctime>
 #include <rtosc/miditable.h>
 #include <rtosc/port-sugar.h>
 #include "common.h"
@@ -98,9 +99,101 @@ void test_relearn(void)
     return;
 }
 
+//Storage with n coarse and n fine mappings, the latter in reverse order
+static void fill_storage(rtosc::MidiMapperStorage &s, int n, int first_id)
+{
+    using Storage = rtosc::MidiMapperStorage;
+    s.mapping   = Storage::TinyVector<std::tuple<int, bool, int>>(2*n);
+    s.values    = Storage::TinyVector<int>(n);
+    s.callbacks = Storage::TinyVector<Storage::callback_t>(n);
+    for(int i=0; i<n; ++i) {
+        s.mapping[i]       = std::make_tuple(first_id + i, true, i);
+        s.mapping[2*n-1-i] = std::make_tuple(100000 + first_id + i, false, i);
+        s.values[i] = 0;
+    }
+    s.buildLookup();
+}
+
+void test_clone_values(void)
+{
+    printf("#Test Clone Values\n");
+    const int n = 4000;
+    rtosc::MidiMapperStorage old_storage, new_storage;
+    fill_storage(old_storage, n, 0);
+    for(int i=0; i<n; ++i)
+        old_storage.values[i] = (i%128)<<7 | (i*3)%128;
+
+    //the new storage has moved values and one new mapping at the start
+    fill_storage(new_storage, n, -1);
+
+    clock_t t_on = clock();
+    const int rounds = 100;
+    for(int r=0; r<rounds; ++r)
+        new_storage.cloneValues(old_storage);
+    clock_t t_off = clock();
+    double seconds = (t_off - t_on) * 1.0 / CLOCKS_PER_SEC;
+    printf("# cloneValues: %8.2f us per clone of %d mappings\n",
+           seconds*1e6/rounds, 2*n);
+
+    int mismatches = new_storage.values[0] != 0;
+    for(int i=1; i<n; ++i)
+        mismatches += new_storage.values[i] != old_storage.values[i-1];
+    assert_int_eq(0, mismatches, "Values are taken over by ID", __LINE__);
+}
+
+void test_high_resolution(void)
+{
+    printf("#Test High Resolution\n");
+    using Storage = rtosc::MidiMapperStorage;
+    Storage s;
+    //CC 1 (coarse) and CC 33 (fine) of channel 1 form one value
+    s.mapping   = Storage::TinyVector<std::tuple<int, bool, int>>(2);
+    s.values    = Storage::TinyVector<int>(1);
+    s.callbacks = Storage::TinyVector<Storage::callback_t>(1);
+    s.mapping[0] = std::make_tuple(1, true, 0);
+    s.mapping[1] = std::make_tuple(33, false, 0);
+    s.values[0] = 0;
+    int calls = 0, last = -1;
+    s.callbacks[0] = [&calls, &last](int16_t x, Storage::write_cb) {
+        ++calls;
+        last = x;
+    };
+    s.buildLookup();
+
+    rtosc::MidiMapperRT rt;
+    rt.setFrontendCb(rt_to_non_rt);
+    rt.setBackendCb(rt_to_rt);
+    rt.storage = &s;
+
+    rt.handleCC14(1, 0x1234);
+    assert_int_eq(1, calls, "14 bit value causes one update", __LINE__);
+    assert_int_eq(0x1234, last, "14 bit value is set", __LINE__);
+    rt.handleValue(1, 0x80000000u);
+    assert_int_eq(0x2000, last, "32 bit value is set", __LINE__);
+
+    calls = 0;
+    rt.handleCC(1, 5);
+    rt.handleCC(33, 7);
+    assert_int_eq(2, calls, "Coarse and fine part cause updates", __LINE__);
+
+    rt.coalesce = true;
+    calls = 0;
+    rt.handleCC(1, 6);
+    rt.handleCC(33, 8);
+    rt.handleCC(33, 9);
+    assert_int_eq(0, calls, "Coalesced values wait for the block", __LINE__);
+    rt.processBlock();
+    assert_int_eq(1, calls, "Coalesced parts cause one update", __LINE__);
+    assert_int_eq(6<<7 | 9, last, "Coalesced value is set", __LINE__);
+    rt.processBlock();
+    assert_int_eq(1, calls, "Nothing is left for the next block", __LINE__);
+}
+
 int main()
 {
     test_basic();
     test_relearn();
+    test_clone_values();
+    test_high_resolution();
     return test_summary();
 }
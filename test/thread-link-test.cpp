@@ -133,10 +133,37 @@ void test_read_lookahead()
     assert_false(thread_link.hasNext(), "4: Has no next", __LINE__);
 }
 
+void test_bundles()
+{
+    rtosc::ThreadLink thread_link(128,4);
+    char msg_a[32], msg_b[32], bundle[128];
+    rtosc_message(msg_a, sizeof(msg_a), "/a", "i", 1);
+    rtosc_message(msg_b, sizeof(msg_b), "/b", "i", 2);
+    rtosc_bundle(bundle, sizeof(bundle), 1, 2, msg_a, msg_b);
+
+    // messages right after bundles must not be taken as bundle elements
+    for (int round = 0; round < 4; ++round)
+    {
+        thread_link.raw_write(bundle);
+        thread_link.write("/c", "i", 3);
+
+        rtosc::msg_t read_msg = thread_link.read();
+        assert_true(rtosc_bundle_p(read_msg), "bundle read", __LINE__);
+        assert_int_eq(2, rtosc_bundle_elements(read_msg, 128),
+                      "bundle elements", __LINE__);
+        verify_msg(rtosc_bundle_fetch(read_msg, 1), "/b", 2,
+                   "bundle element", __LINE__);
+        verify_msg(thread_link.read(), "/c", 3, "message after bundle",
+                   __LINE__);
+        assert_false(thread_link.hasNext(), "all read", __LINE__);
+    }
+}
+
 int main()
 {
     test_contiguous_write();
     test_read_lookahead();
+    test_bundles();
 
     return test_summary();
 }
@@ -0,0 +1,274 @@
+#include <cstdio>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include <unistd.h>
+
+#include <rtosc/rtosc.h>
+#include <rtosc/thread-link.h>
+#include <rtosc/transport.h>
+#include "common.h"
+
+using namespace rtosc;
+
+static std::vector<std::string> received;
+
+static void collect(const char *packet, size_t length)
+{
+    received.emplace_back(packet, length);
+}
+
+static std::string message(const char *path, int i)
+{
+    char buffer[256];
+    size_t len = rtosc_message(buffer, sizeof(buffer), path, "i", i);
+    return std::string(buffer, len);
+}
+
+//! message containing the SLIP END and ESC characters
+static std::string special_message()
+{
+    char buffer[256];
+    const char blob[] = "\300\333\300x\333";
+    size_t len = rtosc_message(buffer, sizeof(buffer), "/blob", "bi",
+                               sizeof(blob), blob, 0xc0dbc0db);
+    return std::string(buffer, len);
+}
+
+static std::string frame(const std::string &packet, framing f)
+{
+    std::string res(framed_size(packet.size(), f), 0);
+    res.resize(frame_packet(&res[0], res.size(), packet.data(),
+                            packet.size(), f));
+    return res;
+}
+
+void test_valid_packet()
+{
+    std::string msg = message("/foo", 42);
+    assert_true(valid_packet(msg.data(), msg.size()), "message is valid",
+                __LINE__);
+    assert_false(valid_packet(msg.data(), msg.size() - 4),
+                 "truncated message is invalid", __LINE__);
+    assert_false(valid_packet("abcdefgh", 8), "garbage is invalid", __LINE__);
+
+    char bundle[256];
+    size_t len = rtosc_bundle(bundle, sizeof(bundle), 0, 2, msg.data(),
+                              msg.data());
+    assert_true(valid_packet(bundle, len), "bundle is valid", __LINE__);
+    bundle[19] = 100; // first element longer than the bundle
+    assert_false(valid_packet(bundle, len), "bad bundle is invalid",
+                 __LINE__);
+}
+
+void test_framing(framing f, const char *name)
+{
+    std::string stream;
+    std::vector<std::string> packets;
+    for(int i = 0; i < 10; ++i)
+        packets.push_back(message("/some/path", i));
+    packets.push_back(special_message());
+    for(const std::string &p : packets)
+        stream += frame(p, f);
+
+    std::string test = std::string(name) + ": ";
+
+    // all at once
+    received.clear();
+    stream_decoder dec(f, 256);
+    assert_int_eq(11, dec.feed(stream.data(), stream.size(), collect),
+                  (test + "all packets decoded").c_str(), __LINE__);
+    assert_true(received == packets, (test + "packets match").c_str(),
+                __LINE__);
+
+    // byte by byte
+    received.clear();
+    size_t count = 0;
+    for(char c : stream)
+        count += dec.feed(&c, 1, collect);
+    assert_int_eq(11, count, (test + "all packets decoded bytewise").c_str(),
+                  __LINE__);
+    assert_true(received == packets,
+                (test + "bytewise packets match").c_str(), __LINE__);
+
+    // invalid and oversized packets are dropped, the stream goes on
+    received.clear();
+    std::string bad = frame("garbage!", f) + frame(std::string(512, 'x'), f)
+                    + frame(packets[3], f);
+    dec.feed(bad.data(), bad.size(), collect);
+    assert_int_eq(1, received.size(),
+                  (test + "only the valid packet is decoded").c_str(),
+                  __LINE__);
+    assert_true(received.size() == 1 && received[0] == packets[3],
+                (test + "valid packet after bad ones").c_str(), __LINE__);
+    assert_int_eq(2, dec.dropped(), (test + "two packets dropped").c_str(),
+                  __LINE__);
+}
+
+void test_stream(connection &a, connection &b, const char *name)
+{
+    std::string test = std::string(name) + ": ";
+    assert_true(a.valid() && b.valid(), (test + "connected").c_str(),
+                __LINE__);
+
+    std::vector<std::string> packets;
+    std::vector<const char*> data;
+    std::vector<size_t> lengths;
+    for(int i = 0; i < 100; ++i)
+        packets.push_back(message("/param", i));
+    packets.push_back(special_message());
+    for(const std::string &p : packets) {
+        data.push_back(p.data());
+        lengths.push_back(p.size());
+    }
+    assert_int_eq(101, a.send(data.data(), lengths.data(), data.size()),
+                  (test + "batch sent").c_str(), __LINE__);
+
+    received.clear();
+    while(received.size() < packets.size() && b.receive(collect, 1000)) ;
+    assert_true(received == packets, (test + "batch received").c_str(),
+                __LINE__);
+
+    // other direction, into a ThreadLink, with bundles unpacked
+    char bundle[256];
+    size_t len = rtosc_bundle(bundle, sizeof(bundle), 0, 2,
+                              packets[1].data(), packets[2].data());
+    b.send(packets[0].data());
+    b.send(bundle, len);
+    ThreadLink link(256, 16);
+    size_t messages = 0;
+    while(messages < 3 && (messages += a.receive(link, 1000))) ;
+    assert_int_eq(3, messages, (test + "messages into link").c_str(),
+                  __LINE__);
+    for(int i = 0; i < 3; ++i)
+        assert_true(link.hasNext() &&
+                    rtosc_argument(link.read(), 0).i == i,
+                    (test + "message read from link").c_str(), __LINE__);
+
+    // closing is noticed by the peer
+    a.close();
+    b.receive(collect, 1000);
+    assert_false(b.valid(), (test + "closed by peer").c_str(), __LINE__);
+}
+
+int main()
+{
+    test_valid_packet();
+    test_framing(framing::length_prefix, "length prefix");
+    test_framing(framing::slip, "SLIP");
+
+    listener tcp = listener::tcp();
+    connection client = connection::tcp("127.0.0.1", tcp.port());
+    connection server = tcp.accept(framing::slip, 1000);
+    test_stream(client, server, "TCP");
+
+    client = connection::tcp("127.0.0.1", tcp.port(),
+                             framing::length_prefix);
+    server = tcp.accept(framing::length_prefix, 1000);
+    test_stream(client, server, "TCP, length prefix");
+
+    std::string path = "/tmp/rtosc-transport-test-" +
+                       std::to_string(getpid());
+    {
+        listener local = listener::unix_socket(path.c_str());
+        client = connection::unix_socket(path.c_str());
+        server = local.accept(framing::slip, 1000);
+        test_stream(client, server, "UNIX");
+    }
+    assert_true(access(path.c_str(), F_OK), "UNIX socket removed", __LINE__);
+
+    // sending to a peer which does not read gives up after the timeout
+    {
+        listener local = listener::unix_socket(path.c_str());
+        connection writer = connection::unix_socket(path.c_str());
+        connection reader = local.accept(framing::slip, 1000);
+        writer.set_send_timeout(10);
+        std::vector<char> blob(4096, 'x'), msg(4200);
+        size_t len = rtosc_message(msg.data(), msg.size(), "/fill", "b",
+                                   blob.size(), blob.data());
+        std::vector<const char*> data(1000, msg.data());
+        std::vector<size_t> lengths(1000, len);
+        size_t sent = writer.send(data.data(), lengths.data(), data.size());
+        assert_true(sent < data.size(), "UNIX: send times out", __LINE__);
+    }
+
+    // a file which is not a socket is never removed
+    FILE *file = fopen(path.c_str(), "w");
+    assert_non_null(file, "create a regular file", __LINE__);
+    if(file)
+        fclose(file);
+    bool thrown = false;
+    try {
+        listener::unix_socket(path.c_str());
+    } catch(const std::runtime_error &) {
+        thrown = true;
+    }
+    assert_true(thrown && !access(path.c_str(), F_OK),
+                "UNIX: regular file is kept", __LINE__);
+    unlink(path.c_str());
+
+    connection udp_a = connection::udp(0);
+    connection udp_b = connection::udp(0, "127.0.0.1", udp_a.local_port());
+    udp_a.connect_udp("127.0.0.1", udp_b.local_port());
+    // UDP has no connection which could be closed, so test until there
+    std::vector<std::string> packets;
+    std::vector<const char*> data;
+    std::vector<size_t> lengths;
+    for(int i = 0; i < 40; ++i)
+        packets.push_back(message("/udp", i));
+    for(const std::string &p : packets) {
+        data.push_back(p.data());
+        lengths.push_back(p.size());
+    }
+    assert_int_eq(40, udp_a.send(data.data(), lengths.data(), data.size()),
+                  "UDP: batch sent", __LINE__);
+    received.clear();
+    while(received.size() < packets.size() && udp_b.receive(collect, 1000)) ;
+    assert_true(received == packets, "UDP: batch received", __LINE__);
+    udp_b.send("garbage!", 8);
+    udp_b.send(packets[5].data());
+    received.clear();
+    while(received.empty() && udp_a.receive(collect, 1000) == 0 &&
+          udp_a.dropped() == 0) ;
+    while(received.empty() && udp_a.receive(collect, 1000)) ;
+    assert_int_eq(1, udp_a.dropped(), "UDP: invalid packet dropped",
+                  __LINE__);
+    assert_true(received.size() == 1 && received[0] == packets[5],
+                "UDP: valid packet received", __LINE__);
+
+    // messages longer than the link's messages are dropped, also in bundles
+    std::vector<char> blob(1000 - 16, 'x'), big(1000), bundle(2048);
+    size_t big_len = rtosc_message(big.data(), big.size(), "/big", "b",
+                                   blob.size(), blob.data());
+    assert_int_eq(1000, big_len, "UDP: oversized message", __LINE__);
+    size_t bundle_len = rtosc_bundle(bundle.data(), bundle.size(), 0, 3,
+                                     packets[1].data(), big.data(),
+                                     packets[2].data());
+    udp_b.send(big.data(), big_len);
+    udp_b.send(bundle.data(), bundle_len);
+    udp_b.send(packets[3].data());
+    ThreadLink link(256, 16);
+    size_t messages = 0;
+    while(messages < 3 && (messages += udp_a.receive(link, 1000))) ;
+    assert_int_eq(3, messages, "UDP: only small messages into link",
+                  __LINE__);
+    assert_int_eq(3, udp_a.dropped(), "UDP: oversized messages dropped",
+                  __LINE__);
+    for(int i = 1; i <= 3; ++i)
+        assert_true(link.hasNext() &&
+                    rtosc_argument(link.read(), 0).i == i,
+                    "UDP: small message read from link", __LINE__);
+    assert_false(link.hasNext(), "UDP: nothing else in link", __LINE__);
+
+    // messages which do not fit the full link are not counted as written
+    ThreadLink tiny(256, 1);
+    while(tiny.raw_write(packets[0].data())) ;
+    size_t before = udp_a.dropped();
+    udp_b.send(packets[4].data());
+    while(udp_a.dropped() == before && udp_a.receive(tiny, 1000) == 0) ;
+    assert_int_eq(before + 1, udp_a.dropped(),
+                  "UDP: message into full link dropped", __LINE__);
+
+    return test_summary();
+}
@@ -38,6 +38,7 @@ struct Rt:public RtData
         loc_size = 128;
         obj      = o;
         uh       = uh_;
+        rec      = nullptr;
         enable   = true;
     }
     ~Rt(void)
@@ -54,17 +55,263 @@ struct Rt:public RtData
         va_start(va, args);
         rtosc_vmessage(reply_buf, sizeof(reply_buf),
                 path, args, va);
-        uh->recordEvent(reply_buf);
+        if(rec)
+            rec->record(reply_buf);
+        else
+            uh->recordEvent(reply_buf);
         va_end(va);
     }
 
     bool enable;
     UndoHistory *uh;
+    UndoRecorder *rec;
 };
 
 char ref[] = "b\0\0\0,c\0\0\0\0\0\7";
 
 char message_buff[256];
+
+static const char *undo_change(const char *path, float old_val, float new_val)
+{
+    static char buf[256];
+    rtosc_message(buf, sizeof(buf), "/undo_change", "sff",
+                  path, old_val, new_val);
+    return buf;
+}
+
+void merging()
+{
+    UndoHistory hist;
+    hist.recordEvent(undo_change("/x", 0, 1));
+    hist.recordEvent(undo_change("/x", 1, 2));
+    hist.recordEvent(undo_change("/x", 2, 3));
+    assert_int_eq(1, hist.size(), "Changes Of One Address Are Merged",
+                  __LINE__);
+    assert_flt_eq(0, rtosc_argument(hist.getHistory(0), 1).f,
+                  "Merged Event Keeps The First Old Value", __LINE__);
+    assert_flt_eq(3, rtosc_argument(hist.getHistory(0), 2).f,
+                  "Merged Event Gets The Last New Value", __LINE__);
+
+    hist.recordEvent(undo_change("/y", 0, 1));
+    hist.recordEvent(undo_change("/x", 3, 4));
+    assert_int_eq(2, hist.size(), "Latest Event Of An Address Is Merged",
+                  __LINE__);
+    assert_flt_eq(4, rtosc_argument(hist.getHistory(0), 2).f,
+                  "Merged Event Is Found Behind Other Events", __LINE__);
+}
+
+void memory_budget()
+{
+    char path[32];
+    const size_t budget = 1024;
+    const size_t len = rtosc_message_length(undo_change("/voice00/x", 0, 1),
+                                            -1);
+    //each stored event needs at least its path and its arguments
+    const size_t min_len = strlen("/voice00/x") + 2 * sizeof(float);
+    UndoHistory hist(budget);
+    assert_int_eq(budget, hist.getMemoryBudget(), "Memory Budget Is Set",
+                  __LINE__);
+
+    int seen = 0;
+    hist.setCallback([&seen](const char*) { ++seen; });
+    for(int i = 0; i < 1000; ++i) {
+        snprintf(path, sizeof(path), "/voice%02d/x", i % 100);
+        hist.recordEvent(undo_change(path, i, i+1));
+    }
+
+    assert_true(hist.size() * min_len <= budget,
+                "Events Are Limited By The Memory Budget", __LINE__);
+    assert_true(hist.size() >= budget / len,
+                "Events Are Stored Compressed", __LINE__);
+    assert_int_eq(hist.size(), hist.getPos(), "Position Is At The End",
+                  __LINE__);
+
+    //the newest events must be kept, in order
+    int mismatches = 0;
+    for(size_t i = 0; i < hist.size(); ++i) {
+        int n = 1000 - hist.size() + i;
+        snprintf(path, sizeof(path), "/voice%02d/x", n % 100);
+        const char *msg = hist.getHistory(i);
+        mismatches += !!strcmp(path, rtosc_argument(msg, 0).s);
+        mismatches += rtosc_argument(msg, 2).f != n+1;
+    }
+    assert_int_eq(0, mismatches, "Newest Events Are Kept In Order", __LINE__);
+
+    hist.seekHistory(-10000);
+    assert_int_eq(hist.size(), seen, "All Kept Events Can Be Undone",
+                  __LINE__);
+
+    size_t old_size = hist.size();
+    hist.setMemoryBudget(budget / 2);
+    assert_true(hist.size() < old_size && hist.size() * min_len <= budget / 2,
+                "Shrinking The Budget Drops Events", __LINE__);
+    hist.setMemoryBudget(budget);
+    hist.recordEvent(undo_change("/z", 0, 1));
+    assert_int_eq(1, hist.size(), "Recording Drops The Redo History",
+                  __LINE__);
+}
+
+static void set(Rt &rt, const char *path, const char *type, ...)
+{
+    char msg[128];
+    va_list va;
+    va_start(va, type);
+    rtosc_vmessage(msg, sizeof(msg), path, type, va);
+    va_end(va);
+    ports.dispatch(msg, rt);
+}
+
+void transactions()
+{
+    Object o;
+    UndoHistory hist;
+    Rt rt(&o, &hist);
+    hist.setCallback([&rt](const char*msg) {ports.dispatch(msg+1, rt);});
+
+    hist.beginTransaction();
+    set(rt, "i", "i", 1);
+    hist.beginTransaction();
+    set(rt, "b", "c", 5);
+    hist.endTransaction();
+    set(rt, "b", "c", 6);
+    hist.endTransaction();
+    set(rt, "i", "i", 2);
+    assert_int_eq(3, hist.size(),
+                  "Events Are Not Merged Into Transactions", __LINE__);
+
+    rt.enable = false;
+    hist.seekHistory(-1);
+    assert_int_eq(1, o.i, "Undo Step After Transaction", __LINE__);
+    assert_int_eq(6, o.b, "Transaction Is Kept", __LINE__);
+    hist.seekHistory(-1);
+    assert_int_eq(0, hist.getPos(), "Transaction Is One Undo Step", __LINE__);
+    assert_true(o.i == 0 && o.b == 0,
+                "Transaction Is Undone Completely", __LINE__);
+    hist.seekHistory(+2);
+    assert_true(o.i == 2 && o.b == 6,
+                "Transaction Is Redone Completely", __LINE__);
+}
+
+void checkpoints()
+{
+    Object o;
+    UndoHistory hist;
+    Rt rt(&o, &hist);
+    int calls = 0;
+    hist.setCallback([&rt, &calls](const char*msg) {
+        ++calls;
+        ports.dispatch(msg+1, rt);
+    });
+    hist.setCheckpointSource(&o, &ports, 1024);
+    hist.setCheckpointInterval(10, 4);
+
+    //50 undo steps of 2 events
+    for(int k = 1; k <= 50; ++k) {
+        hist.beginTransaction();
+        set(rt, "i", "i", k);
+        set(rt, "b", "c", k);
+        hist.endTransaction();
+    }
+    assert_int_eq(100, hist.size(), "All Events Are Recorded", __LINE__);
+    assert_int_eq(4, hist.numCheckpoints(),
+                  "Checkpoints Are Limited", __LINE__);
+
+    rt.enable = false;
+    hist.seekHistory(-50);
+    assert_true(o.i == 0 && o.b == 0, "Undo Without Checkpoint", __LINE__);
+    assert_int_eq(100, calls, "Undo Replays All Events", __LINE__);
+
+    calls = 0;
+    hist.seekHistory(+48);
+    assert_true(o.i == 48 && o.b == 48, "Redo Using A Checkpoint", __LINE__);
+    assert_true(calls < 20, "Redo Restores A Checkpoint", __LINE__);
+
+    calls = 0;
+    hist.seekHistory(-40);
+    assert_true(o.i == 8 && o.b == 8,
+                "Undo To Before The Checkpoints", __LINE__);
+    assert_int_eq(80, calls, "Undo Steps Back Without Checkpoints",
+                  __LINE__);
+
+    rt.enable = true;
+    set(rt, "i", "i", 100);
+    assert_int_eq(0, hist.numCheckpoints(),
+                  "Recording Drops Checkpoints After The Position", __LINE__);
+    assert_true(hist.checkpoint() && hist.numCheckpoints() == 1,
+                "Checkpoints Can Be Taken Explicitly", __LINE__);
+}
+
+void recorder()
+{
+    UndoHistory hist;
+    UndoRecorder rec(hist, 256);
+
+    assert_true(rec.record(undo_change("/x", 0, 1)) &&
+                rec.record(undo_change("/x", 1, 2)) &&
+                rec.record(undo_change("/y", 0, 1)),
+                "Events Are Recorded", __LINE__);
+    assert_int_eq(0, hist.size(), "Events Are Not Drained Yet", __LINE__);
+    assert_int_eq(3, rec.drain(), "All Events Are Drained", __LINE__);
+    assert_int_eq(2, hist.size(), "Events Are Merged When Draining",
+                  __LINE__);
+    assert_flt_eq(2, rtosc_argument(hist.getHistory(0), 2).f,
+                  "Drained Event Is Merged", __LINE__);
+
+    int recorded = 0;
+    while(rec.record(undo_change("/z", 0, 1)))
+        ++recorded;
+    assert_int_eq(1, rec.lost(), "Events Are Lost If The Buffer Is Full",
+                  __LINE__);
+    assert_int_eq(recorded, rec.drain(), "Full Buffer Is Drained", __LINE__);
+
+    //the buffer must wrap around without losing events
+    int drained = 0;
+    for(int round = 0; round < 20; ++round) {
+        for(int i = 0; i < 3; ++i)
+            rec.record(undo_change("/w", round, round+1));
+        drained += rec.drain();
+    }
+    assert_int_eq(60, drained, "Buffer Wraps Around", __LINE__);
+    assert_int_eq(1, rec.lost(), "No Events Are Lost When Wrapping",
+                  __LINE__);
+}
+
+//the checkpoint must not contain the event after its position
+static void checkpoint_position(bool use_recorder)
+{
+    Object o;
+    UndoHistory hist;
+    UndoRecorder rec(hist, 256);
+    Rt rt(&o, &hist);
+    if(use_recorder)
+        rt.rec = &rec;
+    hist.setCallback([&rt](const char*msg) {ports.dispatch(msg+1, rt);});
+    hist.setCheckpointSource(&o, &ports, 1024);
+
+    //ports apply the value after replying, the recorder is drained later
+    for(int k = 1; k <= 100; ++k) {
+        hist.beginTransaction();
+        set(rt, "i", "i", k);
+        rec.drain();
+        hist.endTransaction();
+    }
+    hist.setCheckpointInterval(1, 256);
+    set(rt, "b", "c", 7);
+    rec.drain();
+    for(int k = 101; k <= 200; ++k) {
+        hist.beginTransaction();
+        set(rt, "i", "i", k);
+        rec.drain();
+        hist.endTransaction();
+    }
+
+    rt.enable = false;
+    hist.seekHistory(-101);
+    const char *tc = use_recorder ? "Recorded Checkpoint Is At Its Position"
+                                  : "Checkpoint Is At Its Position";
+    assert_true(o.i == 100 && o.b == 0, tc, __LINE__);
+}
+
 int main()
 {
     memset(message_buff, 0, sizeof(reply_buf));
@@ -100,6 +347,14 @@ int main()
     assert_int_eq(7, o.b,
             "Verify Redo Has Returned To Altered State", __LINE__);
 
+    merging();
+    memory_budget();
+    transactions();
+    checkpoints();
+    recorder();
+    checkpoint_position(false);
+    checkpoint_position(true);
+
     return test_summary();
 }
 
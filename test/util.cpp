@@ -1,3 +1,6 @@
+#include <cinttypes>
+#include <cmath>
+#include <cfloat>
 #include "../src/cpp/util.h"
 #include "common.h"
 
@@ -21,12 +24,127 @@ void test_fast_strcpy()
                   "fast_strcpy() copies at most <buffersize> bytes", __LINE__);
 }
 
+// simple deterministic random generator (xorshift)
+static uint64_t next_random(uint64_t& state)
+{
+    state ^= state << 13;
+    state ^= state >> 7;
+    state ^= state << 17;
+    return state;
+}
+
+void test_fast_print_int64()
+{
+    const int64_t values[] = { 0, 1, -1, 9, 10, -10, 123456789, INT32_MAX,
+                               INT32_MIN, INT64_MAX, INT64_MIN };
+    char exp[32], res[32];
+    int errors = 0;
+    for(int64_t v : values)
+    {
+        snprintf(exp, 32, "%" PRId64, v);
+        size_t len = fast_print_int64(res, 32, v);
+        errors += !!strcmp(exp, res) + (len != strlen(exp));
+    }
+    assert_int_eq(0, errors, "fast_print_int64() prints like snprintf()",
+                  __LINE__);
+
+    // short buffers are truncated like with snprintf
+    errors = 0;
+    for(int64_t v : values)
+    for(size_t bs = 1; bs < 22; ++bs)
+    {
+        int exp_len = snprintf(exp, bs, "%" PRId64, v);
+        memset(res, 'x', sizeof(res));
+        size_t len = fast_print_int64(res, bs, v);
+        errors += !!strcmp(exp, res) + (len != (size_t)exp_len) +
+                  (res[bs] != 'x');
+    }
+    assert_int_eq(0, errors, "fast_print_int64() truncates like snprintf()",
+                  __LINE__);
+}
+
+// check one value against snprintf, return the number of mismatches
+static int check_fixed_and_hex(double v, int prec, int* handled)
+{
+    char exp[512], res[512];
+    int errors = 0;
+
+    snprintf(exp, sizeof(exp), "%#.*f", prec, v);
+    memset(res, 0, sizeof(res));
+    size_t len = fast_print_fixed(res, sizeof(res), v, prec);
+    if(len) {
+        ++*handled;
+        errors += !!strcmp(exp, res) + (len != strlen(exp));
+        if(strcmp(exp, res))
+            printf("# %%#.%df: expected \"%s\", got \"%s\"\n", prec, exp, res);
+    }
+
+    snprintf(exp, sizeof(exp), "%a", v);
+    len = fast_print_hexfloat(res, sizeof(res), v);
+    if(len) {
+        ++*handled;
+        errors += !!strcmp(exp, res) + (len != strlen(exp));
+        if(strcmp(exp, res))
+            printf("# %%a: expected \"%s\", got \"%s\"\n", exp, res);
+    }
+    return errors;
+}
+
+void test_fast_print_float()
+{
+    int errors = 0, handled = 0;
+
+    const double special[] = { 0.0, -0.0, 1.0, -1.0, 0.5, 0.125, 0.005,
+                               0.015, 0.025, 2.5, 3.5, 1e-300, 1e300,
+                               123456789.0, 0.1, 1.0/3.0, (double)FLT_MAX,
+                               (double)FLT_MIN, DBL_MIN, DBL_MAX };
+    for(double v : special)
+        for(int prec = 0; prec < 10; ++prec)
+            errors += check_fixed_and_hex(v, prec, &handled);
+
+    uint64_t state = 0x12345678;
+    for(int i = 0; i < 20000; ++i)
+    {
+        // random float bit patterns, and random "typical" parameter values
+        uint32_t fbits = (uint32_t)next_random(state);
+        float f;
+        memcpy(&f, &fbits, sizeof(f));
+        float typical = (float)(next_random(state) % 200001) / 1000.f - 100.f;
+        uint64_t dbits = next_random(state);
+        double d;
+        memcpy(&d, &dbits, sizeof(d));
+        int prec = (int)(next_random(state) % 8);
+        if(std::isfinite(f))
+            errors += check_fixed_and_hex(f, prec, &handled);
+        errors += check_fixed_and_hex(typical, prec, &handled);
+        if(std::isfinite(d))
+            errors += check_fixed_and_hex(d, prec, &handled);
+    }
+
+    // only the exact result matters, but this makes sure that
+    // the fast path is not skipped for common values
+    assert_true(handled > 60000, "fast float printing handles most values",
+                __LINE__);
+    assert_int_eq(0, errors,
+                  "fast float printing prints like snprintf()", __LINE__);
+
+    char buf[8];
+    assert_int_eq(0, fast_print_fixed(buf, 8, NAN, 2),
+                  "fast_print_fixed() does not handle NaN", __LINE__);
+    assert_int_eq(0, fast_print_fixed(buf, 8, 123456.0, 2),
+                  "fast_print_fixed() respects the buffer size", __LINE__);
+    assert_int_eq(0, fast_print_hexfloat(buf, 8, INFINITY),
+                  "fast_print_hexfloat() does not handle infinity", __LINE__);
+}
+
 /*
     all tests
 */
 int main()
 {
     test_fast_strcpy();
+    test_fast_print_int64();
+    test_fast_print_float();
 
     return test_summary();
 }